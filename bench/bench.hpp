@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace bench
+{
+
+    using BenchmarkFunction = void (*)();
+
+    /// @brief Registers a benchmark function under a name at static
+    /// initialization time. Use through the BENCHMARK macro.
+    struct Registration
+    {
+        Registration(const char *name, BenchmarkFunction function);
+    };
+
+    /// @brief Keep a computed value alive so the optimizer can't remove the
+    /// work that produced it
+    void DoNotOptimize(uint64_t value);
+    void DoNotOptimize(float value);
+
+    /// @brief Deterministic xorshift noise, so every run sees the same
+    /// inputs
+    struct Noise
+    {
+        uint32_t state;
+
+        explicit Noise(uint32_t seed = 12345) : state(seed) {}
+
+        uint32_t NextBits()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        /// @brief Next value in [-1, 1)
+        float Next() { return static_cast<float>(NextBits() & 0xFFFF) / 32768.0f - 1.0f; }
+
+        /// @brief Next value in [0, 1]
+        float NextUnit() { return (NextBits() & 0xFFFFFF) / float(0xFFFFFF); }
+    };
+
+    /// @brief Print one result line
+    void Report(const std::string &name, double nanosecondsPerIteration);
+
+    /// @brief Time a function, returning the average nanoseconds per call.
+    /// Iterations are split into batches and the fastest batch is reported,
+    /// to filter out scheduler noise.
+    template <class Function>
+    double Measure(Function &&function, size_t iterations = 100000)
+    {
+        const size_t kBatches = 10;
+        size_t batchSize = iterations / kBatches;
+        if (batchSize == 0)
+            batchSize = 1;
+
+        for (size_t i = 0; i < batchSize; i++)
+            function();
+
+        double best = 0.0;
+        for (size_t batch = 0; batch < kBatches; batch++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < batchSize; i++)
+                function();
+            auto end = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count() / batchSize;
+            if (batch == 0 || ns < best)
+                best = ns;
+        }
+        return best;
+    }
+
+}
+
+#define BENCHMARK(name)                                                   \
+    static void name();                                                   \
+    static ::bench::Registration name##_registration(#name, &name);       \
+    static void name()
@@ -0,0 +1,138 @@
+#include "bench.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vr/action_table.hpp"
+
+// Compares the per-tick cost of refreshing action states through the
+// ActionStateTable against the previous layout: a std::map of shared_ptr
+// actions walked by value, with a virtual Update per action. Both read from
+// the same in-memory source so only the bookkeeping overhead is measured.
+
+namespace
+{
+    /// @brief Deterministic stand-in for the runtime's action state
+    struct FakeActionSource
+    {
+        uint32_t tick = 0;
+
+        inline bool ReadDigital(uint32_t slot, vr::VRActionHandle_t handle, vr::InputDigitalActionData_t &data)
+        {
+            data.bActive = true;
+            data.bState = ((handle + tick) & 7) == 0;
+            data.bChanged = false;
+            data.fUpdateTime = 0.0f;
+            return true;
+        }
+
+        inline bool ReadAnalog(uint32_t slot, vr::VRActionHandle_t handle, vr::InputAnalogActionData_t &data)
+        {
+            data.bActive = true;
+            data.x = ((handle * 7 + tick) % 100) * 0.01f;
+            data.y = ((handle * 13 + tick) % 100) * 0.01f;
+            data.fUpdateTime = 0.0f;
+            return true;
+        }
+    };
+
+    class LegacyAction
+    {
+    public:
+        virtual ~LegacyAction() {}
+        virtual void Update(FakeActionSource &source) {}
+        std::string identifier;
+        vr::VRActionHandle_t handle = 0;
+    };
+
+    class LegacyButtonAction : public LegacyAction
+    {
+    public:
+        virtual void Update(FakeActionSource &source) override
+        {
+            vr::InputDigitalActionData_t data;
+            source.ReadDigital(0, handle, data);
+            bool downPrev = down;
+            down = data.bActive && data.bState;
+            pressed = down && !downPrev;
+            released = !down && downPrev;
+        }
+        bool down = false;
+        bool pressed = false;
+        bool released = false;
+    };
+
+    class LegacyJoystickAction : public LegacyAction
+    {
+    public:
+        virtual void Update(FakeActionSource &source) override
+        {
+            vr::InputAnalogActionData_t data;
+            source.ReadAnalog(0, handle, data);
+            float xPrev = x, yPrev = y;
+            x = data.bActive ? data.x : 0.0f;
+            y = data.bActive ? data.y : 0.0f;
+            deltaX = x - xPrev;
+            deltaY = y - yPrev;
+        }
+        float x = 0.0f, y = 0.0f, deltaX = 0.0f, deltaY = 0.0f;
+    };
+
+    std::string MakeIdentifier(size_t index)
+    {
+        return "/actions/bench/in/action_" + std::to_string(index);
+    }
+
+    void RunActionUpdate(size_t actionCount)
+    {
+        // Roughly the digital/analog mix of config/actions.json
+        const size_t analogEvery = 6;
+
+        std::map<std::string, std::shared_ptr<LegacyAction>> legacyActions;
+        ActionStateTable table;
+        for (size_t i = 0; i < actionCount; i++)
+        {
+            std::shared_ptr<LegacyAction> action;
+            if (i % analogEvery == 0)
+            {
+                action = std::make_shared<LegacyJoystickAction>();
+                table.AddAnalog(i + 1);
+            }
+            else
+            {
+                action = std::make_shared<LegacyButtonAction>();
+                table.AddDigital(i + 1);
+            }
+            action->identifier = MakeIdentifier(i);
+            action->handle = i + 1;
+            legacyActions[action->identifier] = action;
+        }
+
+        FakeActionSource source;
+        double legacyNs = bench::Measure([&]()
+                                         {
+            source.tick++;
+            for (auto it : legacyActions)
+                it.second->Update(source); });
+        bench::DoNotOptimize(uint64_t(legacyActions.size()));
+
+        double tableNs = bench::Measure([&]()
+                                        {
+            source.tick++;
+            table.Update(source, util::Clock::now());
+            bench::DoNotOptimize(table.GetDownWords()[0]); });
+
+        std::string suffix = " (" + std::to_string(actionCount) + " actions)";
+        bench::Report("map walk, per-action virtual" + suffix, legacyNs);
+        bench::Report("action state table" + suffix, tableNs);
+    }
+}
+
+BENCHMARK(ActionUpdate)
+{
+    RunActionUpdate(18);
+    RunActionUpdate(90);
+    RunActionUpdate(1024);
+}
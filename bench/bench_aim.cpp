@@ -0,0 +1,478 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mappings/aim_late_latch.hpp"
+#include "mappings/sphere_aim_controller.hpp"
+#include "outputs/injection_thread.hpp"
+#include "trace/trace_reader.hpp"
+#include "util/fast_math.hpp"
+#include "util/timing.hpp"
+
+// Cost of one aim controller update in sphere and quaternion mode, and how
+// far quaternion mode's aim is from the exact aim for where the device
+// points, over the same pose stream. Streams are synthetic 1 kHz hand motion
+// by default; set DANDY_BENCH_TRACE to a trace file to also run over the
+// right hand poses it recorded.
+//
+// The exact aim is worked out in double precision from pointing directions
+// alone, so any roll leaking into aim fails the check. It has to stay within
+// kAimTolerance degrees on every tick. Sphere mode's aim is printed next to
+// it: the two agree near the engage direction and part as the hand moves
+// away in both yaw and pitch. Sweeping over the vertical shows sphere mode's
+// azimuth flipping by 180 degrees.
+//
+// The late latch benchmark runs the aim through a real injection thread at
+// 1 kHz, with the hand turning in wall-clock time, and reports how old the
+// pose is when its motion is injected and how far injected aim trails the
+// hand, for motion computed in the tick and late latched motion. A busy wait
+// stands in for the rest of the tick's work between fetching poses and
+// flushing.
+
+namespace
+{
+    const float kDegrees = 3.14159265f / 180.0f;
+
+    /// @brief Largest error allowed in quaternion mode's aim, in degrees
+    const double kAimTolerance = 0.001;
+
+    /// @brief Enable button held by the benchmark rather than an action
+    class HeldButton : public inputs::Button
+    {
+    public:
+        inline void SetDown(bool down)
+        {
+            m_downPrev = m_down;
+            m_down = down;
+        }
+
+        virtual void Update() override {}
+    };
+
+    struct PoseStream
+    {
+        std::string name;
+        std::vector<VrDevice> poses;
+    };
+
+    /// @brief Orientation yawing about world up, then pitching about the
+    /// device's right axis and rolling about its forward axis
+    Matrix3f MakeOrientation(float yaw, float pitch, float roll)
+    {
+        float cy = std::cos(yaw), sy = std::sin(yaw);
+        float cp = std::cos(pitch), sp = std::sin(pitch);
+        float cr = std::cos(roll), sr = std::sin(roll);
+        float yawMatrix[3][3] = {{cy, 0, sy}, {0, 1, 0}, {-sy, 0, cy}};
+        float pitchMatrix[3][3] = {{1, 0, 0}, {0, cp, -sp}, {0, sp, cp}};
+        float rollMatrix[3][3] = {{cr, -sr, 0}, {sr, cr, 0}, {0, 0, 1}};
+        float yawPitch[3][3];
+        for (size_t row = 0; row < 3; row++)
+        {
+            for (size_t col = 0; col < 3; col++)
+            {
+                yawPitch[row][col] = 0.0f;
+                for (size_t k = 0; k < 3; k++)
+                    yawPitch[row][col] += yawMatrix[row][k] * pitchMatrix[k][col];
+            }
+        }
+        Matrix3f orientation;
+        for (size_t row = 0; row < 3; row++)
+        {
+            for (size_t col = 0; col < 3; col++)
+            {
+                float value = 0.0f;
+                for (size_t k = 0; k < 3; k++)
+                    value += yawPitch[row][k] * rollMatrix[k][col];
+                orientation.c[col][row] = value;
+            }
+        }
+        return orientation;
+    }
+
+    /// @brief Hand motion at 1 kHz: sinusoidal sweeps with tracking jitter
+    /// on yaw and pitch, and a little hand translation
+    PoseStream MakeSweepStream(const std::string &name, float yawAmplitude, float pitchAmplitude, float rollAmplitude)
+    {
+        const size_t kSamples = 5000;
+        PoseStream stream;
+        stream.name = name;
+        bench::Noise noise;
+        util::Timestamp time = util::Clock::now();
+        for (size_t i = 0; i < kSamples; i++)
+        {
+            float t = i * 0.001f;
+            VrDevice device;
+            device.connected = true;
+            device.poseValid = true;
+            device.poseTime = time + std::chrono::milliseconds(i);
+            float yaw = yawAmplitude * std::sin(t * 4.4f) + noise.Next() * 0.02f;
+            float pitch = pitchAmplitude * std::sin(t * 2.8f + 0.5f) + noise.Next() * 0.02f;
+            float roll = rollAmplitude * std::sin(t * 1.9f);
+            device.orientation = MakeOrientation(yaw * kDegrees, pitch * kDegrees, roll * kDegrees);
+            device.position = Vector3f(0.2f + 0.05f * std::sin(t * 3.1f), 1.2f, -0.3f);
+            stream.poses.push_back(device);
+        }
+        return stream;
+    }
+
+    /// @brief Right hand poses from a recorded trace
+    bool LoadTraceStream(const std::string &path, PoseStream &stream)
+    {
+        trace::TraceReader reader;
+        if (reader.Open(path).Failed())
+            return false;
+        size_t deviceIndex = trace::kMaxDeviceCount;
+        const trace::DeviceTable &devices = reader.GetDevices();
+        for (size_t index = 0; index < devices.size(); index++)
+        {
+            if (devices[index].active && devices[index].role == vr::TrackedControllerRole_RightHand)
+                deviceIndex = index;
+        }
+        if (deviceIndex == trace::kMaxDeviceCount)
+            return false;
+
+        stream.name = "trace " + path;
+        util::Timestamp start = util::Clock::now();
+        trace::Frame frame;
+        frame.Reset(reader.GetDigitalNames().size(), reader.GetAnalogNames().size());
+        while (reader.ReadTick(frame))
+        {
+            const vr::TrackedDevicePose_t &pose = frame.poses[deviceIndex];
+            if (!(frame.deviceMask & (1ull << deviceIndex)) || !pose.bPoseIsValid)
+                continue;
+            VrDevice device;
+            device.connected = true;
+            device.poseValid = true;
+            device.poseTime = start + std::chrono::microseconds(frame.timeUs);
+            const vr::HmdMatrix34_t &m = pose.mDeviceToAbsoluteTracking;
+            device.position = Vector3f(m.m[0][3], m.m[1][3], m.m[2][3]);
+            for (size_t col = 0; col < 3; col++)
+            {
+                for (size_t row = 0; row < 3; row++)
+                    device.orientation.c[col][row] = m.m[row][col];
+            }
+            stream.poses.push_back(device);
+        }
+        return !stream.poses.empty();
+    }
+
+    struct AimRig
+    {
+        VrDevice device;
+        std::shared_ptr<HeldButton> enable = std::make_shared<HeldButton>();
+        std::shared_ptr<outputs::Analog> outputX = std::make_shared<outputs::Analog>();
+        std::shared_ptr<outputs::Analog> outputY = std::make_shared<outputs::Analog>();
+        mappings::SphereAimController controller{&device, enable, outputX, outputY};
+
+        explicit AimRig(mappings::AimMode mode)
+        {
+            controller.m_mode = mode;
+            controller.m_outputScale = 1.0f; // Counts are degrees
+        }
+
+        /// @brief Update on a pose, returning the aim step in degrees
+        Vector2f Step(const VrDevice &pose, bool enabled)
+        {
+            device = pose;
+            enable->SetDown(enabled);
+            outputX->PreUpdate();
+            outputY->PreUpdate();
+            controller.Update();
+            return Vector2f(outputX->GetValue(), outputY->GetValue());
+        }
+    };
+
+    void RunTiming(const PoseStream &stream, mappings::AimMode mode, const char *modeName)
+    {
+        AimRig rig(mode);
+        rig.Step(stream.poses[0], false);
+        size_t index = 0;
+        double ns = bench::Measure([&]()
+                                   {
+            index = index + 1 < stream.poses.size() ? index + 1 : 1;
+            bench::DoNotOptimize(rig.Step(stream.poses[index], true).x); },
+                                   200000);
+        bench::Report(std::string("SphereAimController::Update (") + modeName + ")", ns);
+    }
+
+    /// @brief Exact quaternion mode aim in degrees, from the engage and
+    /// current pointing directions: the angle between them, split along the
+    /// level right and up axes of the engage direction
+    Vector2f GetExactAim(const Matrix3f &engage, const Matrix3f &orientation)
+    {
+        double forward0[3], forward[3];
+        for (size_t row = 0; row < 3; row++)
+        {
+            forward0[row] = -engage.c[2][row];
+            forward[row] = -orientation.c[2][row];
+        }
+        double right[3] = {-forward0[2], 0.0, forward0[0]};
+        double rightLength = std::sqrt(right[0] * right[0] + right[2] * right[2]);
+        right[0] /= rightLength;
+        right[2] /= rightLength;
+        double up[3] = {right[1] * forward0[2] - right[2] * forward0[1],
+                        right[2] * forward0[0] - right[0] * forward0[2],
+                        right[0] * forward0[1] - right[1] * forward0[0]};
+
+        double x = forward[0] * right[0] + forward[1] * right[1] + forward[2] * right[2];
+        double y = forward[0] * up[0] + forward[1] * up[1] + forward[2] * up[2];
+        double z = forward[0] * forward0[0] + forward[1] * forward0[1] + forward[2] * forward0[2];
+        double sine = std::sqrt(x * x + y * y);
+        if (sine < 1e-12)
+            return Vector2f::ZERO;
+        double scale = std::atan2(sine, z) / sine * (180.0 / 3.14159265358979323846);
+        return Vector2f(static_cast<float>(x * scale), static_cast<float>(-y * scale));
+    }
+
+    void RunAccuracy(const PoseStream &stream)
+    {
+        // Engage on the first pose and hold for the rest of the stream
+        AimRig sphere(mappings::AimMode::kSphere);
+        AimRig quaternion(mappings::AimMode::kQuaternion);
+        sphere.Step(stream.poses[0], false);
+        quaternion.Step(stream.poses[0], false);
+
+        double maxError = 0.0;
+        size_t maxIndex = 0;
+        double maxSphereDifference = 0.0;
+        float maxElevation = 0.0f;
+        for (size_t i = 1; i < stream.poses.size(); i++)
+        {
+            sphere.Step(stream.poses[i], true);
+            quaternion.Step(stream.poses[i], true);
+            Vector2f exact = GetExactAim(stream.poses[0].orientation, stream.poses[i].orientation);
+            Vector2f aim = quaternion.controller.m_aimAngles;
+            Vector2f sphereAim = sphere.controller.m_aimAngles;
+            double error = std::hypot(aim.x - exact.x, aim.y - exact.y);
+            if (error > maxError)
+            {
+                maxError = error;
+                maxIndex = i;
+            }
+            maxSphereDifference = std::max(maxSphereDifference,
+                                           static_cast<double>(std::hypot(aim.x - sphereAim.x, aim.y - sphereAim.y)));
+            maxElevation = std::max(maxElevation, std::abs(std::asin(std::clamp(sphere.controller.m_direction.y, -1.0f, 1.0f))));
+        }
+
+        std::printf("  %-40s max |el| %4.1f deg: quaternion aim error max %7.4f mdeg (tick %zu) %s; vs sphere max %7.3f deg\n",
+                    stream.name.c_str(), maxElevation / kDegrees, maxError * 1000.0, maxIndex,
+                    maxError <= kAimTolerance ? "pass" : "FAIL", maxSphereDifference);
+    }
+
+    void RunFastAtanError()
+    {
+        double maxError = 0.0;
+        const int kSamples = 1000000;
+        for (int i = 0; i <= kSamples; i++)
+        {
+            float x = static_cast<float>(i) / kSamples;
+            maxError = std::max(maxError, std::abs(static_cast<double>(util::FastAtanUnit(x)) - std::atan(static_cast<double>(x))));
+        }
+        std::printf("  FastAtanUnit max error %.2e rad\n", maxError);
+    }
+}
+
+BENCHMARK(AimController)
+{
+    std::vector<PoseStream> streams;
+    streams.push_back(MakeSweepStream("sweep +-40 yaw, +-20 pitch", 40.0f, 20.0f, 0.0f));
+    streams.push_back(MakeSweepStream("sweep +-40 yaw, +-20 pitch, +-10 roll", 40.0f, 20.0f, 10.0f));
+    streams.push_back(MakeSweepStream("sweep +-30 yaw, +-85 pitch", 30.0f, 85.0f, 0.0f));
+    streams.push_back(MakeSweepStream("sweep +-30 yaw, +-95 pitch", 30.0f, 95.0f, 0.0f));
+    if (const char *path = std::getenv("DANDY_BENCH_TRACE"))
+    {
+        PoseStream stream;
+        if (LoadTraceStream(path, stream))
+            streams.push_back(stream);
+        else
+            std::printf("  No right hand poses in %s\n", path);
+    }
+
+    RunTiming(streams[0], mappings::AimMode::kSphere, "sphere");
+    RunTiming(streams[0], mappings::AimMode::kQuaternion, "quaternion");
+    std::printf("  Quaternion aim tolerance %.1f mdeg\n", kAimTolerance * 1000.0);
+    for (const PoseStream &stream : streams)
+        RunAccuracy(stream);
+    RunFastAtanError();
+}
+
+namespace
+{
+    const float kLatchYawAmplitude = 40.0f;
+    const float kLatchYawRate = 12.0f; // About 2 Hz, up to 480 degrees/s
+    const float kLatchCountsPerDegree = 40.0f;
+
+    float GetAzimuthDegrees(const Matrix3f &orientation)
+    {
+        Vector3f direction = orientation * -Vector3f::UNITZ;
+        return Math::ToDegrees(Math::ATan2(direction.z, direction.x));
+    }
+
+    /// @brief One hand turning in wall-clock time, which can be sampled at
+    /// any moment like the runtime
+    class LiveBackend : public InputBackend
+    {
+    public:
+        explicit LiveBackend(util::Timestamp start) : m_start(start) {}
+
+        Matrix3f GetOrientation(util::Timestamp time) const
+        {
+            float t = std::chrono::duration<float>(time - m_start).count();
+            return MakeOrientation(kLatchYawAmplitude * std::sin(t * kLatchYawRate) * kDegrees, 0.0f, 0.0f);
+        }
+
+        virtual vr::VRActionSetHandle_t GetActionSetHandle(const std::string &path) override { return 1; }
+        virtual vr::VRActionHandle_t GetActionHandle(const std::string &path) override { return 1; }
+        virtual void UpdateActions(vr::VRActionSetHandle_t actionSet, ActionStateTable &table) override {}
+        virtual util::Timestamp GetPoses(const PosePredictor::PredictionArray &predictions,
+                                         PosePredictor::PoseArray &poses) override { return util::Clock::now(); }
+        virtual vr::ETrackedDeviceClass GetDeviceClass(vr::TrackedDeviceIndex_t index) override
+        {
+            return vr::TrackedDeviceClass_Controller;
+        }
+        virtual vr::ETrackedControllerRole GetControllerRole(vr::TrackedDeviceIndex_t index) override
+        {
+            return vr::TrackedControllerRole_RightHand;
+        }
+        virtual std::string GetDeviceString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop) override
+        {
+            return "";
+        }
+
+        virtual bool CanSampleLatestPose() const override { return true; }
+        virtual bool SampleLatestPose(vr::TrackedDeviceIndex_t index, const PosePrediction &prediction,
+                                      vr::TrackedDevicePose_t &pose) override
+        {
+            Matrix3f orientation = GetOrientation(util::Clock::now());
+            pose = vr::TrackedDevicePose_t();
+            for (size_t col = 0; col < 3; col++)
+            {
+                for (size_t row = 0; row < 3; row++)
+                    pose.mDeviceToAbsoluteTracking.m[row][col] = orientation.c[col][row];
+            }
+            pose.bPoseIsValid = true;
+            pose.bDeviceIsConnected = true;
+            return true;
+        }
+
+    private:
+        util::Timestamp m_start;
+    };
+
+    /// @brief Compares injected aim against where the hand points at the
+    /// moment of injection. Runs on the injection thread.
+    class AimErrorSink : public outputs::OutputSink
+    {
+    public:
+        explicit AimErrorSink(const LiveBackend &backend) : m_backend(backend) {}
+
+        /// @brief Standard deviation of the aim error in degrees. The
+        /// constant offset from where aim engaged drops out.
+        double GetErrorDegrees() const
+        {
+            if (m_count == 0)
+                return 0.0;
+            double mean = m_sum / m_count;
+            return std::sqrt(std::max(0.0, m_squares / m_count - mean * mean));
+        }
+
+    protected:
+        virtual void Submit(const std::vector<outputs::OutputEvent> &events) override
+        {
+            for (const outputs::OutputEvent &event : events)
+            {
+                if (event.type == outputs::OutputEvent::Type::kMouseMove)
+                    m_countsX += event.dx;
+            }
+            double error = GetAzimuthDegrees(m_backend.GetOrientation(util::Clock::now())) -
+                           m_countsX / static_cast<double>(kLatchCountsPerDegree);
+            m_sum += error;
+            m_squares += error * error;
+            m_count++;
+        }
+
+    private:
+        const LiveBackend &m_backend;
+        int64_t m_countsX = 0;
+        double m_sum = 0.0;
+        double m_squares = 0.0;
+        uint64_t m_count = 0;
+    };
+
+    void RunLateLatch(bool lateLatch, std::chrono::microseconds tickWork)
+    {
+        const size_t kTicks = 3000;
+        const auto kTickPeriod = std::chrono::microseconds(1000);
+
+        auto backend = std::make_shared<LiveBackend>(util::Clock::now());
+        auto target = std::make_shared<AimErrorSink>(*backend);
+        outputs::InjectionThread injector(target);
+
+        VrDevice device;
+        device.connected = true;
+        device.poseValid = true;
+        auto enable = std::make_shared<HeldButton>();
+        auto outputX = std::make_shared<outputs::MouseMovement>(0);
+        auto outputY = std::make_shared<outputs::MouseMovement>(1);
+        mappings::SphereAimController controller(&device, enable, outputX, outputY);
+        controller.m_outputScale = kLatchCountsPerDegree;
+        if (lateLatch)
+        {
+            auto latch = std::make_shared<mappings::AimLateLatch>(backend, mappings::AimMode::kSphere);
+            latch->SetDevice(0, PosePrediction());
+            controller.SetLateLatch(latch);
+            injector.SetLateLatch(latch);
+        }
+        injector.Start();
+
+        double flushAgeUs = 0.0;
+        util::Timestamp deadline = util::Clock::now();
+        for (size_t tick = 0; tick < kTicks; tick++)
+        {
+            deadline += kTickPeriod;
+            util::SleepUntil(deadline);
+            util::Timestamp poseTime = util::Clock::now();
+            device.orientation = backend->GetOrientation(poseTime);
+            device.poseTime = poseTime;
+            while (util::Clock::now() - poseTime < tickWork)
+            {
+            }
+
+            // Engage on the second tick
+            enable->SetDown(tick > 0);
+            outputX->PreUpdate();
+            outputY->PreUpdate();
+            controller.Update();
+            if (outputX->HasPendingEvent())
+                outputX->Update(injector);
+            if (outputY->HasPendingEvent())
+                outputY->Update(injector);
+            injector.Flush();
+            flushAgeUs += std::chrono::duration<double, std::micro>(util::Clock::now() - poseTime).count();
+        }
+        outputs::InjectionStats stats = injector.GetStats();
+        injector.Stop();
+
+        // The tick's pose waits for its tick to flush, then for injection.
+        // A latched pose is sampled just before injecting.
+        double poseAgeUs = lateLatch ? stats.averageLateLatchUs : flushAgeUs / kTicks + stats.averageLatencyUs;
+        std::printf("  %-10s tick work %4lld us: pose age at injection avg %7.1f us, aim error %.3f deg rms\n",
+                    lateLatch ? "late latch" : "tick", static_cast<long long>(tickWork.count()),
+                    poseAgeUs, target->GetErrorDegrees());
+    }
+}
+
+BENCHMARK(AimLateLatch)
+{
+    for (auto tickWork : {std::chrono::microseconds(0), std::chrono::microseconds(300)})
+    {
+        RunLateLatch(false, tickWork);
+        RunLateLatch(true, tickWork);
+    }
+}
@@ -0,0 +1,142 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mappings/axis_curve_kernel.hpp"
+
+// Throughput of the analog bind response curve kernel for each instruction
+// set the CPU supports, over packed batches the size of a typical config
+// (8), a large one (64) and a synthetic load (4096). Rows mix linear and
+// curved exponents, deadzones and inverted scales. The maximum error of each
+// vector kernel against the scalar reference is printed alongside, then its
+// error against double precision pow over a sweep of values and exponents.
+
+namespace
+{
+    struct AxisBatch
+    {
+        std::vector<float> input;
+        std::vector<float> values;
+        std::vector<float> deadzone;
+        std::vector<float> exponent;
+        std::vector<float> scale;
+    };
+
+    void BuildBatch(AxisBatch &batch, size_t count)
+    {
+        static const float kExponents[] = {1.0f, 1.5f, 2.0f, 0.7f};
+        bench::Noise noise;
+
+        batch.input.resize(count);
+        batch.values.resize(count);
+        batch.deadzone.resize(count);
+        batch.exponent.resize(count);
+        batch.scale.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            batch.input[i] = noise.NextUnit() * 2.0f - 1.0f;
+            batch.deadzone[i] = noise.NextUnit() * 0.2f;
+            batch.exponent[i] = kExponents[i % 4];
+            batch.scale[i] = (noise.NextUnit() * 20.0f + 1.0f) * (i % 3 == 0 ? -1.0f : 1.0f);
+        }
+    }
+
+    void Apply(mappings::AxisCurveKernel kernel, AxisBatch &batch)
+    {
+        std::memcpy(batch.values.data(), batch.input.data(), batch.input.size() * sizeof(float));
+        kernel(batch.values.data(), batch.deadzone.data(), batch.exponent.data(),
+               batch.scale.data(), batch.values.size());
+    }
+
+    void RunAxisKernel(size_t count)
+    {
+        AxisBatch batch;
+        BuildBatch(batch, count);
+
+        AxisBatch reference = batch;
+        Apply(mappings::GetAxisCurveKernel(mappings::KernelIsa::kScalar), reference);
+
+        const mappings::KernelIsa isas[] = {
+            mappings::KernelIsa::kScalar,
+            mappings::KernelIsa::kSse2,
+            mappings::KernelIsa::kAvx2,
+        };
+        for (mappings::KernelIsa isa : isas)
+        {
+            mappings::AxisCurveKernel kernel = mappings::GetAxisCurveKernel(isa);
+            if (!kernel)
+                continue;
+
+            double ns = bench::Measure([&]()
+                                       {
+                Apply(kernel, batch);
+                bench::DoNotOptimize(batch.values[0]); },
+                                       4000000 / count + 10);
+
+            float maxError = 0.0f;
+            for (size_t i = 0; i < count; i++)
+            {
+                float expected = reference.values[i];
+                float error = std::fabs(batch.values[i] - expected) /
+                              (std::fabs(expected) > 1.0f ? std::fabs(expected) : 1.0f);
+                if (error > maxError)
+                    maxError = error;
+            }
+
+            bench::Report(std::string(mappings::GetKernelIsaName(isa)) + " (" +
+                              std::to_string(count) + " axes)",
+                          ns);
+            std::printf("    %.2f ns/axis, max relative error %.2e\n", ns / count, maxError);
+        }
+    }
+
+    void RunAxisKernelErrorSweep()
+    {
+        const size_t kCount = 1 << 16;
+        const float kMinValue = 1e-3f;
+        const mappings::KernelIsa isas[] = {
+            mappings::KernelIsa::kSse2,
+            mappings::KernelIsa::kAvx2,
+        };
+        for (mappings::KernelIsa isa : isas)
+        {
+            mappings::AxisCurveKernel kernel = mappings::GetAxisCurveKernel(isa);
+            if (!kernel)
+                continue;
+            std::printf("  %s max relative error vs pow, |value| >= %g:", mappings::GetKernelIsaName(isa), kMinValue);
+            for (float exponent : {0.5f, 1.5f, 2.0f, 3.0f})
+            {
+                std::vector<float> input(kCount);
+                for (size_t i = 0; i < kCount; i++)
+                    input[i] = kMinValue + (1.0f - kMinValue) * i / kCount;
+                std::vector<float> values = input;
+                std::vector<float> deadzone(kCount, 0.0f);
+                std::vector<float> exponents(kCount, exponent);
+                std::vector<float> scale(kCount, 1.0f);
+                kernel(values.data(), deadzone.data(), exponents.data(), scale.data(), kCount);
+
+                double maxError = 0.0;
+                for (size_t i = 0; i < kCount; i++)
+                {
+                    double expected = std::pow(static_cast<double>(input[i]), static_cast<double>(exponent));
+                    maxError = std::max(maxError, std::fabs(values[i] - expected) / expected);
+                }
+                std::printf(" e=%g %.2e", exponent, maxError);
+            }
+            std::printf("\n");
+        }
+    }
+}
+
+BENCHMARK(AxisCurveKernel)
+{
+    RunAxisKernel(8);
+    RunAxisKernel(64);
+    RunAxisKernel(4096);
+    RunAxisKernelErrorSweep();
+}
@@ -0,0 +1,142 @@
+#include "bench.hpp"
+
+#include <memory>
+#include <string>
+
+#include "mappings/bindings.hpp"
+#include "vr/actions.hpp"
+#include "vr/device_registry.hpp"
+#include "vr/synthetic_backend.hpp"
+
+// Load test of a full mapping tick with no headset: a synthetic backend
+// generates input for thousands of actions, each wired through an input and
+// bind to a non-injecting output, and the tick (action update, poses, bind
+// mapper) is timed end to end alongside BindMapper::Update on its own, in
+// both full and incremental mode.
+
+namespace
+{
+    struct SyntheticMapping
+    {
+        std::shared_ptr<SyntheticBackend> backend;
+        std::shared_ptr<ActionSet> actions;
+        mappings::BindMapper mapper;
+        size_t bindCount = 0;
+    };
+
+    void BuildMapping(SyntheticMapping &mapping, uint32_t actionCount)
+    {
+        // Roughly the digital/analog mix of config/actions.json
+        SyntheticSettings settings;
+        settings.analogActionCount = actionCount / 6 > 0 ? actionCount / 6 : 1;
+        settings.digitalActionCount = actionCount - settings.analogActionCount;
+        settings.trackerCount = 3;
+        mapping.backend = std::make_shared<SyntheticBackend>(settings);
+        mapping.actions = std::make_shared<ActionSet>(mapping.backend, "/actions/synthetic");
+        mappings::BindMapper &mapper = mapping.mapper;
+
+        for (const std::string &name : mapping.backend->GetDigitalActionNames())
+        {
+            auto action = std::make_shared<ButtonAction>(name);
+            mapping.actions->AddAction(action);
+            auto input = std::make_shared<inputs::ButtonFromAction>(action);
+            input->SetName(name);
+            mapper.AddInput(input);
+            auto output = std::make_shared<outputs::Button>();
+            output->SetName(name + "/out");
+            mapper.AddOutput(output);
+            mapper.AddBind(std::make_shared<mappings::ButtonToButton>(input, output));
+            mapping.bindCount++;
+        }
+
+        for (const std::string &name : mapping.backend->GetAnalogActionNames())
+        {
+            auto action = std::make_shared<JoystickAction>(name);
+            mapping.actions->AddAction(action);
+            std::shared_ptr<inputs::JoystickAxis> axes[2];
+            for (size_t axis = 0; axis < 2; axis++)
+            {
+                std::string axisName = name + (axis == 0 ? "/x" : "/y");
+                axes[axis] = std::make_shared<inputs::JoystickAxis>(action, axis);
+                axes[axis]->SetName(axisName);
+                mapper.AddInput(axes[axis]);
+                auto output = std::make_shared<outputs::Analog>();
+                output->SetName(axisName + "/out");
+                mapper.AddOutput(output);
+                mapper.AddBind(std::make_shared<mappings::AxisToAxis>(axes[axis], output));
+                mapping.bindCount++;
+            }
+
+            // Stick direction to buttons, as for movement keys
+            auto rangeBind = std::make_shared<mappings::AxisRangeToButton>(axes[1]);
+            for (int range = 0; range < 2; range++)
+            {
+                auto output = std::make_shared<outputs::Button>();
+                output->SetName(name + "/range" + std::to_string(range));
+                mapper.AddOutput(output);
+                rangeBind->AddRange(range == 0 ? -1.0f : 0.5f, range == 0 ? -0.5f : 1.0f, output);
+            }
+            mapper.AddBind(rangeBind);
+            mapping.bindCount++;
+        }
+    }
+
+    void RunBindMapperLoad(uint32_t actionCount, bool incremental)
+    {
+        SyntheticMapping mapping;
+        BuildMapping(mapping, actionCount);
+        mapping.mapper.SetIncremental(incremental);
+        SyntheticBackend &backend = *mapping.backend;
+
+        DeviceRegistry devices(&backend);
+        devices.DiscoverAll();
+        PosePredictor::PredictionArray predictions = {};
+        PosePredictor::PoseArray poses;
+
+        const size_t iterations = 4000000 / actionCount;
+        double tickNs = bench::Measure([&]()
+                                       {
+            backend.BeginTick();
+            mapping.actions->Update();
+            util::Timestamp poseTime = backend.GetPoses(predictions, poses);
+            devices.UpdatePoses(poses, poseTime);
+            mapping.mapper.Update();
+            bench::DoNotOptimize(mapping.actions->GetTable().GetDownWords()[0]); },
+                                       iterations);
+
+        size_t skippedBinds = 0;
+        size_t ticks = 0;
+        double mapperNs = bench::Measure([&]()
+                                         {
+            backend.BeginTick();
+            mapping.actions->Update();
+            mapping.mapper.Update();
+            skippedBinds += mapping.mapper.GetSkippedBindCount();
+            ticks++; },
+                                         iterations);
+        double actionsNs = bench::Measure([&]()
+                                          {
+            backend.BeginTick();
+            mapping.actions->Update(); },
+                                          iterations);
+
+        std::string suffix = " (" + std::to_string(actionCount) + " actions, " +
+                             std::to_string(mapping.bindCount) + " binds";
+        if (incremental)
+            suffix += ", incremental, " + std::to_string(skippedBinds / ticks) + " skipped";
+        suffix += ")";
+        bench::Report("synthetic mapping tick" + suffix, tickNs);
+        bench::Report("BindMapper::Update" + suffix, mapperNs - actionsNs);
+    }
+}
+
+BENCHMARK(BindMapperLoad)
+{
+    for (bool incremental : {false, true})
+    {
+        RunBindMapperLoad(100, incremental);
+        RunBindMapperLoad(1000, incremental);
+        RunBindMapperLoad(5000, incremental);
+        RunBindMapperLoad(20000, incremental);
+    }
+}
@@ -0,0 +1,124 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "util/filter_bank.hpp"
+
+// Cost of one filter bank pass over many channels at a 1 kHz tick, and the
+// jitter/lag trade-off of each stage type. Jitter is the RMS error on a
+// still signal with noise and occasional spikes. Lag is measured on a clean
+// ramp as the steady state error over the slope, next to the latency the
+// bank reports.
+
+namespace
+{
+    const auto kTick = std::chrono::milliseconds(1);
+
+    util::FilterChain MakeChain(const std::string &name)
+    {
+        util::FilterChain chain;
+        util::FilterStage stage;
+        if (name == "median3" || name == "median3 + one_euro")
+        {
+            stage.type = util::FilterStage::Type::kMedian3;
+            chain.push_back(stage);
+        }
+        if (name == "low_pass 10 Hz")
+        {
+            stage.type = util::FilterStage::Type::kLowPass;
+            stage.cutoff = 10.0f;
+            chain.push_back(stage);
+        }
+        if (name == "one_euro" || name == "median3 + one_euro")
+        {
+            stage.type = util::FilterStage::Type::kOneEuro;
+            stage.minCutoff = 2.0f;
+            stage.beta = 5.0f;
+            chain.push_back(stage);
+        }
+        if (name == "slew_limit 2/s")
+        {
+            stage.type = util::FilterStage::Type::kSlewLimit;
+            stage.maxRate = 2.0f;
+            chain.push_back(stage);
+        }
+        return chain;
+    }
+
+    void RunFilterPass(size_t channelCount)
+    {
+        util::FilterBank bank;
+        for (size_t i = 0; i < channelCount; i++)
+            bank.AddChannel(MakeChain("median3 + one_euro"));
+
+        bench::Noise noise;
+        util::Timestamp time = util::Clock::now();
+        double ns = bench::Measure([&]()
+                                   {
+            time += kTick;
+            for (size_t i = 0; i < channelCount; i++)
+                bank.SetInput(static_cast<util::FilterBank::Channel>(i), noise.Next());
+            bank.Update(time);
+            bench::DoNotOptimize(bank.GetOutput(0)); },
+                                   20000);
+        bench::Report("FilterBank::Update (" + std::to_string(channelCount) + " channels, 2 stages)", ns);
+    }
+
+    void RunTradeOff(const std::string &name)
+    {
+        const size_t kSamples = 4000;
+
+        // Jitter on a still signal
+        util::FilterBank still;
+        still.AddChannel(MakeChain(name));
+        bench::Noise noise;
+        util::Timestamp time = util::Clock::now();
+        double inputSquares = 0.0;
+        double outputSquares = 0.0;
+        for (size_t i = 0; i < kSamples; i++)
+        {
+            time += kTick;
+            float value = noise.Next() * 0.01f;
+            if (i % 97 == 0)
+                value += 0.2f;
+            still.SetInput(0, value);
+            still.Update(time);
+            if (i >= kSamples / 2)
+            {
+                inputSquares += value * value;
+                outputSquares += still.GetOutput(0) * still.GetOutput(0);
+            }
+        }
+
+        // Lag on a ramp of 1 unit per second
+        util::FilterBank ramp;
+        ramp.AddChannel(MakeChain(name));
+        time = util::Clock::now();
+        float value = 0.0f;
+        for (size_t i = 0; i < kSamples; i++)
+        {
+            time += kTick;
+            value += 0.001f;
+            ramp.SetInput(0, value);
+            ramp.Update(time);
+        }
+        float lagMs = (value - ramp.GetOutput(0)) * 1000.0f;
+
+        size_t count = kSamples - kSamples / 2;
+        std::printf("  %-22s jitter %.4f -> %.4f, lag %5.1f ms (reported %5.1f ms)\n",
+                    name.c_str(), std::sqrt(inputSquares / count), std::sqrt(outputSquares / count),
+                    lagMs, ramp.GetLatency(0) * 1000.0f);
+    }
+}
+
+BENCHMARK(FilterBank)
+{
+    RunFilterPass(16);
+    RunFilterPass(256);
+    RunFilterPass(4096);
+    for (const char *name : {"none", "median3", "low_pass 10 Hz", "one_euro", "median3 + one_euro", "slew_limit 2/s"})
+        RunTradeOff(name);
+}
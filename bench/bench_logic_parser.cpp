@@ -0,0 +1,88 @@
+#include "bench.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mappings/logic_parser.hpp"
+#include "vr/actions.hpp"
+#include "vr/synthetic_backend.hpp"
+
+// Parse throughput of button logic expressions. A config's worth of random
+// expressions (nested parentheses, every operator) over a pool of digital
+// actions is compiled into a fresh bind mapper per iteration, as on load.
+
+namespace
+{
+    struct ExpressionGenerator
+    {
+        const std::vector<std::string> *names = nullptr;
+        bench::Noise noise{1};
+
+        void Generate(std::string &out, int depth)
+        {
+            uint32_t choice = noise.NextBits() % 8;
+            if (depth <= 0 || choice < 3)
+            {
+                out += (*names)[noise.NextBits() % names->size()];
+                return;
+            }
+            if (choice == 3)
+            {
+                out += "!";
+                Generate(out, depth - 1);
+                return;
+            }
+
+            static const char *kOperators[] = {" && ", " || ", " ^ ", " != "};
+            out += "(";
+            Generate(out, depth - 1);
+            out += kOperators[noise.NextBits() % 4];
+            Generate(out, depth - 1);
+            out += ")";
+        }
+    };
+
+    void RunLogicParse(uint32_t expressionCount)
+    {
+        SyntheticSettings settings;
+        settings.digitalActionCount = 256;
+        settings.analogActionCount = 0;
+        auto backend = std::make_shared<SyntheticBackend>(settings);
+        ActionSet actions(backend, "/actions/synthetic");
+        for (const std::string &name : backend->GetDigitalActionNames())
+            actions.AddAction(std::make_shared<ButtonAction>(name));
+
+        ExpressionGenerator generator;
+        generator.names = &backend->GetDigitalActionNames();
+        std::vector<std::string> expressions(expressionCount);
+        size_t totalLength = 0;
+        for (std::string &expression : expressions)
+        {
+            generator.Generate(expression, 5);
+            totalLength += expression.size();
+        }
+
+        size_t nodeCount = 0;
+        const size_t iterations = 2000000 / expressionCount;
+        double ns = bench::Measure([&]()
+                                   {
+            mappings::BindMapper mapper;
+            for (const std::string &expression : expressions)
+                bench::DoNotOptimize(uint64_t(LogicParser::ParseButtonLogic(expression, mapper, actions) != nullptr));
+            nodeCount = mapper.GetButtonProgram()->GetInstructionCount(); },
+                                   iterations > 10 ? iterations : 10);
+
+        std::string suffix = " (" + std::to_string(expressionCount) + " expressions, " +
+                             std::to_string(totalLength / expressionCount) + " chars avg, " +
+                             std::to_string(nodeCount) + " nodes)";
+        bench::Report("LogicParser per config" + suffix, ns);
+        bench::Report("LogicParser per expression" + suffix, ns / expressionCount);
+    }
+}
+
+BENCHMARK(LogicParse)
+{
+    RunLogicParse(1000);
+    RunLogicParse(5000);
+}
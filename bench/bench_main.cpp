@@ -0,0 +1,62 @@
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace bench
+{
+
+    namespace
+    {
+        struct Entry
+        {
+            const char *name;
+            BenchmarkFunction function;
+        };
+
+        std::vector<Entry> &GetRegistry()
+        {
+            static std::vector<Entry> registry;
+            return registry;
+        }
+
+        volatile uint64_t g_sinkInt = 0;
+        volatile float g_sinkFloat = 0.0f;
+    }
+
+    Registration::Registration(const char *name, BenchmarkFunction function)
+    {
+        GetRegistry().push_back({name, function});
+    }
+
+    void DoNotOptimize(uint64_t value)
+    {
+        g_sinkInt = value;
+    }
+
+    void DoNotOptimize(float value)
+    {
+        g_sinkFloat = value;
+    }
+
+    void Report(const std::string &name, double nanosecondsPerIteration)
+    {
+        std::printf("  %-48s %12.1f ns\n", name.c_str(), nanosecondsPerIteration);
+    }
+
+}
+
+/// Usage: dandy-vr-remap-bench [benchmark name filter]
+int main(int argc, char **argv)
+{
+    const char *filter = argc > 1 ? argv[1] : nullptr;
+    for (auto &entry : bench::GetRegistry())
+    {
+        if (filter && !std::strstr(entry.name, filter))
+            continue;
+        std::printf("%s\n", entry.name);
+        entry.function();
+    }
+    return 0;
+}
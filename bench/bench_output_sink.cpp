@@ -0,0 +1,193 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "outputs/injection_thread.hpp"
+#include "outputs/outputs.hpp"
+#include "outputs/recording_sink.hpp"
+#include "util/timing.hpp"
+
+// Cost of batching a tick's output events: keyboard keys toggle on staggered
+// periods and both mouse axes move every tick, so each tick's batch holds a
+// few key events and one merged motion event, submitted in a single call to
+// a recording sink. The handoff benchmark measures what the mapping thread
+// pays to queue a batch for the injection thread instead, and the latency
+// until the injection thread has submitted it. The overflow check stalls
+// the target until batches are dropped.
+
+namespace
+{
+    void RunOutputBatching(size_t keyCount)
+    {
+        std::vector<std::shared_ptr<outputs::KeyboardKey>> keys;
+        for (size_t i = 0; i < keyCount; i++)
+            keys.push_back(std::make_shared<outputs::KeyboardKey>(static_cast<int32_t>(i + 1)));
+        outputs::MouseMovement moveX(0);
+        outputs::MouseMovement moveY(1);
+        outputs::RecordingSink sink;
+
+        uint64_t tick = 0;
+        double ns = bench::Measure([&]()
+                                   {
+            tick++;
+            util::Timestamp now = util::Clock::now();
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                keys[i]->PreUpdate();
+                keys[i]->SetState((tick / (i + 2)) % 2 == 0, now);
+                if (keys[i]->HasPendingEvent())
+                    keys[i]->Update(sink);
+            }
+            moveX.PreUpdate();
+            moveY.PreUpdate();
+            moveX.SetValue(3.0f, now);
+            moveY.SetValue(-2.0f, now);
+            moveX.Update(sink);
+            moveY.Update(sink);
+            sink.Flush();
+            if (sink.GetBatchCount() >= 4096)
+                sink.Clear(); });
+
+        double eventsPerBatch = static_cast<double>(sink.GetEvents().size()) / sink.GetBatchCount();
+        bench::Report("OutputSink batch (" + std::to_string(keyCount) + " keys)", ns);
+        std::printf("    %.1f events per batch, 1 submit per tick\n", eventsPerBatch);
+    }
+}
+
+BENCHMARK(OutputBatching)
+{
+    RunOutputBatching(4);
+    RunOutputBatching(16);
+    RunOutputBatching(64);
+}
+
+namespace
+{
+    /// @brief Counts submitted batches without storing them, so the
+    /// injection thread's side of the handoff stays cheap
+    class CountingSink : public outputs::OutputSink
+    {
+    public:
+        std::atomic<uint64_t> events{0};
+
+    protected:
+        virtual void Submit(const std::vector<outputs::OutputEvent> &batch) override
+        {
+            events.fetch_add(batch.size(), std::memory_order_relaxed);
+        }
+    };
+}
+
+BENCHMARK(InjectionHandoff)
+{
+    // Paced like the mapping thread, since a producer flushing back to back
+    // only measures how quickly the queue overflows
+    const size_t kTicks = 2000;
+    const auto kTickPeriod = std::chrono::microseconds(500);
+
+    auto target = std::make_shared<CountingSink>();
+    outputs::InjectionThread injector(target);
+    injector.Start();
+
+    double flushNs = 0.0;
+    util::Timestamp deadline = util::Clock::now();
+    for (size_t tick = 0; tick < kTicks; tick++)
+    {
+        deadline += kTickPeriod;
+        util::SleepUntil(deadline);
+        injector.AddKey(static_cast<int32_t>(tick % 64) + 1, true);
+        injector.AddKey(static_cast<int32_t>(tick % 64) + 1, false);
+        injector.AddMouseMove(3, -2);
+        auto start = std::chrono::steady_clock::now();
+        injector.Flush();
+        auto end = std::chrono::steady_clock::now();
+        flushNs += std::chrono::duration<double, std::nano>(end - start).count();
+    }
+    outputs::InjectionStats stats = injector.GetStats();
+    injector.Stop();
+
+    bench::Report("InjectionThread flush (3 events)", flushNs / kTicks);
+    std::printf("    latency avg %.1f us, max %.1f us, max depth %zu, %llu overflows, %llu dropped\n",
+                stats.averageLatencyUs, stats.maxLatencyUs, stats.maxQueueDepth,
+                static_cast<unsigned long long>(stats.overflows),
+                static_cast<unsigned long long>(stats.droppedBatches));
+}
+
+namespace
+{
+    /// @brief Records batches, but holds the injection thread in its first
+    /// submit until released, like a target stalled by the desktop
+    class StallingSink : public outputs::RecordingSink
+    {
+    public:
+        std::atomic<bool> stalled{true};
+
+    protected:
+        virtual void Submit(const std::vector<outputs::OutputEvent> &events) override
+        {
+            while (stalled.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            outputs::RecordingSink::Submit(events);
+        }
+    };
+}
+
+BENCHMARK(InjectionOverflow)
+{
+    // Keys are pressed, then wheel batches fill the queue and backlog behind
+    // a stalled target, so the batch releasing the keys is dropped. Its
+    // releases must still reach the target, and Stop() must inject the
+    // backlog before returning.
+    const int32_t kKeyCount = 8;
+    const size_t kWheelBatches = 6;
+    const size_t kWheelEvents = 512;
+
+    auto target = std::make_shared<StallingSink>();
+    outputs::InjectionThread injector(target);
+    injector.Start();
+
+    for (int32_t key = 1; key <= kKeyCount; key++)
+        injector.AddKey(key, true);
+    injector.Flush();
+    for (size_t batch = 0; batch < kWheelBatches; batch++)
+    {
+        for (size_t i = 0; i < kWheelEvents; i++)
+            injector.AddMouseWheel(1);
+        injector.Flush();
+    }
+    for (int32_t key = 1; key <= kKeyCount; key++)
+        injector.AddKey(key, false);
+    injector.AddKey(kKeyCount + 1, true);
+    injector.Flush();
+    injector.AddKey(kKeyCount + 1, false);
+    injector.Flush();
+
+    outputs::InjectionStats stats = injector.GetStats();
+    target->stalled = false;
+    injector.Stop();
+
+    std::vector<int32_t> held;
+    size_t wheelEvents = 0;
+    for (const outputs::OutputEvent &event : target->GetEvents())
+    {
+        if (event.type == outputs::OutputEvent::Type::kMouseWheel)
+            wheelEvents++;
+        else if (event.type == outputs::OutputEvent::Type::kKey && event.down)
+            held.push_back(event.code);
+        else if (event.type == outputs::OutputEvent::Type::kKey)
+            held.erase(std::remove(held.begin(), held.end(), event.code), held.end());
+    }
+    size_t droppedWheelBatches = stats.droppedBatches - 2;
+    size_t expectedWheelEvents = (kWheelBatches - droppedWheelBatches) * kWheelEvents;
+
+    std::printf("  %llu of %zu batches dropped\n",
+                static_cast<unsigned long long>(stats.droppedBatches), kWheelBatches + 3);
+    std::printf("  no key left held by dropped releases: %s\n", held.empty() ? "pass" : "FAIL");
+    std::printf("  backlog injected by Stop(): %s\n",
+                wheelEvents == expectedWheelEvents ? "pass" : "FAIL");
+}
@@ -0,0 +1,66 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "mappings/response_curve.hpp"
+
+// Cost of shaping an analog value with std::pow against a baked response
+// curve lookup. The curve is a spline through 17 samples of the same power
+// function, and its maximum error against std::pow is printed alongside.
+
+namespace
+{
+    const float kExponent = 1.7f;
+    const size_t kValueCount = 4096;
+
+    std::vector<float> BuildValues()
+    {
+        std::vector<float> values(kValueCount);
+        bench::Noise noise;
+        for (auto &value : values)
+            value = noise.NextUnit() * 2.0f - 1.0f;
+        return values;
+    }
+}
+
+BENCHMARK(ResponseCurve)
+{
+    std::vector<float> values = BuildValues();
+
+    std::vector<Vector2f> points;
+    for (int i = 0; i <= 16; i++)
+    {
+        float x = i / 16.0f;
+        points.push_back(Vector2f(x, std::pow(x, kExponent)));
+    }
+    mappings::ResponseCurve curve = mappings::ResponseCurve::FromPoints(points);
+
+    double powNs = bench::Measure([&]()
+                                  {
+        float sum = 0.0f;
+        for (float value : values)
+            sum += std::copysign(std::pow(std::fabs(value), kExponent), value);
+        bench::DoNotOptimize(sum); },
+                                  2000);
+    bench::Report("std::pow (4096 values)", powNs);
+
+    double lookupNs = bench::Measure([&]()
+                                     {
+        float sum = 0.0f;
+        for (float value : values)
+            sum += curve.Evaluate(value);
+        bench::DoNotOptimize(sum); },
+                                     2000);
+    bench::Report("ResponseCurve::Evaluate (4096 values)", lookupNs);
+
+    float maxError = 0.0f;
+    for (float value : values)
+    {
+        float expected = std::copysign(std::pow(std::fabs(value), kExponent), value);
+        maxError = std::fmax(maxError, std::fabs(curve.Evaluate(value) - expected));
+    }
+    std::printf("    %.2f vs %.2f ns/value, max absolute error %.2e\n",
+                powNs / kValueCount, lookupNs / kValueCount, maxError);
+}
@@ -0,0 +1,123 @@
+#include "bench.hpp"
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "util/timer_wheel.hpp"
+
+// Cost of the gesture timer wheel with many pending timers. Each fired timer
+// is rescheduled 1-2000 ms ahead, so the pending count stays constant while
+// simulated time advances 1 ms per tick. Timers due in a tick are fired in
+// that tick's advance. GetNextDeadline() is checked against the pending
+// deadlines: it must never be later than the earliest, and should be exact.
+
+namespace
+{
+    struct Rescheduler : util::TimerListener
+    {
+        util::TimerWheel *wheel = nullptr;
+        util::Timestamp now;
+        bench::Noise noise;
+        uint64_t fired = 0;
+
+        virtual void OnTimer(uint32_t cookie, util::Timestamp deadline) override
+        {
+            fired++;
+            wheel->Schedule(now + std::chrono::microseconds(1000 + noise.NextBits() % 1999000), this, cookie);
+        }
+    };
+
+    void RunTimerWheel(size_t timerCount)
+    {
+        util::TimerWheel wheel;
+        Rescheduler listener;
+        listener.wheel = &wheel;
+        listener.now = util::Clock::now();
+        for (size_t i = 0; i < timerCount; i++)
+        {
+            wheel.Schedule(listener.now + std::chrono::microseconds(listener.noise.NextBits() % 2000000),
+                           &listener, static_cast<uint32_t>(i));
+        }
+
+        const size_t tickCount = 20000;
+        double ns = bench::Measure([&]()
+                                   {
+            listener.now += std::chrono::milliseconds(1);
+            wheel.Advance(listener.now); },
+                                   tickCount);
+        bench::Report("TimerWheel::Advance (" + std::to_string(timerCount) + " pending)", ns);
+        std::printf("    %.1f timers fired per tick\n", static_cast<double>(listener.fired) / tickCount);
+
+        double scheduleNs = bench::Measure([&]()
+                                           {
+            auto id = wheel.Schedule(listener.now + std::chrono::milliseconds(300), &listener);
+            wheel.Cancel(id); });
+        bench::Report("TimerWheel::Schedule + Cancel (" + std::to_string(timerCount) + " pending)",
+                      scheduleNs);
+    }
+
+    struct Tracker : util::TimerListener
+    {
+        std::multimap<util::Timestamp, util::TimerWheel::TimerId> pending;
+
+        virtual void OnTimer(uint32_t cookie, util::Timestamp deadline) override
+        {
+            pending.erase(pending.find(deadline));
+        }
+    };
+
+    void RunNextDeadlineCheck()
+    {
+        util::TimerWheel wheel;
+        Tracker tracker;
+        bench::Noise noise;
+        util::Timestamp now = util::Clock::now();
+        size_t late = 0;
+        size_t exact = 0;
+        const size_t stepCount = 200000;
+        for (size_t step = 0; step < stepCount; step++)
+        {
+            uint32_t choice = noise.NextBits() % 8;
+            if (choice < 3)
+            {
+                // Spread deadlines over every wheel level
+                uint64_t us = noise.NextBits() % (2000u << ((noise.NextBits() % 4) * 6));
+                util::Timestamp deadline = now + std::chrono::microseconds(us);
+                tracker.pending.emplace(deadline, wheel.Schedule(deadline, &tracker));
+            }
+            else if (choice == 3 && !tracker.pending.empty())
+            {
+                auto it = tracker.pending.begin();
+                std::advance(it, noise.NextBits() % tracker.pending.size());
+                wheel.Cancel(it->second);
+                tracker.pending.erase(it);
+            }
+            else
+            {
+                now += std::chrono::microseconds(noise.NextBits() % 5000);
+                wheel.Advance(now);
+            }
+
+            util::Timestamp expected = tracker.pending.empty() ? util::Timestamp::max()
+                                                               : tracker.pending.begin()->first;
+            util::Timestamp next = wheel.GetNextDeadline();
+            if (expected < next)
+                late++;
+            else if (next == expected)
+                exact++;
+        }
+
+        std::printf("  GetNextDeadline never after the earliest pending deadline: %s\n",
+                    late == 0 ? "pass" : "FAIL");
+        std::printf("    exact in %.1f%% of %zu states\n", 100.0 * exact / stepCount, stepCount);
+    }
+}
+
+BENCHMARK(TimerWheel)
+{
+    RunNextDeadlineCheck();
+    RunTimerWheel(100);
+    RunTimerWheel(10000);
+    RunTimerWheel(100000);
+}
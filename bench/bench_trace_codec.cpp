@@ -0,0 +1,119 @@
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "trace/trace_codec.hpp"
+
+// Cost and size of trace tick records, and a round trip check: ticks are
+// encoded in keyframed segments as the flight recorder writes them, then
+// decoded and compared with the frames they came from. One device leaves
+// and comes back between keyframes and another leaves for good, so deltas
+// have to carry departures as well as arrivals.
+
+namespace
+{
+    const size_t kTicks = 300;
+    const size_t kKeyframeInterval = 100;
+    const size_t kDeviceCount = 3;
+
+    std::vector<trace::Frame> MakeFrames()
+    {
+        std::vector<trace::Frame> frames(kTicks);
+        for (size_t tick = 0; tick < kTicks; tick++)
+        {
+            trace::Frame &frame = frames[tick];
+            frame.Reset(8, 2);
+            frame.timeUs = tick * 1000;
+            for (size_t slot = 0; slot < frame.digitalDown.size(); slot++)
+                frame.digitalDown[slot] = (tick / (slot + 3)) % 2;
+            frame.analogX[0] = std::sin(tick * 0.05f);
+            frame.analogY[0] = std::cos(tick * 0.05f);
+
+            for (size_t index = 0; index < kDeviceCount; index++)
+            {
+                // Device 2 is gone from tick 130 to 170, device 1 from 250
+                bool present = !(index == 2 && tick >= 130 && tick < 170) &&
+                               !(index == 1 && tick >= 250);
+                if (!present)
+                    continue;
+                frame.deviceMask |= uint64_t(1) << index;
+                vr::TrackedDevicePose_t &pose = frame.poses[index];
+                pose.bDeviceIsConnected = true;
+                pose.bPoseIsValid = true;
+                pose.eTrackingResult = vr::TrackingResult_Running_OK;
+                for (size_t row = 0; row < 3; row++)
+                {
+                    for (size_t col = 0; col < 4; col++)
+                        pose.mDeviceToAbsoluteTracking.m[row][col] = std::sin(tick * 0.01f + row + col * 0.5f + index);
+                }
+            }
+        }
+        return frames;
+    }
+
+    std::vector<uint8_t> Encode(const std::vector<trace::Frame> &frames)
+    {
+        std::vector<uint8_t> data;
+        for (size_t tick = 0; tick < frames.size(); tick++)
+        {
+            bool keyframe = tick % kKeyframeInterval == 0;
+            trace::EncodeTick(frames[tick], frames[keyframe ? tick : tick - 1], keyframe, data);
+        }
+        return data;
+    }
+
+    bool SamePose(const vr::TrackedDevicePose_t &a, const vr::TrackedDevicePose_t &b)
+    {
+        return a.bDeviceIsConnected == b.bDeviceIsConnected && a.bPoseIsValid == b.bPoseIsValid &&
+               std::memcmp(&a.mDeviceToAbsoluteTracking, &b.mDeviceToAbsoluteTracking,
+                           sizeof(a.mDeviceToAbsoluteTracking)) == 0;
+    }
+
+    /// @return the first tick which didn't round trip, or kTicks
+    size_t CheckRoundTrip(const std::vector<trace::Frame> &frames, const std::vector<uint8_t> &data)
+    {
+        trace::Frame decoded;
+        decoded.Reset(8, 2);
+        const uint8_t *cursor = data.data();
+        const uint8_t *end = data.data() + data.size();
+        for (size_t tick = 0; tick < frames.size(); tick++)
+        {
+            const trace::Frame &frame = frames[tick];
+            if (!trace::DecodeTick(cursor, end, decoded) ||
+                decoded.timeUs != frame.timeUs ||
+                decoded.digitalDown != frame.digitalDown ||
+                decoded.analogX != frame.analogX ||
+                decoded.analogY != frame.analogY ||
+                decoded.deviceMask != frame.deviceMask)
+                return tick;
+            for (size_t index = 0; index < kDeviceCount; index++)
+            {
+                if ((frame.deviceMask & (uint64_t(1) << index)) &&
+                    !SamePose(decoded.poses[index], frame.poses[index]))
+                    return tick;
+            }
+        }
+        return cursor == end ? kTicks : kTicks - 1;
+    }
+}
+
+BENCHMARK(TraceCodec)
+{
+    std::vector<trace::Frame> frames = MakeFrames();
+    std::vector<uint8_t> data = Encode(frames);
+
+    double ns = bench::Measure([&]()
+                               { bench::DoNotOptimize(static_cast<uint64_t>(Encode(frames).size())); },
+                               1000);
+    bench::Report("EncodeTick per tick (3 devices)", ns / kTicks);
+    std::printf("    %.1f bytes per tick\n", static_cast<double>(data.size()) / kTicks);
+
+    size_t failedTick = CheckRoundTrip(frames, data);
+    if (failedTick == kTicks)
+        std::printf("  round trip with devices leaving between keyframes: pass\n");
+    else
+        std::printf("  round trip with devices leaving between keyframes: FAIL at tick %zu\n", failedTick);
+}
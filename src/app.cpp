@@ -1,9 +1,13 @@
 #include "app.hpp"
 
 #include "mappings/bind_config.hpp"
+#include "trace/trace_replay_backend.hpp"
+#include "vr/openvr_backend.hpp"
 #include <cstdio>
 #include <iostream>
+#if defined(_WIN32)
 #include <Windows.h>
+#endif
 #include <cmgMath/cmg_math.h>
 
 namespace
@@ -56,23 +60,6 @@ namespace
 		return "";
 #endif
 	}
-
-	//-----------------------------------------------------------------------------
-	// Purpose: Helper to get a string from a tracked device property and turn it
-	//			into a std::string
-	//-----------------------------------------------------------------------------
-	std::string GetTrackedDeviceString(vr::TrackedDeviceIndex_t unDevice, vr::TrackedDeviceProperty prop, vr::TrackedPropertyError *peError = NULL)
-	{
-		uint32_t unRequiredBufferLen = vr::VRSystem()->GetStringTrackedDeviceProperty(unDevice, prop, NULL, 0, peError);
-		if (unRequiredBufferLen == 0)
-			return "";
-
-		char *pchBuffer = new char[unRequiredBufferLen];
-		unRequiredBufferLen = vr::VRSystem()->GetStringTrackedDeviceProperty(unDevice, prop, pchBuffer, unRequiredBufferLen, peError);
-		std::string sResult = pchBuffer;
-		delete[] pchBuffer;
-		return sResult;
-	}
 }
 
 App::App() {}
@@ -84,6 +71,14 @@ App::~App()
 
 void App::Terminate()
 {
+	if (m_mapping)
+	{
+		CMG_LOG_INFO() << "Stopping mapping thread";
+		m_mapping->Stop();
+		m_mapping = nullptr;
+	}
+	m_backend = nullptr;
+
 	if (m_hmd)
 	{
 		CMG_LOG_INFO() << "Shutting down VR Runtime";
@@ -92,48 +87,66 @@ void App::Terminate()
 	}
 }
 
+void App::SetReplay(const std::string &tracePath, bool fast)
+{
+	m_replayPath = tracePath;
+	m_replayFast = fast;
+}
+
 void App::OnInitialize()
 {
-	CMG_LOG_INFO() << "Initializing VR Runtime";
+	if (m_replayPath.empty())
+	{
+		CMG_LOG_INFO() << "Initializing VR Runtime";
 
-	// Loading the SteamVR Runtime
-	vr::EVRInitError error = vr::VRInitError_None;
-	m_hmd = vr::VR_Init(&error, vr::VRApplication_Background);
-	if (error != vr::VRInitError_None || m_hmd == nullptr)
+		// Loading the SteamVR Runtime
+		vr::EVRInitError error = vr::VRInitError_None;
+		m_hmd = vr::VR_Init(&error, vr::VRApplication_Background);
+		if (error != vr::VRInitError_None || m_hmd == nullptr)
+		{
+			m_hmd = nullptr;
+			CMG_LOG_ERROR() << "Failed to initialize VR runtime: " << vr::VR_GetVRInitErrorAsEnglishDescription(error);
+			Quit();
+			return;
+		}
+		m_backend = std::make_shared<OpenVrBackend>(m_hmd);
+	}
+	else
 	{
-		m_hmd = nullptr;
-		CMG_LOG_ERROR() << "Failed to initialize VR runtime: " << vr::VR_GetVRInitErrorAsEnglishDescription(error);
-		Quit();
-		return;
+		// Replay a recorded trace with no runtime
+		auto replay = std::make_shared<trace::TraceReplayBackend>(m_replayFast);
+		if (replay->Open(m_replayPath).Failed())
+		{
+			CMG_LOG_ERROR() << "Failed to load trace: " << m_replayPath;
+			Quit();
+			return;
+		}
+		m_backend = replay;
 	}
 
 	// Get HMD info
-	std::string hmdTrackingSystem = GetTrackedDeviceString(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_TrackingSystemName_String);
-	std::string hmdSerialNumber = GetTrackedDeviceString(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SerialNumber_String);
+	std::string hmdTrackingSystem = m_backend->GetDeviceString(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_TrackingSystemName_String);
+	std::string hmdSerialNumber = m_backend->GetDeviceString(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SerialNumber_String);
 	CMG_LOG_INFO() << "HMD Tracking System: " << hmdTrackingSystem;
 	CMG_LOG_INFO() << "HMD Serial Number: " << hmdSerialNumber;
 
 	// Load actions
-	Path configDir = GetExecutablePath().GetParent() / "../../config";
+	Path exeDir = GetExecutablePath().GetParent();
+	Path configDir = exeDir / "../../config";
 	Path actionManifestPath = configDir / "actions.json";
 	CMG_LOG_INFO() << "Action Manifest Path: " << actionManifestPath;
-	vr::VRInput()->SetActionManifestPath(actionManifestPath.c_str());
-	m_actions = std::make_shared<Tf2ActionSet>();
-	m_actions->Load(actionManifestPath);
-
-	// Load bind mappings
-	mappings::BindConfigLoader bindConfigLoader(m_bindMapper, *m_actions);
+	if (m_hmd)
+		vr::VRInput()->SetActionManifestPath(actionManifestPath.c_str());
+	auto actions = std::make_shared<Tf2ActionSet>(m_backend);
+	actions->Load(actionManifestPath);
+
+	// Load bind mappings and start mapping on its own thread
+	m_mapping = std::make_shared<MappingThread>(m_backend, actions);
+	m_mapping->SetTraceDirectory(exeDir.c_str());
+	m_mapping->SetInjectOutput(m_replayPath.empty());
 	Path bindConfigPath = configDir / "tf2_binds.json";
-	bindConfigLoader.LoadConfig(bindConfigPath);
-
-	// Create Aim Controller
-	m_aimController = std::make_shared<mappings::SphereAimController>(
-		m_rightController,
-		m_bindMapper.GetInputOfType<inputs::Button>("enable_look"),
-		m_bindMapper.GetOutputOfType<outputs::MouseMovement>("look_x"),
-		m_bindMapper.GetOutputOfType<outputs::MouseMovement>("look_y"));
-	m_aimController->SetName("Aim");
-	m_bindMapper.AddBind(m_aimController);
+	m_mapping->LoadBindConfig(bindConfigPath);
+	m_mapping->Start();
 
 	// Load assets
 	auto resourceManager = GetResourceManager();
@@ -157,113 +170,24 @@ void App::OnUpdate(float dt)
 	// Escape: Quit
 	if (keyboard->IsKeyPressed(Keys::escape))
 	{
+		if (m_mapping)
+			m_mapping->PushCommand(MappingCommand::kShutdown);
 		Quit();
 		return;
 	}
 
 	// Enter: toggle control mapping
-	if (keyboard->IsKeyPressed(Keys::enter))
+	if (keyboard->IsKeyPressed(Keys::enter) && m_mapping)
 	{
-		m_controlMappingEnabled = !m_controlMappingEnabled;
+		m_mapping->PushCommand(MappingCommand::kToggleMapping);
 		return;
 	}
 
-	// Update VR actions
-	m_actions->Update();
-
-	// Get poses for all trackers
-	std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> devicePoses;
-	m_hmd->GetDeviceToAbsoluteTrackingPose(
-		vr::TrackingUniverseStanding, 0.0f, devicePoses.data(), devicePoses.size());
-
-	for (int index = 0; index < vr::k_unMaxTrackedDeviceCount; ++index)
-	{
-		auto it = m_devices.find(index);
-		auto &pose = devicePoses[index];
-		m_hmd->GetTrackedDeviceClass(index);
-		if (m_hmd->GetTrackedDeviceClass(index) != vr::TrackedControllerRole_Invalid)
-		{
-			if (it == m_devices.end())
-				auto device = AddDevice(index, pose);
-			else
-				UpdateDevice(it->second, pose);
-		}
-	}
-
-	// Update control mapping
-	if (m_controlMappingEnabled)
-	{
-		m_aimController->SetInputDevice(m_rightController);
-		m_bindMapper.Update();
-	}
-}
-
-std::shared_ptr<VrDevice> App::AddDevice(uint32_t index, const vr::TrackedDevicePose_t &pose)
-{
-	std::shared_ptr<VrDevice> device = std::make_shared<VrDevice>();
-	device->index = index;
-	m_devices[device->index] = device;
-	UpdateDevice(device, pose);
-	CMG_LOG_INFO() << "New Device: " << "index=" << index << ", type=\"" << device->type << "\"";
-	return device;
-}
-
-void App::UpdateDevice(std::shared_ptr<VrDevice> device, const vr::TrackedDevicePose_t &pose)
-{
-	switch (m_hmd->GetTrackedDeviceClass(device->index))
-	{
-	case vr::TrackedDeviceClass_Controller:
-	{
-		device->type = "Controller";
-		auto role = m_hmd->GetControllerRoleForTrackedDeviceIndex(device->index);
-		if (role == vr::TrackedControllerRole_LeftHand)
-		{
-			device->type = "Controller (Left)";
-			m_leftController = device;
-		}
-		else if (role == vr::TrackedControllerRole_RightHand)
-		{
-			device->type = "Controller (Right)";
-			m_rightController = device;
-		}
-		break;
-	}
-	case vr::TrackedDeviceClass_HMD:
-		device->type = "HMD";
-		break;
-	case vr::TrackedDeviceClass_Invalid:
-		device->type = "Invalid";
-		break;
-	case vr::TrackedDeviceClass_GenericTracker:
-		device->type = "Generic Tracker";
-		break;
-	case vr::TrackedDeviceClass_TrackingReference:
-		device->type = "Tracking Reference";
-		break;
-	default:
-		device->type = "Unknown";
-		break;
-	}
-
-	device->connected = pose.bDeviceIsConnected;
-	device->poseValid = pose.bPoseIsValid;
-
-	// Update pose data
-	if (device->poseValid)
+	// F9: dump the flight recorder to a trace file
+	if (keyboard->IsKeyPressed(Keys::f9) && m_mapping)
 	{
-		device->velocity.x = pose.vVelocity.v[0];
-		device->velocity.y = pose.vVelocity.v[1];
-		device->velocity.z = pose.vVelocity.v[2];
-		device->position.x = pose.mDeviceToAbsoluteTracking.m[0][3];
-		device->position.y = pose.mDeviceToAbsoluteTracking.m[1][3];
-		device->position.z = pose.mDeviceToAbsoluteTracking.m[2][3];
-		for (size_t col = 0; col < 3; col++)
-		{
-			for (size_t row = 0; row < 3; row++)
-			{
-				device->orientation.c[col][row] = pose.mDeviceToAbsoluteTracking.m[row][col];
-			}
-		}
+		m_mapping->PushCommand(MappingCommand::kDumpTrace);
+		return;
 	}
 }
 
@@ -271,6 +195,10 @@ void App::OnRender()
 {
 	auto renderDevice = GetRenderDevice();
 
+	// Only read state published by the mapping thread
+	if (m_mapping)
+		m_mapping->GetStatus(m_status);
+
 	glEnable(GL_TEXTURE_2D);
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -284,26 +212,25 @@ void App::OnRender()
 
 	// Display device status
 	float x = 16;
-	for (auto it : m_devices)
+	for (auto &device : m_status.devices)
 	{
 		std::stringstream ss;
-		auto &device = it.second;
-		ss << "Device " << device->index << "\n";
-		ss << device->type << "\n";
-		if (device->connected)
+		ss << "Device " << device.index << "\n";
+		ss << device.type << "\n";
+		if (device.connected)
 			ss << "connected\n";
 		else
 			ss << "disconnected\n";
-		if (device->poseValid)
+		if (device.poseValid)
 			ss << "pose valid\n";
 		else
 			ss << "pose invalid\n";
 		ss << "position" << "\n";
-		ss << "  x: " << device->position.x << "\n";
-		ss << "  y: " << device->position.y << "\n";
-		ss << "  z: " << device->position.z << "\n";
+		ss << "  x: " << device.position.x << "\n";
+		ss << "  y: " << device.position.y << "\n";
+		ss << "  z: " << device.position.z << "\n";
 		ss << "direction" << "\n";
-		auto direction = device->orientation.c1;
+		auto direction = device.orientation.c1;
 		ss << "  x: " << direction.x << "\n";
 		ss << "  y: " << direction.y << "\n";
 		ss << "  z: " << direction.z << "\n";
@@ -314,9 +241,9 @@ void App::OnRender()
 		textBounds.size.x = 160 - 8;
 		textBounds.Inflate(4, 4);
 		Color color = Color::YELLOW;
-		if (!device->connected)
+		if (!device.connected)
 			color = Color::GRAY;
-		else if (!device->poseValid)
+		else if (!device.poseValid)
 			color = Color::RED;
 		g.DrawString(m_font.get(), text, pos, color);
 		g.DrawRect(textBounds, color);
@@ -339,7 +266,28 @@ void App::OnRender()
 
 	{
 		std::stringstream ss;
-		ss << "Control Mapping: " << (m_controlMappingEnabled ? "ENABLED" : "DISABLED") << "\n";
+		ss << "Control Mapping: " << (m_status.controlMappingEnabled ? "ENABLED" : "DISABLED") << "\n";
+		ss << "Tick Rate: " << m_status.measuredTickRate << " / " << m_status.targetTickRate << " Hz\n";
+		ss << "Look Latency to Injection: " << m_status.lookInjectionLatencyMs << " ms (pose age "
+		   << m_status.lookPoseAgeMs << " ms, filter " << m_status.lookFilterMs
+		   << " ms, predicted " << m_status.lookPredictionMs << " ms; excludes game and display)\n";
+		if (m_status.lookLateLatched)
+			ss << "Late Latch: pose age " << m_status.lookTickPoseAgeMs << " ms per tick, "
+			   << m_status.lookPoseAgeMs << " ms latched\n";
+		if (m_status.incrementalUpdate)
+			ss << "Skipped Per Tick: " << m_status.skippedBindsPerTick << " / " << m_status.bindCount
+			   << " binds, " << m_status.skippedOutputsPerTick << " / " << m_status.outputCount << " outputs\n";
+		else
+			ss << "Binds: " << m_status.bindCount << " (incremental update off)\n";
+		ss << "Injection: " << m_status.injection.batches << " batches, depth "
+		   << m_status.injection.queueDepth << " (max " << m_status.injection.maxQueueDepth << "), "
+		   << m_status.injection.overflows << " overflows, " << m_status.injection.droppedBatches
+		   << " dropped, latency "
+		   << m_status.injection.averageLatencyUs << " / " << m_status.injection.maxLatencyUs << " us\n";
+		if (!m_replayPath.empty())
+			ss << "Replaying: " << m_replayPath << "\n";
+		else
+			ss << "Flight Recorder: " << (m_status.flightRecorderBytes / 1024) << " KiB (F9 to dump)\n";
 		g.DrawString(m_font.get(), ss.str(), Vector2f(16, 240), Color::YELLOW);
 	}
 
@@ -347,12 +295,7 @@ void App::OnRender()
 	{
 		std::stringstream ss;
 		ss << "Inputs:\n";
-		size_t index = 0;
-		for (auto it : m_bindMapper.GetInputs())
-		{
-			it.second->DebugString(ss) << "\n";
-			index++;
-		}
+		ss << m_status.inputsText;
 		g.DrawString(m_font.get(), ss.str(), Vector2f(16, 260), Color::YELLOW);
 	}
 
@@ -360,12 +303,7 @@ void App::OnRender()
 	{
 		std::stringstream ss;
 		ss << "Outputs:\n";
-		size_t index = 0;
-		for (auto it : m_bindMapper.GetOutputs())
-		{
-			it.second->DebugString(ss) << "\n";
-			index++;
-		}
+		ss << m_status.outputsText;
 		g.DrawString(m_font.get(), ss.str(), Vector2f(300, 260), Color::YELLOW);
 	}
 
@@ -375,7 +313,7 @@ void App::OnRender()
 		Matrix4f::CreateRotation(Vector3f::UNITZ, Math::PI));
 
 	// Draw play area rect
-	vr::IVRChaperone *chaperone = vr::VRChaperone();
+	vr::IVRChaperone *chaperone = m_hmd ? vr::VRChaperone() : nullptr;
 	if (chaperone)
 	{
 		vr::HmdQuad_t rect;
@@ -391,40 +329,41 @@ void App::OnRender()
 	}
 
 	// Draw devices
-	for (auto &it : m_devices)
+	for (auto &device : m_status.devices)
 	{
-		if (it.second->connected)
+		if (device.connected)
 		{
-			Matrix3f orientation = it.second->orientation;
+			Matrix3f orientation = device.orientation;
 			Vector3f direction = orientation * -Vector3f::UNITZ;
 			g.DrawLine(
-				it.second->position.GetXZ(),
-				(it.second->position + direction * 0.2f).GetXZ(),
+				device.position.GetXZ(),
+				(device.position + direction * 0.2f).GetXZ(),
 				Color::YELLOW);
-			g.FillCircle(it.second->position.GetXZ(), 0.05f, Color::YELLOW);
+			g.FillCircle(device.position.GetXZ(), 0.05f, Color::YELLOW);
 		}
 	}
 
-	if (m_aimController->m_inputDevice)
+	const AimStatus &aim = m_status.aim;
+	if (aim.hasInputDevice)
 	{
 		g.DrawLine(
-			m_aimController->m_center.GetXZ(),
-			(m_aimController->m_center + m_aimController->m_directionOffset * m_aimController->m_radius).GetXZ(),
+			aim.center.GetXZ(),
+			(aim.center + aim.directionOffset * aim.radius).GetXZ(),
 			Color::GRAY);
-		g.DrawCircle(m_aimController->m_center.GetXZ(), m_aimController->m_radius, Color::GREEN);
+		g.DrawCircle(aim.center.GetXZ(), aim.radius, Color::GREEN);
 
-		g.DrawLine(m_aimController->m_inputDevice->position.GetXZ(),
-				   m_aimController->m_inputDevice->position.GetXZ() + m_aimController->m_direction.GetXZ(),
+		g.DrawLine(aim.devicePosition.GetXZ(),
+				   aim.devicePosition.GetXZ() + aim.direction.GetXZ(),
 				   Color::GREEN);
-		g.DrawLine(m_aimController->m_inputDevice->position.GetXZ(),
-				   m_aimController->m_rayHitPoint.GetXZ(),
+		g.DrawLine(aim.devicePosition.GetXZ(),
+				   aim.rayHitPoint.GetXZ(),
 				   Color::DARK_RED);
 		g.DrawLine(
-			m_aimController->m_center.GetXZ(),
-			(m_aimController->m_center + m_aimController->m_direction * m_aimController->m_radius).GetXZ(),
+			aim.center.GetXZ(),
+			(aim.center + aim.direction * aim.radius).GetXZ(),
 			Color::RED);
-		g.FillCircle(m_aimController->m_rayHitPoint.GetXZ(), 0.04f, Color::RED);
-		g.FillCircle(m_aimController->m_inputDevice->position.GetXZ(), 0.06f, Color::GREEN);
+		g.FillCircle(aim.rayHitPoint.GetXZ(), 0.04f, Color::RED);
+		g.FillCircle(aim.devicePosition.GetXZ(), 0.06f, Color::GREEN);
 	}
 
 	/*
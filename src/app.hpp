@@ -12,9 +12,8 @@
 #include <cmgMath/cmg_math.h>
 
 #include "vr/actions.hpp"
-#include "vr/device.hpp"
-#include "mappings/bindings.hpp"
-#include "mappings/sphere_aim_controller.hpp"
+#include "vr/input_backend.hpp"
+#include "mapping_thread.hpp"
 
 class Tf2ActionSet : public ActionSet
 {
@@ -35,7 +34,7 @@ public:
 	std::shared_ptr<HapticAction> hapticLeft;
 	std::shared_ptr<HapticAction> hapticRight;
 
-	Tf2ActionSet() : ActionSet("/actions/tf2")
+	Tf2ActionSet(std::shared_ptr<InputBackend> backend) : ActionSet(backend, "/actions/tf2")
 	{
 		AddAction(jump = std::make_shared<ButtonAction>("/actions/tf2/in/Jump"));
 		AddAction(duck = std::make_shared<ButtonAction>("/actions/tf2/in/Duck"));
@@ -63,6 +62,10 @@ public:
 
 	void Terminate();
 
+	/// @brief Replay input from a trace file instead of running against
+	/// SteamVR. Must be called before Initialize().
+	void SetReplay(const std::string &tracePath, bool fast);
+
 	void OnInitialize() override;
 	void OnQuit() override;
 	void OnResizeWindow(int width, int height) override;
@@ -70,20 +73,13 @@ public:
 	void OnRender() override;
 
 private:
-	std::shared_ptr<VrDevice> AddDevice(uint32_t index, const vr::TrackedDevicePose_t &pose);
-	void UpdateDevice(std::shared_ptr<VrDevice> device, const vr::TrackedDevicePose_t &pose);
-
 	vr::IVRSystem *m_hmd = nullptr;
+	std::shared_ptr<InputBackend> m_backend;
+	std::string m_replayPath;
+	bool m_replayFast = false;
 
-	std::shared_ptr<Tf2ActionSet> m_actions;
-	std::map<uint32_t, std::shared_ptr<VrDevice>> m_devices;
-	std::shared_ptr<VrDevice> m_rightController = nullptr;
-	std::shared_ptr<VrDevice> m_leftController = nullptr;
-
-	mappings::BindMapper m_bindMapper;
-	std::shared_ptr<mappings::SphereAimController> m_aimController;
-
-	bool m_controlMappingEnabled = true;
+	std::shared_ptr<MappingThread> m_mapping;
+	MappingStatus m_status;
 
 	Font::sptr m_font = nullptr;
 };
@@ -0,0 +1,183 @@
+#include "inputs/button_program.hpp"
+
+#include <algorithm>
+
+namespace inputs
+{
+
+    ButtonProgram::Register ButtonProgram::AddAction(const ButtonAction &action)
+    {
+        // All actions must come from the same action set
+        if (m_table == nullptr)
+        {
+            m_table = &action.GetTable();
+            m_actionDown = &m_table->GetDownWords();
+        }
+        Register reg = action.GetSlot();
+        if (m_actionNames.size() <= reg)
+            m_actionNames.resize(reg + 1);
+        m_actionNames[reg] = action.identifier;
+        return reg;
+    }
+
+    ButtonProgram::Register ButtonProgram::AddInstruction(OpCode op, Register a, Register b)
+    {
+        m_requestedCount++;
+
+        Instruction instruction;
+        instruction.op = op;
+        instruction.a = a;
+        instruction.b = op == OpCode::kNot ? a : b;
+
+        // Normalize so structurally equal expressions share a key
+        if (op != OpCode::kNot && instruction.b < instruction.a)
+            std::swap(instruction.a, instruction.b);
+        if (op == OpCode::kNot && IsTemp(a))
+        {
+            const Instruction &inner = m_instructions[a & kTempMask];
+            if (inner.op == OpCode::kNot)
+                return inner.a;
+        }
+        if ((op == OpCode::kAnd || op == OpCode::kOr) && instruction.a == instruction.b)
+            return instruction.a;
+
+        auto it = m_instructionLookup.find(instruction);
+        if (it != m_instructionLookup.end())
+            return it->second;
+
+        Register reg = static_cast<Register>(m_instructions.size()) | kTempFlag;
+        m_instructions.push_back(instruction);
+        m_instructionLookup[instruction] = reg;
+
+        size_t wordCount = (m_instructions.size() + 63) / 64;
+        m_tempDown.resize(wordCount, 0);
+        m_tempPrev.resize(wordCount, 0);
+        m_tempPressed.resize(wordCount, 0);
+        m_tempReleased.resize(wordCount, 0);
+        return reg;
+    }
+
+    ButtonProgram::Register ButtonProgram::AddInput(Input *input)
+    {
+        Register reg = static_cast<Register>(m_inputs.size()) | kInputFlag;
+        m_inputs.push_back({input, m_instructions.size()});
+
+        size_t wordCount = (m_inputs.size() + 63) / 64;
+        m_inputDown.resize(wordCount, 0);
+        m_inputPrev.resize(wordCount, 0);
+        m_inputPressed.resize(wordCount, 0);
+        m_inputReleased.resize(wordCount, 0);
+        return reg;
+    }
+
+    void ButtonProgram::RemoveInput(Register reg)
+    {
+        m_inputs[reg & kInputMask].input = nullptr;
+    }
+
+    void ButtonProgram::Update()
+    {
+        // Instructions and inputs only read registers defined before them,
+        // so one in-order pass evaluates everything
+        size_t next = 0;
+        for (size_t index = 0; index < m_inputs.size(); index++)
+        {
+            const InputSlot &slot = m_inputs[index];
+            Evaluate(next, slot.firstInstruction);
+            next = slot.firstInstruction;
+
+            const uint64_t value = slot.input != nullptr && slot.input->EvaluateInput() ? 1 : 0;
+            uint64_t &word = m_inputDown[index >> 6];
+            const uint64_t shift = index & 63;
+            word = (word & ~(uint64_t(1) << shift)) | (value << shift);
+        }
+        Evaluate(next, m_instructions.size());
+
+        UpdateEdges(m_tempDown, m_tempPrev, m_tempPressed, m_tempReleased);
+        UpdateEdges(m_inputDown, m_inputPrev, m_inputPressed, m_inputReleased);
+    }
+
+    void ButtonProgram::Evaluate(size_t first, size_t last)
+    {
+        for (size_t index = first; index < last; index++)
+        {
+            const Instruction &instruction = m_instructions[index];
+            const uint64_t a = ReadBit(instruction.a);
+            const uint64_t b = ReadBit(instruction.b);
+            uint64_t value;
+            switch (instruction.op)
+            {
+            case OpCode::kNot:
+                value = a ^ 1;
+                break;
+            case OpCode::kAnd:
+                value = a & b;
+                break;
+            case OpCode::kOr:
+                value = a | b;
+                break;
+            default:
+                value = a ^ b;
+                break;
+            }
+            uint64_t &word = m_tempDown[index >> 6];
+            const uint64_t shift = index & 63;
+            word = (word & ~(uint64_t(1) << shift)) | (value << shift);
+        }
+    }
+
+    void ButtonProgram::UpdateEdges(const std::vector<uint64_t> &downWords,
+                                    std::vector<uint64_t> &prevWords,
+                                    std::vector<uint64_t> &pressedWords,
+                                    std::vector<uint64_t> &releasedWords)
+    {
+        for (size_t word = 0; word < downWords.size(); word++)
+        {
+            const uint64_t down = downWords[word];
+            const uint64_t prev = prevWords[word];
+            pressedWords[word] = down & ~prev;
+            releasedWords[word] = ~down & prev;
+            prevWords[word] = down;
+        }
+    }
+
+    util::Timestamp ButtonProgram::GetTimestamp(Register reg) const
+    {
+        if (IsInput(reg))
+        {
+            const Input *input = m_inputs[reg & kInputMask].input;
+            return input != nullptr ? input->GetInputTimestamp() : util::Timestamp();
+        }
+        if (!IsTemp(reg))
+            return m_table->GetDigitalChangeTime(reg);
+        const Instruction &instruction = m_instructions[reg & kTempMask];
+        util::Timestamp timestamp = GetTimestamp(instruction.a);
+        if (instruction.op != OpCode::kNot)
+            timestamp = std::max(timestamp, GetTimestamp(instruction.b));
+        return timestamp;
+    }
+
+    std::string ButtonProgram::ToString(Register reg) const
+    {
+        if (IsInput(reg))
+        {
+            const Input *input = m_inputs[reg & kInputMask].input;
+            return input != nullptr ? input->GetInputText() : "(removed)";
+        }
+        if (!IsTemp(reg))
+            return m_actionNames[reg];
+        const Instruction &instruction = m_instructions[reg & kTempMask];
+        switch (instruction.op)
+        {
+        case OpCode::kNot:
+            return "!" + ToString(instruction.a);
+        case OpCode::kAnd:
+            return "(" + ToString(instruction.a) + " && " + ToString(instruction.b) + ")";
+        case OpCode::kOr:
+            return "(" + ToString(instruction.a) + " || " + ToString(instruction.b) + ")";
+        default:
+            return "(" + ToString(instruction.a) + " != " + ToString(instruction.b) + ")";
+        }
+    }
+
+}
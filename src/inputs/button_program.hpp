@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "vr/actions.hpp"
+#include "util/timing.hpp"
+
+namespace inputs
+{
+
+    /// @brief Button logic compiled to a flat instruction stream over packed
+    /// bits. Registers name one bit each: action registers read the action
+    /// state table's down words in place, and every instruction writes a new
+    /// temporary register. A tick runs the instructions in order, then derives
+    /// pressed/released for all temporaries with word-wide ops on the previous
+    /// and current bits. Timestamps are only resolved for registers asked for.
+    ///
+    /// Instructions are hash-consed: adding one that is structurally equal to
+    /// an existing instruction (commutative operands are ordered first)
+    /// returns the existing register, so the program is a DAG in which every
+    /// shared sub-expression is evaluated exactly once per tick.
+    ///
+    /// Input registers hold the state of buttons which are themselves
+    /// computed from registers, such as timed gestures. Each is evaluated in
+    /// the pass at the point it was added, after the instructions it can read
+    /// and before any that read it.
+    class ButtonProgram
+    {
+    public:
+        using Register = uint32_t;
+
+        /// @brief A button evaluated by the program from registers added
+        /// before it
+        class Input
+        {
+        public:
+            virtual ~Input() {}
+
+            /// @brief Update the button for this tick
+            /// @return whether it is down
+            virtual bool EvaluateInput() = 0;
+
+            virtual util::Timestamp GetInputTimestamp() const = 0;
+            virtual std::string GetInputText() const = 0;
+        };
+
+        enum class OpCode : uint8_t
+        {
+            kNot,
+            kAnd,
+            kOr,
+            kXor,
+        };
+
+        struct Instruction
+        {
+            OpCode op;
+            Register a;
+            Register b;
+        };
+
+        /// @brief Get the register holding a digital action's state
+        Register AddAction(const ButtonAction &action);
+
+        /// @brief Append an instruction, or find an equivalent one
+        /// @return the register holding its result
+        Register AddInstruction(OpCode op, Register a, Register b = 0);
+
+        /// @brief Get a register holding an input's state. The input may
+        /// only read registers added before this call.
+        Register AddInput(Input *input);
+
+        /// @brief Stop evaluating an input; its register reads as up
+        void RemoveInput(Register reg);
+
+        /// @brief Evaluate every instruction for this tick
+        void Update();
+
+        inline bool IsDown(Register reg) const
+        {
+            if (IsTemp(reg))
+                return TestBit(m_tempDown, reg & kTempMask);
+            if (IsInput(reg))
+                return TestBit(m_inputDown, reg & kInputMask);
+            return m_table->IsDown(reg);
+        }
+
+        inline bool IsPressed(Register reg) const
+        {
+            if (IsTemp(reg))
+                return TestBit(m_tempPressed, reg & kTempMask);
+            if (IsInput(reg))
+                return TestBit(m_inputPressed, reg & kInputMask);
+            return m_table->IsPressed(reg);
+        }
+
+        inline bool IsReleased(Register reg) const
+        {
+            if (IsTemp(reg))
+                return TestBit(m_tempReleased, reg & kTempMask);
+            if (IsInput(reg))
+                return TestBit(m_inputReleased, reg & kInputMask);
+            return m_table->IsReleased(reg);
+        }
+
+        /// @brief Time of the latest hardware change among the actions a
+        /// register depends on
+        util::Timestamp GetTimestamp(Register reg) const;
+
+        /// @brief Expression text for a register, for debugging
+        std::string ToString(Register reg) const;
+
+        inline size_t GetInstructionCount() const { return m_instructions.size(); }
+
+        /// @brief Number of instructions requested by the parser, including
+        /// ones that were folded into an existing register
+        inline size_t GetRequestedCount() const { return m_requestedCount; }
+
+    private:
+        static const Register kTempFlag = 0x80000000u;
+        static const Register kTempMask = 0x7FFFFFFFu;
+
+        static const Register kInputFlag = 0x40000000u;
+        static const Register kInputMask = 0x3FFFFFFFu;
+
+        static inline bool IsTemp(Register reg) { return (reg & kTempFlag) != 0; }
+        static inline bool IsInput(Register reg) { return (reg & (kTempFlag | kInputFlag)) == kInputFlag; }
+
+        static inline bool TestBit(const std::vector<uint64_t> &words, Register index)
+        {
+            return (words[index >> 6] >> (index & 63)) & 1;
+        }
+
+        inline uint64_t ReadBit(Register reg) const
+        {
+            if (IsTemp(reg))
+            {
+                reg &= kTempMask;
+                return (m_tempDown[reg >> 6] >> (reg & 63)) & 1;
+            }
+            if (IsInput(reg))
+            {
+                reg &= kInputMask;
+                return (m_inputDown[reg >> 6] >> (reg & 63)) & 1;
+            }
+            return (m_actionDown->data()[reg >> 6] >> (reg & 63)) & 1;
+        }
+
+        /// @brief Evaluate instructions [first, last)
+        void Evaluate(size_t first, size_t last);
+
+        /// @brief Derive pressed/released words and roll the previous words
+        static void UpdateEdges(const std::vector<uint64_t> &downWords,
+                                std::vector<uint64_t> &prevWords,
+                                std::vector<uint64_t> &pressedWords,
+                                std::vector<uint64_t> &releasedWords);
+
+        struct InputSlot
+        {
+            Input *input;
+            /// @brief Instructions before this one are evaluated first
+            size_t firstInstruction;
+        };
+
+        struct InstructionHash
+        {
+            inline size_t operator()(const Instruction &instruction) const
+            {
+                uint64_t key = (uint64_t(instruction.a) << 32) | instruction.b;
+                key ^= uint64_t(instruction.op) * 0x9E3779B97F4A7C15ull;
+                return std::hash<uint64_t>()(key);
+            }
+        };
+
+        struct InstructionEqual
+        {
+            inline bool operator()(const Instruction &x, const Instruction &y) const
+            {
+                return x.op == y.op && x.a == y.a && x.b == y.b;
+            }
+        };
+
+        const ActionStateTable *m_table = nullptr;
+        const std::vector<uint64_t> *m_actionDown = nullptr;
+        std::vector<std::string> m_actionNames;
+        std::vector<Instruction> m_instructions;
+        std::vector<uint64_t> m_tempDown;
+        std::vector<uint64_t> m_tempPrev;
+        std::vector<uint64_t> m_tempPressed;
+        std::vector<uint64_t> m_tempReleased;
+        std::vector<InputSlot> m_inputs;
+        std::vector<uint64_t> m_inputDown;
+        std::vector<uint64_t> m_inputPrev;
+        std::vector<uint64_t> m_inputPressed;
+        std::vector<uint64_t> m_inputReleased;
+        std::unordered_map<Instruction, Register, InstructionHash, InstructionEqual> m_instructionLookup;
+        size_t m_requestedCount = 0;
+    };
+
+}
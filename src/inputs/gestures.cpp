@@ -0,0 +1,237 @@
+#include "inputs/gestures.hpp"
+
+#include <algorithm>
+
+namespace inputs
+{
+
+    GestureButton::GestureButton(std::shared_ptr<ButtonProgram> program,
+                                 std::vector<ButtonProgram::Register> sources,
+                                 std::shared_ptr<util::TimerWheel> timers,
+                                 util::Clock::duration duration)
+        : ButtonFromProgram(program, 0),
+          m_sources(std::move(sources)),
+          m_duration(duration),
+          m_timers(timers)
+    {
+        m_sourceDown.assign(m_sources.size(), 0);
+        m_pressTimes.assign(m_sources.size(), util::Timestamp());
+        m_register = m_program->AddInput(this);
+    }
+
+    GestureButton::~GestureButton()
+    {
+        m_program->RemoveInput(m_register);
+        StopTimer();
+    }
+
+    bool GestureButton::EvaluateInput()
+    {
+        m_downPrev = m_down;
+        if (m_releasePending)
+        {
+            m_down = false;
+            m_releasePending = false;
+        }
+
+        // Gather this tick's source changes, in the order they happened on
+        // the hardware
+        m_edges.clear();
+        for (size_t source = 0; source < m_sources.size(); source++)
+        {
+            bool down = m_program->IsDown(m_sources[source]);
+            if (down == IsSourceDown(source))
+                continue;
+            util::Timestamp time = m_program->GetTimestamp(m_sources[source]);
+            if (time == util::Timestamp())
+                time = util::Clock::now();
+            m_edges.push_back({time, source, down});
+        }
+        if (m_edges.size() > 1)
+        {
+            std::stable_sort(m_edges.begin(), m_edges.end(),
+                             [](const SourceEdge &a, const SourceEdge &b)
+                             { return a.time < b.time; });
+        }
+
+        // A timer fired by this tick's advance is handled in order with the
+        // source changes, so a release just before the deadline wins
+        for (const SourceEdge &edge : m_edges)
+        {
+            if (m_timerFired && !(edge.time < m_deadline))
+            {
+                m_timerFired = false;
+                OnDeadline(m_deadline);
+            }
+            m_sourceDown[edge.source] = edge.down ? 1 : 0;
+            if (edge.down)
+            {
+                m_pressTimes[edge.source] = edge.time;
+                OnSourcePressed(edge.source, edge.time);
+            }
+            else
+            {
+                OnSourceReleased(edge.source, edge.time);
+            }
+        }
+        if (m_timerFired)
+        {
+            m_timerFired = false;
+            OnDeadline(m_deadline);
+        }
+
+        m_changed = m_down != m_downPrev;
+        return m_down;
+    }
+
+    std::string GestureButton::ToString() const
+    {
+        std::string text = std::string(GetGestureName()) + "(";
+        for (auto reg : m_sources)
+            text += m_program->ToString(reg) + ", ";
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(m_duration);
+        return text + std::to_string(ms.count()) + " ms)";
+    }
+
+    void GestureButton::StartTimer(util::Timestamp deadline)
+    {
+        StopTimer();
+        m_timer = m_timers->Schedule(deadline, this);
+    }
+
+    void GestureButton::StopTimer()
+    {
+        if (m_timer != util::TimerWheel::kInvalidTimer)
+            m_timers->Cancel(m_timer);
+        m_timer = util::TimerWheel::kInvalidTimer;
+        m_timerFired = false;
+    }
+
+    void GestureButton::SetDown(bool down, util::Timestamp time)
+    {
+        if (!down && m_down && !m_downPrev)
+        {
+            m_releasePending = true;
+            return;
+        }
+        if (down == m_down)
+            return;
+        m_down = down;
+        m_timestamp = time;
+    }
+
+    void GestureButton::Pulse(util::Timestamp time)
+    {
+        SetDown(true, time);
+        m_releasePending = true;
+    }
+
+    void GestureButton::OnTimer(uint32_t cookie, util::Timestamp deadline)
+    {
+        m_timer = util::TimerWheel::kInvalidTimer;
+        m_timerFired = true;
+        m_deadline = deadline;
+    }
+
+    void HoldButton::OnSourcePressed(size_t source, util::Timestamp time)
+    {
+        StartTimer(time + m_duration);
+    }
+
+    void HoldButton::OnSourceReleased(size_t source, util::Timestamp time)
+    {
+        StopTimer();
+        SetDown(false, time);
+    }
+
+    void HoldButton::OnDeadline(util::Timestamp deadline)
+    {
+        if (IsSourceDown(0))
+            SetDown(true, deadline);
+    }
+
+    TapButton::TapButton(std::shared_ptr<ButtonProgram> program,
+                         std::vector<ButtonProgram::Register> sources,
+                         std::shared_ptr<util::TimerWheel> timers,
+                         util::Clock::duration duration,
+                         util::Clock::duration doubleTapWindow)
+        : GestureButton(program, std::move(sources), timers, duration),
+          m_doubleTapWindow(doubleTapWindow)
+    {
+    }
+
+    void TapButton::OnSourcePressed(size_t source, util::Timestamp time)
+    {
+        // Pressed again while waiting out the window: a double tap, so
+        // neither press is a tap
+        if (IsTimerPending())
+        {
+            StopTimer();
+            m_doubleTapped = true;
+        }
+    }
+
+    void TapButton::OnSourceReleased(size_t source, util::Timestamp time)
+    {
+        if (m_doubleTapped)
+        {
+            m_doubleTapped = false;
+            return;
+        }
+        if (time - m_pressTimes[source] >= m_duration)
+            return;
+        if (m_doubleTapWindow > util::Clock::duration::zero())
+            StartTimer(time + m_doubleTapWindow);
+        else
+            Pulse(time);
+    }
+
+    void TapButton::OnDeadline(util::Timestamp deadline)
+    {
+        Pulse(deadline);
+    }
+
+    void DoubleTapButton::OnSourcePressed(size_t source, util::Timestamp time)
+    {
+        if (m_armed && time - m_releaseTime <= m_duration)
+            SetDown(true, time);
+        m_armed = false;
+    }
+
+    void DoubleTapButton::OnSourceReleased(size_t source, util::Timestamp time)
+    {
+        if (m_down)
+        {
+            SetDown(false, time);
+            return;
+        }
+        m_armed = time - m_pressTimes[source] < m_duration;
+        m_releaseTime = time;
+    }
+
+    void ChordButton::OnSourcePressed(size_t source, util::Timestamp time)
+    {
+        util::Timestamp first = time;
+        for (size_t other = 0; other < m_sources.size(); other++)
+        {
+            if (!IsSourceDown(other))
+                return;
+            first = std::min(first, m_pressTimes[other]);
+        }
+        if (time - first <= m_duration)
+            SetDown(true, time);
+    }
+
+    void ChordButton::OnSourceReleased(size_t source, util::Timestamp time)
+    {
+        if (m_down)
+            SetDown(false, time);
+    }
+
+    void ReleaseAfterHoldButton::OnSourceReleased(size_t source, util::Timestamp time)
+    {
+        if (time - m_pressTimes[source] >= m_duration)
+            Pulse(time);
+    }
+
+}
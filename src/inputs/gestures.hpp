@@ -0,0 +1,158 @@
+#pragma once
+
+#include "inputs/inputs.hpp"
+#include "util/timer_wheel.hpp"
+#include <vector>
+
+namespace inputs
+{
+    /// @brief Base class for button inputs which recognize a timed gesture
+    /// on registers of a button logic program. Decisions are made on the
+    /// hardware change times of the sources, and gestures which complete
+    /// without another input change (such as a hold) are fired by a timer
+    /// wheel at their exact deadline. The wheel must be advanced before the
+    /// program is evaluated.
+    ///
+    /// Each gesture owns an input register of the program, which evaluates it
+    /// in order with the instructions, so button logic can read a gesture as
+    /// an operand within the same tick.
+    class GestureButton : public ButtonFromProgram,
+                          public ButtonProgram::Input,
+                          public util::TimerListener
+    {
+    public:
+        GestureButton(std::shared_ptr<ButtonProgram> program,
+                      std::vector<ButtonProgram::Register> sources,
+                      std::shared_ptr<util::TimerWheel> timers,
+                      util::Clock::duration duration);
+        virtual ~GestureButton();
+
+        /// @brief Does nothing; the program evaluates the gesture
+        virtual void Update() override {}
+        virtual std::string ToString() const override;
+
+        virtual bool EvaluateInput() override;
+        virtual util::Timestamp GetInputTimestamp() const override { return m_timestamp; }
+        virtual std::string GetInputText() const override { return ToString(); }
+
+    protected:
+        virtual const char *GetGestureName() const = 0;
+        virtual void OnSourcePressed(size_t source, util::Timestamp time) {}
+        virtual void OnSourceReleased(size_t source, util::Timestamp time) {}
+        virtual void OnDeadline(util::Timestamp deadline) {}
+
+        void StartTimer(util::Timestamp deadline);
+        void StopTimer();
+        inline bool IsTimerPending() const { return m_timer != util::TimerWheel::kInvalidTimer; }
+
+        /// @brief Set the state for this tick. A release in the same tick
+        /// as the press is deferred to the next so both edges are seen.
+        void SetDown(bool down, util::Timestamp time);
+
+        /// @brief Press for a single tick
+        void Pulse(util::Timestamp time);
+
+        inline bool IsSourceDown(size_t source) const { return m_sourceDown[source] != 0; }
+
+        std::vector<ButtonProgram::Register> m_sources;
+        std::vector<uint8_t> m_sourceDown;
+        std::vector<util::Timestamp> m_pressTimes;
+        util::Clock::duration m_duration;
+
+    private:
+        virtual void OnTimer(uint32_t cookie, util::Timestamp deadline) override;
+
+        struct SourceEdge
+        {
+            util::Timestamp time;
+            size_t source;
+            bool down;
+        };
+
+        std::shared_ptr<util::TimerWheel> m_timers;
+        util::TimerWheel::TimerId m_timer = util::TimerWheel::kInvalidTimer;
+        bool m_timerFired = false;
+        util::Timestamp m_deadline;
+        bool m_releasePending = false;
+        std::vector<SourceEdge> m_edges;
+    };
+
+    /// @brief Down once the source has been held for the duration, until it
+    /// is released
+    class HoldButton : public GestureButton
+    {
+    public:
+        using GestureButton::GestureButton;
+
+    protected:
+        virtual const char *GetGestureName() const override { return "hold"; }
+        virtual void OnSourcePressed(size_t source, util::Timestamp time) override;
+        virtual void OnSourceReleased(size_t source, util::Timestamp time) override;
+        virtual void OnDeadline(util::Timestamp deadline) override;
+    };
+
+    /// @brief Pulses when the source is released within the duration of
+    /// being pressed. With a double tap window, the pulse waits out the
+    /// window and is dropped if the source is pressed again in it, so a tap
+    /// and a double tap can share a button.
+    class TapButton : public GestureButton
+    {
+    public:
+        TapButton(std::shared_ptr<ButtonProgram> program,
+                  std::vector<ButtonProgram::Register> sources,
+                  std::shared_ptr<util::TimerWheel> timers,
+                  util::Clock::duration duration,
+                  util::Clock::duration doubleTapWindow = util::Clock::duration::zero());
+
+    protected:
+        virtual const char *GetGestureName() const override { return "tap"; }
+        virtual void OnSourcePressed(size_t source, util::Timestamp time) override;
+        virtual void OnSourceReleased(size_t source, util::Timestamp time) override;
+        virtual void OnDeadline(util::Timestamp deadline) override;
+
+        util::Clock::duration m_doubleTapWindow;
+        bool m_doubleTapped = false;
+    };
+
+    /// @brief Down from the second press of two taps, where each press is
+    /// shorter than the duration and the second starts within the duration
+    /// of the first ending, until it is released
+    class DoubleTapButton : public GestureButton
+    {
+    public:
+        using GestureButton::GestureButton;
+
+    protected:
+        virtual const char *GetGestureName() const override { return "double_tap"; }
+        virtual void OnSourcePressed(size_t source, util::Timestamp time) override;
+        virtual void OnSourceReleased(size_t source, util::Timestamp time) override;
+
+        bool m_armed = false;
+        util::Timestamp m_releaseTime;
+    };
+
+    /// @brief Down while all sources are held, if they were all pressed
+    /// within the duration of each other
+    class ChordButton : public GestureButton
+    {
+    public:
+        using GestureButton::GestureButton;
+
+    protected:
+        virtual const char *GetGestureName() const override { return "chord"; }
+        virtual void OnSourcePressed(size_t source, util::Timestamp time) override;
+        virtual void OnSourceReleased(size_t source, util::Timestamp time) override;
+    };
+
+    /// @brief Pulses when the source is released after being held for at
+    /// least the duration
+    class ReleaseAfterHoldButton : public GestureButton
+    {
+    public:
+        using GestureButton::GestureButton;
+
+    protected:
+        virtual const char *GetGestureName() const override { return "release_after_hold"; }
+        virtual void OnSourceReleased(size_t source, util::Timestamp time) override;
+    };
+}
@@ -1,5 +1,7 @@
 #include "inputs/inputs.hpp"
 
+#include <algorithm>
+
 namespace inputs
 {
 
@@ -9,21 +11,6 @@ namespace inputs
         m_down = false;
     }
 
-    bool Button::IsDown() const
-    {
-        return m_down;
-    }
-
-    bool Button::IsPressed() const
-    {
-        return m_down && !m_downPrev;
-    }
-
-    bool Button::IsReleased() const
-    {
-        return !m_down && m_downPrev;
-    }
-
     std::ostream &Button::DebugString(std::ostream &stream) const
     {
         stream << m_name << ": " << (IsDown() ? "DOWN" : "UP");
@@ -43,49 +30,56 @@ namespace inputs
     void ButtonFromAction::Update()
     {
         Button::Update();
-        m_down = m_action->down;
+        m_down = m_action->IsDown();
+        m_changed = m_down != m_downPrev;
+        m_timestamp = m_action->GetChangeTime();
     }
 
-    ButtonBooleanOp::ButtonBooleanOp(Operator op, std::shared_ptr<Button> left, std::shared_ptr<Button> right)
-        : m_operator(op),
-          m_left(left),
-          m_right(right)
+    ButtonFromProgram::ButtonFromProgram(std::shared_ptr<ButtonProgram> program, ButtonProgram::Register reg)
+        : m_program(program), m_register(reg)
     {
     }
 
-    void ButtonBooleanOp::Update()
+    void ButtonFromProgram::Update()
     {
-        Button::Update();
-        m_left->Update();
-        m_right->Update();
-        if (m_operator == Operator::kAnd)
-            m_down = m_left->IsDown() && m_right->IsDown();
-        else if (m_operator == Operator::kOr)
-            m_down = m_left->IsDown() || m_right->IsDown();
-        else if (m_operator == Operator::kXor)
-            m_down = m_left->IsDown() != m_right->IsDown();
+        // Only edges are injected, so only they need a timestamp
+        m_downPrev = m_down;
+        m_down = m_program->IsDown(m_register);
+        m_changed = m_down != m_downPrev;
+        if (m_changed)
+            m_timestamp = m_program->GetTimestamp(m_register);
     }
 
-    ButtonUnaryOp::ButtonUnaryOp(Operator op, std::shared_ptr<Button> right)
-        : m_operator(op),
-          m_right(right)
+    std::ostream &Analog::DebugString(std::ostream &stream) const
     {
+        stream << m_name << ": " << GetValue();
+        if (IsFiltered())
+            stream << " (filter " << (GetFilterLatency() * 1000.0f) << " ms)";
+        return stream;
     }
 
-    void ButtonUnaryOp::Update()
+    void Analog::SetFilter(std::shared_ptr<util::FilterBank> filters, util::FilterBank::Channel channel)
     {
-        Button::Update();
-        m_right->Update();
-        if (m_operator == Operator::kNot)
-            m_down = !m_right->IsDown();
-        else
-            m_down = m_right->IsDown();
+        m_filters = filters;
+        m_filterChannel = channel;
     }
 
-    std::ostream &Analog::DebugString(std::ostream &stream) const
+    float Analog::GetFilterLatency() const
     {
-        stream << m_name << ": " << GetValue();
-        return stream;
+        return m_filters ? m_filters->GetLatency(m_filterChannel) : 0.0f;
+    }
+
+    void Analog::SubmitToFilter()
+    {
+        m_filters->SetInput(m_filterChannel, m_value);
+    }
+
+    void Analog::ApplyFilter()
+    {
+        // Keeps changing while the filter settles after the raw value stops
+        float value = m_filters->GetOutput(m_filterChannel);
+        m_changed = value != m_filteredValue;
+        m_value = m_filteredValue = value;
     }
 
     JoystickAxis::JoystickAxis(std::shared_ptr<JoystickAction> action, size_t axis)
@@ -95,7 +89,10 @@ namespace inputs
 
     void JoystickAxis::Update()
     {
+        float valuePrev = m_value;
         Analog::Update();
-        m_value = m_action->position[m_axis];
+        m_value = m_action->GetPosition()[m_axis];
+        m_changed = m_value != valuePrev;
+        m_timestamp = m_action->GetChangeTime();
     }
 }
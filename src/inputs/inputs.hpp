@@ -1,6 +1,10 @@
 #pragma once
 
 #include "vr/actions.hpp"
+#include "inputs/button_program.hpp"
+#include "util/filter_bank.hpp"
+#include "util/timing.hpp"
+#include <memory>
 #include <string>
 
 namespace inputs
@@ -25,22 +29,49 @@ namespace inputs
             return std::string("(") + m_name + ")";
         }
 
+        /// @brief Time of the hardware change that produced the current state
+        inline util::Timestamp GetTimestamp() const { return m_timestamp; }
+
+        /// @brief Whether the last Update() changed the input's state. Inputs
+        /// which can't tell always report a change.
+        inline bool HasChanged() const { return m_changed; }
+
     protected:
         std::string m_name;
+        util::Timestamp m_timestamp;
+        bool m_changed = true;
     };
 
-    /// @brief Base class for analog inputs which return a single float value
+    /// @brief Base class for analog inputs which return a single float value.
+    /// A filtered input's value is the output of its filter bank channel,
+    /// which the bank runs for all filtered inputs at once after they update.
     class Analog : public InputBase
     {
     public:
-        inline virtual float GetValue() const { return m_value; }
+        inline float GetValue() const { return m_value; }
 
         virtual void Update() override;
 
         virtual std::ostream &DebugString(std::ostream &stream) const override;
 
+        void SetFilter(std::shared_ptr<util::FilterBank> filters, util::FilterBank::Channel channel);
+        inline bool IsFiltered() const { return m_filters != nullptr; }
+
+        /// @brief Estimated delay the filter adds, in seconds
+        float GetFilterLatency() const;
+
+        /// @brief Feed the value from Update() into the filter bank
+        void SubmitToFilter();
+
+        /// @brief Take the filtered value once the filter bank has run
+        void ApplyFilter();
+
     protected:
         float m_value = 0.0f;
+
+        std::shared_ptr<util::FilterBank> m_filters;
+        util::FilterBank::Channel m_filterChannel = 0;
+        float m_filteredValue = 0.0f;
     };
 
     /// @brief Analog input which gets the position of a joystick axis
@@ -62,9 +93,9 @@ namespace inputs
     public:
         virtual void Update() override;
 
-        virtual bool IsDown() const;
-        virtual bool IsPressed() const;
-        virtual bool IsReleased() const;
+        inline bool IsDown() const { return m_down; }
+        inline bool IsPressed() const { return m_down && !m_downPrev; }
+        inline bool IsReleased() const { return !m_down && m_downPrev; }
 
         virtual std::ostream &DebugString(std::ostream &stream) const override;
 
@@ -90,66 +121,27 @@ namespace inputs
         std::shared_ptr<ButtonAction> m_action;
     };
 
-    /// @brief Binary logic operation between two buttons. Supports 'AND', and
-    /// 'OR'.
-    class ButtonBooleanOp : public Button
+    /// @brief Button input which reads one register of a compiled button
+    /// logic program. The program is evaluated once per tick for all inputs
+    /// sharing it, before inputs are updated; Update() latches the register
+    /// into the button state.
+    class ButtonFromProgram : public Button
     {
     public:
-        enum class Operator
-        {
-            kAnd,
-            kOr,
-            kXor,
-        };
-
-        ButtonBooleanOp(Operator op, std::shared_ptr<Button> left,
-                        std::shared_ptr<Button> right);
+        ButtonFromProgram(std::shared_ptr<ButtonProgram> program, ButtonProgram::Register reg);
 
         virtual void Update() override;
 
         virtual std::string ToString() const override
         {
-            std::string str = m_left->ToString();
-            if (m_operator == Operator::kAnd)
-                str += " && ";
-            else if (m_operator == Operator::kOr)
-                str += " || ";
-            else if (m_operator == Operator::kXor)
-                str += " != ";
-            str += m_right->ToString();
-            return str;
+            return m_program->ToString(m_register);
         }
 
-    private:
-        Operator m_operator = Operator::kAnd;
-        std::shared_ptr<Button> m_left;
-        std::shared_ptr<Button> m_right;
-    };
-
-    /// @brief Unary logic operation for a button. Only 'NOT' is supported.
-    class ButtonUnaryOp : public Button
-    {
-    public:
-        enum class Operator
-        {
-            kNot,
-        };
-
-        ButtonUnaryOp(Operator op, std::shared_ptr<Button> right);
-
-        virtual void Update() override;
+        inline const std::shared_ptr<ButtonProgram> &GetProgram() const { return m_program; }
+        inline ButtonProgram::Register GetRegister() const { return m_register; }
 
-        virtual std::string ToString() const override
-        {
-            std::string str = "";
-            if (m_operator == Operator::kNot)
-                str += "!";
-            str += m_right->ToString();
-            return str;
-        }
-
-    private:
-        Operator m_operator = Operator::kNot;
-        std::shared_ptr<Button> m_right;
+    protected:
+        std::shared_ptr<ButtonProgram> m_program;
+        ButtonProgram::Register m_register = 0;
     };
 }
\ No newline at end of file
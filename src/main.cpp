@@ -1,11 +1,27 @@
 
 #include <cstdio>
 #include <iostream>
+#include <string>
 #include "app.hpp"
 
-int main()
+int main(int argc, char **argv)
 {
 	App app;
+
+	// --replay <trace> [--fast]: replay a recorded trace instead of using SteamVR
+	std::string replayPath;
+	bool replayFast = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--replay" && i + 1 < argc)
+			replayPath = argv[++i];
+		else if (arg == "--fast")
+			replayFast = true;
+	}
+	if (!replayPath.empty())
+		app.SetReplay(replayPath, replayFast);
+
 	app.Initialize("Dandy VR Remap", 900, 800);
 	app.Run();
 	return 0;
@@ -0,0 +1,454 @@
+#include "mapping_thread.hpp"
+#include "outputs/send_input_sink.hpp"
+#include "outputs/uinput_sink.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ctime>
+#include <sstream>
+
+namespace
+{
+	// How often status is published for the UI thread
+	const auto kStatusInterval = std::chrono::milliseconds(16);
+
+	// Smoothing factor for the look latency moving average
+	const float kLatencySmoothing = 0.01f;
+}
+
+MappingThread::MappingThread(std::shared_ptr<InputBackend> backend, std::shared_ptr<ActionSet> actions)
+	: m_backend(backend), m_actions(actions), m_devices(backend.get())
+{
+}
+
+MappingThread::~MappingThread()
+{
+	Stop();
+}
+
+Error MappingThread::LoadBindConfig(const Path &path)
+{
+	mappings::BindConfigLoader bindConfigLoader(m_bindMapper, *m_actions);
+	Error error = bindConfigLoader.LoadConfig(path);
+	m_settings = bindConfigLoader.GetSettings();
+
+	m_gyroAimControllers = bindConfigLoader.GetGyroAimControllers();
+	m_devices.DiscoverAll();
+	RefreshDeviceSettings();
+
+	// Use the config's aim controller, or create a default one unless the
+	// config aims by gyro instead
+	m_aimController = bindConfigLoader.GetAimController();
+	if (!m_aimController && m_gyroAimControllers.empty())
+	{
+		m_aimController = std::make_shared<mappings::SphereAimController>(
+			m_rightController,
+			m_bindMapper.GetInputOfType<inputs::Button>("enable_look"),
+			m_bindMapper.GetOutputOfType<outputs::MouseMovement>("look_x"),
+			m_bindMapper.GetOutputOfType<outputs::MouseMovement>("look_y"));
+		m_aimController->SetName("Aim");
+		m_bindMapper.AddBind(m_aimController);
+	}
+	if (m_aimController)
+		m_aimController->SetInputDevice(m_rightController);
+	m_bindMapper.SetIncremental(m_settings.incrementalUpdate);
+
+	// The base sink discards output, still going through the injection
+	// thread so its latency is measured
+	std::shared_ptr<outputs::OutputSink> injectionSink;
+	if (!m_injectOutput)
+	{
+		injectionSink = std::make_shared<outputs::OutputSink>();
+	}
+	else
+	{
+#if defined(__linux__)
+		auto uinputSink = std::make_shared<outputs::UinputSink>();
+		if (uinputSink->Open())
+		{
+			injectionSink = uinputSink;
+			for (auto &output : m_bindMapper.GetOutputs())
+			{
+				auto key = std::dynamic_pointer_cast<outputs::KeyboardKey>(output.second);
+				if (key && outputs::UinputSink::ScanCodeToKeyCode(key->scanCode) < 0)
+				{
+					CMG_LOG_ERROR() << "Keyboard output '" << output.first << "' (scan code "
+									<< key->scanCode << ") has no uinput key, so won't be injected";
+				}
+			}
+		}
+		else
+		{
+			CMG_LOG_ERROR() << "Output injection is disabled";
+			injectionSink = std::make_shared<outputs::OutputSink>();
+		}
+#else
+		injectionSink = std::make_shared<outputs::SendInputSink>();
+#endif
+	}
+	m_injector = std::make_shared<outputs::InjectionThread>(injectionSink);
+	m_bindMapper.SetOutputSink(m_injector);
+
+	// Late latched aim samples the pose on the injection thread, so needs a
+	// backend which can be sampled outside the tick
+	if (m_aimController && m_aimController->m_lateLatch)
+	{
+		auto latch = std::make_shared<mappings::AimLateLatch>(m_backend, m_aimController->m_mode);
+		if (!m_backend->CanSampleLatestPose())
+			CMG_LOG_ERROR() << "Input backend can't sample poses late, so aim isn't late latched";
+		else if (!m_aimController->SetLateLatch(latch))
+			CMG_LOG_ERROR() << "Late latched aim needs mouse movement outputs without a stream_rate";
+		else
+		{
+			m_aimLatch = latch;
+			m_injector->SetLateLatch(latch);
+			RefreshDeviceSettings();
+		}
+	}
+
+	return error;
+}
+
+void MappingThread::Start()
+{
+	if (m_running)
+		return;
+	CMG_LOG_INFO() << "Starting mapping thread at " << m_settings.tickRate << " Hz";
+
+	// One keyframed segment per second of history
+	if (m_settings.flightRecorderSeconds > 0.0f)
+	{
+		m_recorder = std::make_unique<trace::FlightRecorder>(
+			m_actions->GetTable(),
+			static_cast<uint32_t>(m_settings.tickRate),
+			static_cast<size_t>(std::ceil(m_settings.flightRecorderSeconds)) + 1);
+	}
+	if (m_injector)
+		m_injector->Start();
+	m_running = true;
+	m_thread = std::thread(&MappingThread::Run, this);
+}
+
+void MappingThread::Stop()
+{
+	m_running = false;
+	if (m_thread.joinable())
+		m_thread.join();
+	if (m_injector)
+		m_injector->Stop();
+	if (m_traceWriter.joinable())
+		m_traceWriter.join();
+}
+
+bool MappingThread::PushCommand(MappingCommand command)
+{
+	return m_commands.Push(command);
+}
+
+void MappingThread::GetStatus(MappingStatus &status)
+{
+	std::lock_guard<std::mutex> lock(m_statusMutex);
+	status = m_status;
+}
+
+void MappingThread::Run()
+{
+	util::ScopedTimerResolution timerResolution;
+	util::SetCurrentThreadPriorityHigh();
+
+	const auto tickInterval = std::chrono::duration_cast<util::Clock::duration>(
+		std::chrono::duration<double>(1.0 / m_settings.tickRate));
+	auto nextTick = util::Clock::now();
+	auto lastStatus = nextTick;
+	uint32_t ticksSinceStatus = 0;
+
+	while (m_running)
+	{
+		ProcessCommands();
+		if (!m_running)
+			break;
+
+		Tick();
+		ticksSinceStatus++;
+
+		auto now = util::Clock::now();
+		if (now - lastStatus >= kStatusInterval)
+		{
+			float elapsed = std::chrono::duration<float>(now - lastStatus).count();
+			PublishStatus(ticksSinceStatus / elapsed, ticksSinceStatus);
+			ticksSinceStatus = 0;
+			lastStatus = now;
+		}
+
+		// Backends like trace replay pace their own ticks
+		if (m_backend->PacesTicks())
+			continue;
+
+		// If we fell behind, skip the missed ticks instead of bursting. A
+		// gesture timer due before the next tick pulls it forward, so the
+		// gesture fires at its deadline rather than on the tick boundary.
+		nextTick += tickInterval;
+		if (nextTick < now)
+			nextTick = now;
+		auto timerDeadline = m_bindMapper.GetNextTimerDeadline();
+		if (m_controlMappingEnabled && timerDeadline < nextTick)
+			nextTick = std::max(timerDeadline, now);
+		util::SleepUntil(nextTick);
+	}
+}
+
+void MappingThread::ProcessCommands()
+{
+	MappingCommand command;
+	while (m_commands.Pop(command))
+	{
+		switch (command)
+		{
+		case MappingCommand::kToggleMapping:
+			m_controlMappingEnabled = !m_controlMappingEnabled;
+			break;
+		case MappingCommand::kDumpTrace:
+			DumpTrace();
+			break;
+		case MappingCommand::kShutdown:
+			m_running = false;
+			break;
+		}
+	}
+}
+
+void MappingThread::Tick()
+{
+	if (!m_backend->BeginTick())
+	{
+		m_running = false;
+		return;
+	}
+
+	// Update VR actions
+	m_actions->Update();
+
+	// Handle device changes, then get poses for all trackers
+	PollEvents();
+	PosePredictor::PoseArray devicePoses;
+	util::Timestamp poseTime = m_backend->GetPoses(m_predictions, devicePoses);
+	m_devices.UpdatePoses(devicePoses, poseTime);
+	if (m_recorder)
+		m_recorder->Record(devicePoses, m_devices.GetActiveIndices(), poseTime);
+	m_poseFilter.Apply(m_devices, poseTime);
+
+	// Update control mapping
+	if (m_controlMappingEnabled)
+	{
+		if (m_aimController)
+			m_aimController->SetInputDevice(m_rightController);
+		m_bindMapper.Update();
+		m_skippedBinds += m_bindMapper.GetSkippedBindCount();
+		m_skippedOutputs += m_bindMapper.GetSkippedOutputCount();
+
+		// Measure how old the aim pose is by the time its mouse motion has
+		// been injected
+		bool lookEngaged = false;
+		if (GetLookDevice(lookEngaged) && lookEngaged)
+		{
+			float poseAge = std::chrono::duration<float>(util::Clock::now() - poseTime).count();
+			m_lookPoseAge += (poseAge - m_lookPoseAge) * kLatencySmoothing;
+		}
+	}
+}
+
+void MappingThread::PublishStatus(float measuredTickRate, uint32_t tickCount)
+{
+	MappingStatus status;
+	status.controlMappingEnabled = m_controlMappingEnabled;
+	status.targetTickRate = m_settings.tickRate;
+	status.measuredTickRate = measuredTickRate;
+	status.incrementalUpdate = m_bindMapper.IsIncremental();
+	status.bindCount = m_bindMapper.GetBindCount();
+	status.outputCount = m_bindMapper.GetOutputCount();
+	if (tickCount > 0)
+	{
+		status.skippedBindsPerTick = static_cast<float>(m_skippedBinds) / tickCount;
+		status.skippedOutputsPerTick = static_cast<float>(m_skippedOutputs) / tickCount;
+	}
+	m_skippedBinds = 0;
+	m_skippedOutputs = 0;
+	if (m_recorder)
+		status.flightRecorderBytes = m_recorder->GetSizeBytes();
+	if (m_injector)
+		status.injection = m_injector->GetStats();
+
+	// Look latency up to injection is the pose age at injection plus the
+	// delay the pose filter adds, less how far ahead the pose was predicted.
+	// It stops at injection: the game's and display's time to show the
+	// input isn't measured, and is what prediction should make up for. The
+	// tick's pose waits for the batch to be injected; a late latched pose
+	// is sampled just before, and isn't filtered.
+	bool lookEngaged = false;
+	VrDevice *lookDevice = GetLookDevice(lookEngaged);
+	if (lookDevice)
+	{
+		float prediction = m_predictions[lookDevice->index].GetPredictedSeconds();
+		float filter = m_poseFilter.GetLatency(lookDevice->index);
+		float tickPoseAge = m_lookPoseAge + status.injection.averageLatencyUs * 1e-6f;
+		float poseAge = tickPoseAge;
+		if (m_aimLatch)
+		{
+			poseAge = status.injection.averageLateLatchUs * 1e-6f;
+			filter = 0.0f;
+		}
+		status.lookLateLatched = m_aimLatch != nullptr;
+		status.lookTickPoseAgeMs = tickPoseAge * 1000.0f;
+		status.lookPoseAgeMs = poseAge * 1000.0f;
+		status.lookPredictionMs = prediction * 1000.0f;
+		status.lookFilterMs = filter * 1000.0f;
+		status.lookInjectionLatencyMs = (poseAge + filter - prediction) * 1000.0f;
+	}
+
+	for (auto index : m_devices.GetActiveIndices())
+	{
+		const VrDevice &device = m_devices.GetDevice(index);
+		DeviceStatus deviceStatus;
+		deviceStatus.index = device.index;
+		deviceStatus.type = m_devices.GetInfo(index).type;
+		deviceStatus.connected = device.connected;
+		deviceStatus.poseValid = device.poseValid;
+		deviceStatus.position = device.position;
+		deviceStatus.orientation = device.orientation;
+		status.devices.push_back(deviceStatus);
+	}
+
+	{
+		std::stringstream ss;
+		for (auto &it : m_bindMapper.GetInputs())
+			it.second->DebugString(ss) << "\n";
+		status.inputsText = ss.str();
+	}
+	{
+		std::stringstream ss;
+		for (auto &it : m_bindMapper.GetOutputs())
+			it.second->DebugString(ss) << "\n";
+		status.outputsText = ss.str();
+	}
+
+	if (m_aimController)
+	{
+		auto &aim = *m_aimController;
+		status.aim.hasInputDevice = aim.m_inputDevice != nullptr;
+		status.aim.radius = aim.m_radius;
+		status.aim.center = aim.m_center;
+		status.aim.direction = aim.m_direction;
+		status.aim.directionOffset = aim.m_directionOffset;
+		status.aim.rayHitPoint = aim.m_rayHitPoint;
+		if (aim.m_inputDevice)
+			status.aim.devicePosition = aim.m_inputDevice->position;
+	}
+	else if (lookDevice)
+	{
+		// Gyro aim has no sphere, so only show where the device points
+		status.aim.hasInputDevice = true;
+		status.aim.center = lookDevice->position;
+		status.aim.devicePosition = lookDevice->position;
+		status.aim.direction = lookDevice->orientation * -Vector3f::UNITZ;
+		status.aim.directionOffset = status.aim.direction;
+		status.aim.rayHitPoint = lookDevice->position + status.aim.direction;
+	}
+
+	// Never block the mapping thread on the UI; if the UI is mid-read, the
+	// next publish will catch up.
+	std::unique_lock<std::mutex> lock(m_statusMutex, std::try_to_lock);
+	if (lock.owns_lock())
+		m_status = std::move(status);
+}
+
+VrDevice *MappingThread::GetLookDevice(bool &engaged) const
+{
+	// The aim controller follows the right hand. Without one, gyro aim
+	// looks, so take the first that is engaged, or else the first with a
+	// device.
+	engaged = false;
+	if (m_aimController)
+	{
+		engaged = m_aimController->m_enabled;
+		return m_rightController;
+	}
+	VrDevice *device = nullptr;
+	for (auto &gyroAim : m_gyroAimControllers)
+	{
+		if (!gyroAim->GetInputDevice())
+			continue;
+		if (gyroAim->IsEnabled())
+		{
+			engaged = true;
+			return gyroAim->GetInputDevice();
+		}
+		if (!device)
+			device = gyroAim->GetInputDevice();
+	}
+	return device;
+}
+
+void MappingThread::PollEvents()
+{
+	bool devicesChanged = false;
+	vr::VREvent_t event;
+	while (m_backend->PollNextEvent(event))
+		devicesChanged = m_devices.HandleEvent(event) || devicesChanged;
+	if (devicesChanged)
+		RefreshDeviceSettings();
+}
+
+void MappingThread::RefreshDeviceSettings()
+{
+	m_predictions.fill(PosePrediction());
+	m_poseFilter.Clear();
+	for (auto index : m_devices.GetActiveIndices())
+	{
+		const std::string &settingsKey = m_devices.GetInfo(index).settingsKey;
+		m_predictions[index] = m_settings.GetPosePrediction(settingsKey);
+		m_poseFilter.SetFilter(index, m_settings.GetPoseFilter(settingsKey));
+	}
+	m_rightController = m_devices.GetController(vr::TrackedControllerRole_RightHand);
+	if (m_aimLatch)
+	{
+		if (m_rightController)
+			m_aimLatch->SetDevice(m_rightController->index, m_predictions[m_rightController->index]);
+		else
+			m_aimLatch->SetDevice(vr::k_unTrackedDeviceIndexInvalid, PosePrediction());
+	}
+	for (auto &gyroAim : m_gyroAimControllers)
+		gyroAim->SetInputDevice(m_devices.FindDevice(gyroAim->GetDeviceKey()));
+}
+
+void MappingThread::DumpTrace()
+{
+	if (!m_recorder)
+	{
+		CMG_LOG_ERROR() << "Flight recorder is disabled";
+		return;
+	}
+
+	auto capture = std::make_shared<trace::Capture>();
+	m_actions->GetSlotNames(capture->digitalNames, capture->analogNames);
+	for (auto index : m_devices.GetActiveIndices())
+	{
+		const DeviceInfo &info = m_devices.GetInfo(index);
+		trace::DeviceRecord &record = capture->devices[index];
+		record.active = 1;
+		record.deviceClass = static_cast<uint8_t>(info.deviceClass);
+		record.role = static_cast<uint8_t>(info.role);
+	}
+	m_recorder->TakeSegments(*capture);
+
+	char name[64];
+	std::time_t now = std::time(nullptr);
+	std::strftime(name, sizeof(name), "trace_%Y%m%d_%H%M%S.dvt", std::localtime(&now));
+	std::string path = m_traceDirectory + "/" + name;
+
+	// Write on another thread so the file I/O doesn't stall mapping
+	if (m_traceWriter.joinable())
+		m_traceWriter.join();
+	m_traceWriter = std::thread([capture, path]()
+								{ trace::WriteTraceFile(path, *capture); });
+}
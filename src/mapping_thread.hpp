@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <openvr.h>
+#include <cmgCore/cmg_core.h>
+#include <cmgMath/cmg_math.h>
+
+#include "vr/actions.hpp"
+#include "vr/device.hpp"
+#include "vr/device_registry.hpp"
+#include "vr/input_backend.hpp"
+#include "vr/pose_filter.hpp"
+#include "vr/pose_prediction.hpp"
+#include "mappings/bindings.hpp"
+#include "mappings/bind_config.hpp"
+#include "mappings/sphere_aim_controller.hpp"
+#include "mappings/gyro_aim_controller.hpp"
+#include "mappings/aim_late_latch.hpp"
+#include "outputs/injection_thread.hpp"
+#include "trace/flight_recorder.hpp"
+#include "util/spsc_queue.hpp"
+#include "util/timing.hpp"
+
+/// @brief Commands sent from the UI thread to the mapping thread
+enum class MappingCommand
+{
+	kToggleMapping,
+	kDumpTrace,
+	kShutdown,
+};
+
+/// @brief Copy of a device's state for display
+struct DeviceStatus
+{
+	uint32_t index = 0;
+	std::string type;
+	bool connected = false;
+	bool poseValid = false;
+	Vector3f position = Vector3f::ZERO;
+	Matrix3f orientation = Matrix3f::IDENTITY;
+};
+
+/// @brief Copy of the aim controller's debug state for display. Gyro aim
+/// only fills in the device and where it points.
+struct AimStatus
+{
+	bool hasInputDevice = false;
+	float radius = 0.0f;
+	Vector3f center = Vector3f::ZERO;
+	Vector3f direction = Vector3f::ZERO;
+	Vector3f directionOffset = Vector3f::ZERO;
+	Vector3f rayHitPoint = Vector3f::ZERO;
+	Vector3f devicePosition = Vector3f::ZERO;
+};
+
+/// @brief Snapshot of the mapping thread's state, published periodically for
+/// the UI thread to display
+struct MappingStatus
+{
+	bool controlMappingEnabled = true;
+	float targetTickRate = 0.0f;
+	float measuredTickRate = 0.0f;
+	bool lookLateLatched = false;
+	float lookPoseAgeMs = 0.0f;
+	float lookTickPoseAgeMs = 0.0f;
+	float lookPredictionMs = 0.0f;
+	float lookFilterMs = 0.0f;
+	float lookInjectionLatencyMs = 0.0f;
+	size_t flightRecorderBytes = 0;
+	bool incrementalUpdate = false;
+	size_t bindCount = 0;
+	size_t outputCount = 0;
+	float skippedBindsPerTick = 0.0f;
+	float skippedOutputsPerTick = 0.0f;
+	std::vector<DeviceStatus> devices;
+	std::string inputsText;
+	std::string outputsText;
+	AimStatus aim;
+	outputs::InjectionStats injection;
+};
+
+/// @brief Polls VR input, tracks device poses and runs the bind mapper on a
+/// dedicated thread at a fixed tick rate, independent of the render loop.
+/// Everything it owns is only touched from that thread once started; the UI
+/// thread talks to it through a command queue and reads published status.
+/// Each tick's input is kept by a flight recorder for dumping to a trace.
+class MappingThread
+{
+public:
+	MappingThread(std::shared_ptr<InputBackend> backend, std::shared_ptr<ActionSet> actions);
+	~MappingThread();
+
+	/// @brief Load bind mappings and create the aim controller. Must be
+	/// called before Start().
+	Error LoadBindConfig(const Path &path);
+
+	/// @brief Whether output is injected into the desktop, or discarded as
+	/// when replaying a trace. Must be called before LoadBindConfig().
+	inline void SetInjectOutput(bool inject) { m_injectOutput = inject; }
+
+	/// @brief Set the directory flight recorder dumps are written to
+	inline void SetTraceDirectory(const std::string &directory) { m_traceDirectory = directory; }
+
+	void Start();
+	void Stop();
+
+	/// @brief Send a command to the mapping thread. Only call this from a
+	/// single (UI) thread.
+	/// @return false if the command queue is full
+	bool PushCommand(MappingCommand command);
+
+	/// @brief Copy the most recently published status
+	void GetStatus(MappingStatus &status);
+
+	inline bool IsRunning() const { return m_running; }
+
+private:
+	void Run();
+	void Tick();
+	void ProcessCommands();
+	void PublishStatus(float measuredTickRate, uint32_t tickCount);
+
+	/// @brief Get the device whose pose drives look, if any
+	/// @param engaged set to whether look is moving with it
+	VrDevice *GetLookDevice(bool &engaged) const;
+	void PollEvents();
+	void RefreshDeviceSettings();
+	void DumpTrace();
+
+	// Owned by the mapping thread
+	std::shared_ptr<InputBackend> m_backend;
+	std::shared_ptr<ActionSet> m_actions;
+	DeviceRegistry m_devices;
+	VrDevice *m_rightController = nullptr;
+	PosePredictor::PredictionArray m_predictions;
+	PoseFilter m_poseFilter;
+	float m_lookPoseAge = 0.0f;
+
+	// Work skipped by incremental bind updates since the last status publish
+	size_t m_skippedBinds = 0;
+	size_t m_skippedOutputs = 0;
+	mappings::BindMapper m_bindMapper;
+	std::shared_ptr<mappings::SphereAimController> m_aimController;
+	std::shared_ptr<mappings::AimLateLatch> m_aimLatch;
+	std::vector<std::shared_ptr<mappings::GyroAimController>> m_gyroAimControllers;
+	mappings::BindSettings m_settings;
+	bool m_controlMappingEnabled = true;
+
+	// Injects each tick's output on its own thread, fed from this one
+	std::shared_ptr<outputs::InjectionThread> m_injector;
+	bool m_injectOutput = true;
+
+	// Trace recording
+	std::unique_ptr<trace::FlightRecorder> m_recorder;
+	std::string m_traceDirectory = ".";
+	std::thread m_traceWriter;
+
+	// Shared with the UI thread
+	std::thread m_thread;
+	std::atomic<bool> m_running{false};
+	util::SpscQueue<MappingCommand, 64> m_commands;
+	std::mutex m_statusMutex;
+	MappingStatus m_status;
+};
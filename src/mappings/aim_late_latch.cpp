@@ -0,0 +1,115 @@
+#include "mappings/aim_late_latch.hpp"
+
+namespace mappings
+{
+
+    AimLateLatch::AimLateLatch(std::shared_ptr<InputBackend> backend, AimMode mode)
+        : m_backend(backend),
+          m_mode(mode)
+    {
+    }
+
+    void AimLateLatch::SetDevice(vr::TrackedDeviceIndex_t index, const PosePrediction &prediction)
+    {
+        m_predictionMode.store(prediction.mode, std::memory_order_relaxed);
+        m_predictionSeconds.store(prediction.seconds, std::memory_order_relaxed);
+        m_deviceIndex.store(index, std::memory_order_release);
+    }
+
+    void AimLateLatch::SetOutputAxes(size_t azimuthAxis, size_t elevationAxis)
+    {
+        m_azimuthAxis = azimuthAxis;
+        m_elevationAxis = elevationAxis;
+    }
+
+    void AimLateLatch::Publish(bool enabled, float countsPerDegree)
+    {
+        if (enabled && !m_publishedEnabled)
+            m_engageCount.fetch_add(1, std::memory_order_relaxed);
+        m_publishedEnabled = enabled;
+        m_countsPerDegree.store(countsPerDegree, std::memory_order_relaxed);
+        m_enabled.store(enabled, std::memory_order_release);
+    }
+
+    void AimLateLatch::Latch(outputs::OutputSink &sink)
+    {
+        if (!m_enabled.load(std::memory_order_acquire))
+        {
+            m_anchored = false;
+            return;
+        }
+        uint32_t engageCount = m_engageCount.load(std::memory_order_relaxed);
+        if (engageCount != m_anchorEngageCount)
+            m_anchored = false;
+
+        vr::TrackedDeviceIndex_t index = m_deviceIndex.load(std::memory_order_acquire);
+        if (index == vr::k_unTrackedDeviceIndexInvalid)
+            return;
+        PosePrediction prediction;
+        prediction.mode = m_predictionMode.load(std::memory_order_relaxed);
+        prediction.seconds = m_predictionSeconds.load(std::memory_order_relaxed);
+        vr::TrackedDevicePose_t pose;
+        if (!m_backend->SampleLatestPose(index, prediction, pose))
+            return;
+
+        Matrix3f orientation;
+        const vr::HmdMatrix34_t &m = pose.mDeviceToAbsoluteTracking;
+        for (size_t col = 0; col < 3; col++)
+        {
+            for (size_t row = 0; row < 3; row++)
+                orientation.c[col][row] = m.m[row][col];
+        }
+        Vector3f direction = orientation * -Vector3f::UNITZ;
+
+        // The first latch after engaging only anchors, like the aim
+        // controller's engage tick
+        if (!m_anchored)
+        {
+            m_engageFrame = SphereAimController::GetEngageFrame(orientation);
+            m_aimAnglesPrev = Vector2f::ZERO;
+            m_azimuthPrev = Math::ATan2(direction.z, direction.x);
+            m_elevationPrev = Math::ASin(direction.y);
+            m_residual = Vector2f::ZERO;
+            m_anchorEngageCount = engageCount;
+            m_anchored = true;
+            return;
+        }
+
+        Vector2f step;
+        if (m_mode == AimMode::kQuaternion)
+        {
+            Vector2f aimAngles = SphereAimController::GetAimAngles(orientation, m_engageFrame);
+            step = aimAngles - m_aimAnglesPrev;
+            m_aimAnglesPrev = aimAngles;
+        }
+        else
+        {
+            float azimuth = Math::ATan2(direction.z, direction.x);
+            float elevation = Math::ASin(direction.y);
+            float azDelta = azimuth - m_azimuthPrev;
+            if (azDelta > Math::PI)
+                azDelta -= Math::TWO_PI;
+            if (azDelta < -Math::PI)
+                azDelta += Math::TWO_PI;
+            step = Vector2f(Math::ToDegrees(azDelta), -Math::ToDegrees(elevation - m_elevationPrev));
+            m_azimuthPrev = azimuth;
+            m_elevationPrev = elevation;
+        }
+
+        // Move by whole counts, carrying the rest to the next latch
+        Vector2f counts = step * m_countsPerDegree.load(std::memory_order_relaxed) + m_residual;
+        int azimuthCounts = static_cast<int>(counts.x);
+        int elevationCounts = static_cast<int>(counts.y);
+        m_residual = Vector2f(counts.x - azimuthCounts, counts.y - elevationCounts);
+
+        // On the axes the outputs move, which may be swapped or shared
+        int move[2] = {0, 0};
+        if (m_azimuthAxis < 2)
+            move[m_azimuthAxis] += azimuthCounts;
+        if (m_elevationAxis < 2)
+            move[m_elevationAxis] += elevationCounts;
+        if (move[0] != 0 || move[1] != 0)
+            sink.AddMouseMove(move[0], move[1]);
+    }
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "mappings/sphere_aim_controller.hpp"
+#include "outputs/late_latch.hpp"
+#include "vr/input_backend.hpp"
+#include "util/quaternion.hpp"
+
+namespace mappings
+{
+
+    /// @brief Computes aim motion on the injection thread from a pose
+    /// sampled just before injecting, rather than the pose fetched at the
+    /// start of the tick, so the pose is microseconds old when injected.
+    ///
+    /// The aim controller still runs each tick, deciding whether aim is
+    /// engaged and the gain, and publishes those here. Each latch samples
+    /// the device and moves by the change in aim since the previous latch, in
+    /// the controller's aim mode. The pose filter isn't applied to latched poses.
+    class AimLateLatch : public outputs::LateLatch
+    {
+    public:
+        AimLateLatch(std::shared_ptr<InputBackend> backend, AimMode mode);
+
+        /// @brief Set the device to sample and how to predict its pose.
+        /// Called from the mapping thread.
+        void SetDevice(vr::TrackedDeviceIndex_t index, const PosePrediction &prediction);
+
+        /// @brief Set the mouse axes azimuth and elevation move, as the aim
+        /// controller's outputs would. Must be called before the injection
+        /// thread starts.
+        void SetOutputAxes(size_t azimuthAxis, size_t elevationAxis);
+
+        /// @brief Publish the aim state for the next latch. Called from the
+        /// mapping thread each tick.
+        /// @param countsPerDegree output scale including any acceleration
+        void Publish(bool enabled, float countsPerDegree);
+
+        virtual void Latch(outputs::OutputSink &sink) override;
+
+    private:
+        std::shared_ptr<InputBackend> m_backend;
+        AimMode m_mode;
+        size_t m_azimuthAxis = 0;
+        size_t m_elevationAxis = 1;
+
+        // Published by the mapping thread. Engaging counts up, so the latch
+        // restarts from a fresh pose even if it missed the disengage.
+        std::atomic<vr::TrackedDeviceIndex_t> m_deviceIndex{vr::k_unTrackedDeviceIndexInvalid};
+        std::atomic<PredictionMode> m_predictionMode{PredictionMode::kNone};
+        std::atomic<float> m_predictionSeconds{0.0f};
+        std::atomic<bool> m_enabled{false};
+        std::atomic<uint32_t> m_engageCount{0};
+        std::atomic<float> m_countsPerDegree{0.0f};
+        bool m_publishedEnabled = false;
+
+        // Owned by the injection thread
+        bool m_anchored = false;
+        uint32_t m_anchorEngageCount = 0;
+        util::Quaternion m_engageFrame;
+        Vector2f m_aimAnglesPrev = Vector2f::ZERO;
+        float m_azimuthPrev = 0.0f;
+        float m_elevationPrev = 0.0f;
+        Vector2f m_residual = Vector2f::ZERO;
+    };
+
+}
@@ -0,0 +1,307 @@
+#include "mappings/axis_curve_kernel.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AXIS_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC allows any intrinsic in any function; GCC and Clang need the target
+// enabled per function so the rest of the build stays baseline x86-64
+#if defined(AXIS_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AXIS_KERNEL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define AXIS_KERNEL_TARGET_AVX2
+#endif
+
+namespace mappings
+{
+    namespace
+    {
+        // ln(m) = 2 atanh(t), t = (m - 1) / (m + 1), for m in [sqrt(1/2), sqrt(2))
+        const float kLog2E = 1.44269504088896341f;
+        const float kSqrt2 = 1.41421356237309505f;
+        const float kLogC3 = 1.0f / 3.0f;
+        const float kLogC5 = 1.0f / 5.0f;
+        const float kLogC7 = 1.0f / 7.0f;
+        const float kLogC9 = 1.0f / 9.0f;
+
+        // 2^f = sum (ln2 f)^k / k! for f in [-1/2, 1/2]
+        const float kExpC1 = 0.693147180559945309f;
+        const float kExpC2 = 0.240226506959100712f;
+        const float kExpC3 = 0.0555041086648215800f;
+        const float kExpC4 = 0.00961812910762847716f;
+        const float kExpC5 = 0.00133335581464284434f;
+        const float kExpC6 = 0.000154035303933816099f;
+
+        // Smallest normal float; anything below is treated as zero
+        const float kMinNormal = 1.17549435e-38f;
+
+        void ApplyAxisCurveScalar(float *values, const float *deadzone,
+                                  const float *exponent, const float *scale,
+                                  size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                float value = values[i];
+                float magnitude = std::fabs(value);
+                if (magnitude < deadzone[i])
+                {
+                    values[i] = 0.0f;
+                    continue;
+                }
+                float curved = exponent[i] == 1.0f ? magnitude : std::pow(magnitude, exponent[i]);
+                values[i] = std::signbit(value) ? -(curved * scale[i]) : curved * scale[i];
+            }
+        }
+
+#if defined(AXIS_KERNEL_X86)
+
+        inline __m128 Log2Sse(__m128 x)
+        {
+            const __m128i bits = _mm_castps_si128(x);
+            __m128i exponentBits = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+            __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(
+                _mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+            // Recenter the mantissa on 1 so the series converges quickly
+            __m128 high = _mm_cmpgt_ps(mantissa, _mm_set1_ps(kSqrt2));
+            mantissa = _mm_or_ps(_mm_and_ps(high, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f))),
+                                 _mm_andnot_ps(high, mantissa));
+            exponentBits = _mm_sub_epi32(exponentBits, _mm_castps_si128(high));
+
+            const __m128 one = _mm_set1_ps(1.0f);
+            __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+            __m128 t2 = _mm_mul_ps(t, t);
+            __m128 series = _mm_set1_ps(kLogC9);
+            series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(kLogC7));
+            series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(kLogC5));
+            series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(kLogC3));
+            series = _mm_add_ps(_mm_mul_ps(series, t2), one);
+            __m128 logMantissa = _mm_mul_ps(_mm_mul_ps(t, series), _mm_set1_ps(2.0f * kLog2E));
+            return _mm_add_ps(_mm_cvtepi32_ps(exponentBits), logMantissa);
+        }
+
+        inline __m128 Exp2Sse(__m128 x)
+        {
+            x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+            __m128i whole = _mm_cvtps_epi32(x);
+            __m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(whole));
+            __m128 p = _mm_set1_ps(kExpC6);
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC5));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC4));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC3));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC2));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExpC1));
+            p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+            __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(whole, _mm_set1_epi32(127)), 23));
+            return _mm_mul_ps(p, scale);
+        }
+
+        inline __m128 AxisCurveSse(__m128 value, __m128 deadzone, __m128 exponent, __m128 scale)
+        {
+            const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+            __m128 sign = _mm_and_ps(value, signMask);
+            __m128 magnitude = _mm_andnot_ps(signMask, value);
+
+            __m128 curved = Exp2Sse(_mm_mul_ps(exponent, Log2Sse(magnitude)));
+            __m128 linear = _mm_cmpeq_ps(exponent, _mm_set1_ps(1.0f));
+            curved = _mm_or_ps(_mm_and_ps(linear, magnitude), _mm_andnot_ps(linear, curved));
+            curved = _mm_andnot_ps(_mm_cmplt_ps(magnitude, _mm_set1_ps(kMinNormal)), curved);
+
+            __m128 result = _mm_xor_ps(_mm_mul_ps(curved, scale), sign);
+            return _mm_andnot_ps(_mm_cmplt_ps(magnitude, deadzone), result);
+        }
+
+        void ApplyAxisCurveSse2(float *values, const float *deadzone,
+                                const float *exponent, const float *scale,
+                                size_t count)
+        {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 result = AxisCurveSse(_mm_loadu_ps(values + i), _mm_loadu_ps(deadzone + i),
+                                             _mm_loadu_ps(exponent + i), _mm_loadu_ps(scale + i));
+                _mm_storeu_ps(values + i, result);
+            }
+
+            // Run the tail through the same math with padding lanes
+            if (i < count)
+            {
+                float tail[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                float tailDeadzone[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                float tailExponent[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+                float tailScale[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                size_t remaining = count - i;
+                std::memcpy(tail, values + i, remaining * sizeof(float));
+                std::memcpy(tailDeadzone, deadzone + i, remaining * sizeof(float));
+                std::memcpy(tailExponent, exponent + i, remaining * sizeof(float));
+                std::memcpy(tailScale, scale + i, remaining * sizeof(float));
+                _mm_storeu_ps(tail, AxisCurveSse(_mm_loadu_ps(tail), _mm_loadu_ps(tailDeadzone),
+                                                 _mm_loadu_ps(tailExponent), _mm_loadu_ps(tailScale)));
+                std::memcpy(values + i, tail, remaining * sizeof(float));
+            }
+        }
+
+        AXIS_KERNEL_TARGET_AVX2 inline __m256 Log2Avx2(__m256 x)
+        {
+            const __m256i bits = _mm256_castps_si256(x);
+            __m256i exponentBits = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+            __m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(
+                _mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+
+            __m256 high = _mm256_cmp_ps(mantissa, _mm256_set1_ps(kSqrt2), _CMP_GT_OQ);
+            mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5f)), high);
+            exponentBits = _mm256_sub_epi32(exponentBits, _mm256_castps_si256(high));
+
+            const __m256 one = _mm256_set1_ps(1.0f);
+            __m256 t = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+            __m256 t2 = _mm256_mul_ps(t, t);
+            __m256 series = _mm256_set1_ps(kLogC9);
+            series = _mm256_fmadd_ps(series, t2, _mm256_set1_ps(kLogC7));
+            series = _mm256_fmadd_ps(series, t2, _mm256_set1_ps(kLogC5));
+            series = _mm256_fmadd_ps(series, t2, _mm256_set1_ps(kLogC3));
+            series = _mm256_fmadd_ps(series, t2, one);
+            __m256 logMantissa = _mm256_mul_ps(_mm256_mul_ps(t, series), _mm256_set1_ps(2.0f * kLog2E));
+            return _mm256_add_ps(_mm256_cvtepi32_ps(exponentBits), logMantissa);
+        }
+
+        AXIS_KERNEL_TARGET_AVX2 inline __m256 Exp2Avx2(__m256 x)
+        {
+            x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-126.0f)), _mm256_set1_ps(127.0f));
+            __m256i whole = _mm256_cvtps_epi32(x);
+            __m256 f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(whole));
+            __m256 p = _mm256_set1_ps(kExpC6);
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExpC5));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExpC4));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExpC3));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExpC2));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExpC1));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.0f));
+            __m256 scale = _mm256_castsi256_ps(
+                _mm256_slli_epi32(_mm256_add_epi32(whole, _mm256_set1_epi32(127)), 23));
+            return _mm256_mul_ps(p, scale);
+        }
+
+        AXIS_KERNEL_TARGET_AVX2 inline __m256 AxisCurveAvx2(__m256 value, __m256 deadzone,
+                                                            __m256 exponent, __m256 scale)
+        {
+            const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+            __m256 sign = _mm256_and_ps(value, signMask);
+            __m256 magnitude = _mm256_andnot_ps(signMask, value);
+
+            __m256 curved = Exp2Avx2(_mm256_mul_ps(exponent, Log2Avx2(magnitude)));
+            __m256 linear = _mm256_cmp_ps(exponent, _mm256_set1_ps(1.0f), _CMP_EQ_OQ);
+            curved = _mm256_blendv_ps(curved, magnitude, linear);
+            curved = _mm256_andnot_ps(
+                _mm256_cmp_ps(magnitude, _mm256_set1_ps(kMinNormal), _CMP_LT_OQ), curved);
+
+            __m256 result = _mm256_xor_ps(_mm256_mul_ps(curved, scale), sign);
+            return _mm256_andnot_ps(_mm256_cmp_ps(magnitude, deadzone, _CMP_LT_OQ), result);
+        }
+
+        AXIS_KERNEL_TARGET_AVX2 void ApplyAxisCurveAvx2(float *values, const float *deadzone,
+                                                        const float *exponent, const float *scale,
+                                                        size_t count)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 result = AxisCurveAvx2(
+                    _mm256_loadu_ps(values + i), _mm256_loadu_ps(deadzone + i),
+                    _mm256_loadu_ps(exponent + i), _mm256_loadu_ps(scale + i));
+                _mm256_storeu_ps(values + i, result);
+            }
+
+            if (i < count)
+            {
+                float tail[8] = {};
+                float tailDeadzone[8] = {};
+                float tailExponent[8] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+                float tailScale[8] = {};
+                size_t remaining = count - i;
+                std::memcpy(tail, values + i, remaining * sizeof(float));
+                std::memcpy(tailDeadzone, deadzone + i, remaining * sizeof(float));
+                std::memcpy(tailExponent, exponent + i, remaining * sizeof(float));
+                std::memcpy(tailScale, scale + i, remaining * sizeof(float));
+                _mm256_storeu_ps(tail, AxisCurveAvx2(
+                                           _mm256_loadu_ps(tail), _mm256_loadu_ps(tailDeadzone),
+                                           _mm256_loadu_ps(tailExponent), _mm256_loadu_ps(tailScale)));
+                std::memcpy(values + i, tail, remaining * sizeof(float));
+            }
+        }
+
+        bool DetectAvx2()
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+            __cpuid(info, 1);
+            bool fma = (info[2] & (1 << 12)) != 0;
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool avx = (info[2] & (1 << 28)) != 0;
+            if (!fma || !osxsave || !avx)
+                return false;
+            // The OS must save YMM state across context switches
+            if ((_xgetbv(0) & 0x6) != 0x6)
+                return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        }
+
+#endif
+    }
+
+    AxisCurveKernel GetAxisCurveKernel(KernelIsa isa)
+    {
+        switch (isa)
+        {
+        case KernelIsa::kScalar:
+            return &ApplyAxisCurveScalar;
+#if defined(AXIS_KERNEL_X86)
+        case KernelIsa::kSse2:
+            return &ApplyAxisCurveSse2;
+        case KernelIsa::kAvx2:
+            return DetectAvx2() ? &ApplyAxisCurveAvx2 : nullptr;
+#endif
+        default:
+            return nullptr;
+        }
+    }
+
+    KernelIsa GetBestKernelIsa()
+    {
+#if defined(AXIS_KERNEL_X86)
+        static const KernelIsa best = DetectAvx2() ? KernelIsa::kAvx2 : KernelIsa::kSse2;
+        return best;
+#else
+        return KernelIsa::kScalar;
+#endif
+    }
+
+    const char *GetKernelIsaName(KernelIsa isa)
+    {
+        switch (isa)
+        {
+        case KernelIsa::kSse2:
+            return "SSE2";
+        case KernelIsa::kAvx2:
+            return "AVX2";
+        default:
+            return "scalar";
+        }
+    }
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+namespace mappings
+{
+
+    /// @brief Instruction sets the axis curve kernel is built for
+    enum class KernelIsa
+    {
+        kScalar,
+        kSse2,
+        kAvx2,
+    };
+
+    /// @brief Applies the analog bind response curve in place to a packed
+    /// batch of values:
+    ///     value = |value| < deadzone ? 0 : sign(value) * |value|^exponent * scale
+    /// where scale carries the invert sign. Vector versions approximate the
+    /// power with polynomial log2/exp2 and are exact for an exponent of 1.
+    /// Their relative error grows with |exponent * log2|value||: below 1e-6
+    /// for exponents up to 2 and |value| >= 1e-3, and up to 1.7e-6 at an
+    /// exponent of 3.
+    using AxisCurveKernel = void (*)(float *values, const float *deadzone,
+                                     const float *exponent, const float *scale,
+                                     size_t count);
+
+    /// @brief Get the kernel for an instruction set, or nullptr if the CPU
+    /// doesn't support it
+    AxisCurveKernel GetAxisCurveKernel(KernelIsa isa);
+
+    /// @brief Best instruction set supported by this CPU, detected once
+    KernelIsa GetBestKernelIsa();
+
+    const char *GetKernelIsaName(KernelIsa isa);
+
+}
@@ -1,7 +1,10 @@
 #include "mappings/bind_config.hpp"
 #include "mappings/sphere_aim_controller.hpp"
+#include "mappings/gyro_aim_controller.hpp"
 #include "mappings/logic_parser.hpp"
+#include "mappings/macro.hpp"
 #include "inputs/inputs.hpp"
+#include "inputs/gestures.hpp"
 #include "outputs/outputs.hpp"
 
 #include "rapidjson/prettywriter.h"
@@ -12,6 +15,34 @@ namespace mappings
 {
     namespace
     {
+        /// @brief Load a filter chain from a list of stages, each with a
+        /// "type" and that type's parameters
+        bool LoadFilterChain(rapidjson::Value &data, util::FilterChain &chain)
+        {
+            for (auto it = data.Begin(); it != data.End(); it++)
+            {
+                util::FilterStage stage;
+                std::string type = (*it)["type"].GetString();
+                if (!util::ParseFilterType(type, stage.type))
+                {
+                    CMG_LOG_ERROR() << "Unsupported filter type: \"" << type << "\"";
+                    return false;
+                }
+                if (it->HasMember("min_cutoff_hz"))
+                    stage.minCutoff = (*it)["min_cutoff_hz"].GetFloat();
+                if (it->HasMember("beta"))
+                    stage.beta = (*it)["beta"].GetFloat();
+                if (it->HasMember("derivative_cutoff_hz"))
+                    stage.derivativeCutoff = (*it)["derivative_cutoff_hz"].GetFloat();
+                if (it->HasMember("cutoff_hz"))
+                    stage.cutoff = (*it)["cutoff_hz"].GetFloat();
+                if (it->HasMember("max_rate"))
+                    stage.maxRate = (*it)["max_rate"].GetFloat();
+                chain.push_back(stage);
+            }
+            return true;
+        }
+
         class LoadFunctions
         {
         public:
@@ -24,6 +55,12 @@ namespace mappings
             {
             }
 
+            // Modulation timing from the config's settings block
+            ModulationTiming m_modulation;
+
+            // Curves from the config's "curves" block, by name
+            std::map<std::string, std::shared_ptr<const ResponseCurve>> m_curves;
+
             template <class T>
             std::shared_ptr<T> LoadMappingType(rapidjson::Value &data);
 
@@ -114,7 +151,10 @@ namespace mappings
                     axis = 1;
                 else if (axisStr == "z")
                     axis = 2;
-                return std::make_shared<outputs::MouseMovement>(axis);
+                auto output = std::make_shared<outputs::MouseMovement>(axis);
+                if (data.HasMember("stream_rate"))
+                    output->SetStreamRate(data["stream_rate"].GetFloat(), m_mapper.GetTimers());
+                return output;
             }
 
             template <>
@@ -169,19 +209,84 @@ namespace mappings
                     if (input)
                         return input;
 
-                    auto action = m_actions.GetActionOfType<ButtonAction>(value);
-                    if (action)
-                        return std::make_shared<inputs::ButtonFromAction>(action);
-
+                    // Plain action paths compile to a bare action register
                     input = LogicParser::ParseButtonLogic(value, m_mapper, m_actions);
                     if (input)
                         CMG_LOG_INFO() << "LOGIC: " << input->ToString();
                     return input;
                 }
+                else if (data.IsObject() && data.HasMember("gesture"))
+                {
+                    return LoadGesture(data);
+                }
+                else
+                {
+                    return nullptr;
+                }
+            }
+
+            /// @brief Load a gesture over one "input" or a list of "inputs",
+            /// each of which is button logic
+            std::shared_ptr<inputs::Button> LoadGesture(rapidjson::Value &data)
+            {
+                std::vector<std::string> sourceNames;
+                if (data.HasMember("inputs"))
+                {
+                    rapidjson::Value &sourceList = data["inputs"];
+                    for (auto it = sourceList.Begin(); it != sourceList.End(); it++)
+                        sourceNames.push_back(it->GetString());
+                }
+                else
+                {
+                    sourceNames.push_back(data["input"].GetString());
+                }
+
+                std::vector<inputs::ButtonProgram::Register> sources;
+                for (const std::string &name : sourceNames)
+                {
+                    auto source = std::dynamic_pointer_cast<inputs::ButtonFromProgram>(
+                        LogicParser::ParseButtonLogic(name, m_mapper, m_actions));
+                    if (source == nullptr)
+                    {
+                        CMG_LOG_ERROR() << "Gesture input '" << name << "' is not button logic";
+                        return nullptr;
+                    }
+                    sources.push_back(source->GetRegister());
+                }
+
+                std::string gesture = cmg::string::ToLower(std::string(data["gesture"].GetString()));
+                auto program = m_mapper.GetButtonProgram();
+                auto timers = m_mapper.GetTimers();
+                auto duration = util::SecondsToDuration(data["ms"].GetFloat() * 0.001f);
+                if (gesture != "chord" && sources.size() != 1)
+                {
+                    CMG_LOG_ERROR() << "Gesture '" << gesture << "' takes a single input";
+                    return nullptr;
+                }
+
+                std::shared_ptr<inputs::Button> input;
+                if (gesture == "hold")
+                    input = std::make_shared<inputs::HoldButton>(program, sources, timers, duration);
+                else if (gesture == "tap")
+                {
+                    util::Clock::duration window = util::Clock::duration::zero();
+                    if (data.HasMember("double_tap_window_ms"))
+                        window = util::SecondsToDuration(data["double_tap_window_ms"].GetFloat() * 0.001f);
+                    input = std::make_shared<inputs::TapButton>(program, sources, timers, duration, window);
+                }
+                else if (gesture == "double_tap")
+                    input = std::make_shared<inputs::DoubleTapButton>(program, sources, timers, duration);
+                else if (gesture == "chord")
+                    input = std::make_shared<inputs::ChordButton>(program, sources, timers, duration);
+                else if (gesture == "release_after_hold")
+                    input = std::make_shared<inputs::ReleaseAfterHoldButton>(program, sources, timers, duration);
                 else
                 {
+                    CMG_LOG_ERROR() << "Unsupported gesture '" << gesture << "'";
                     return nullptr;
                 }
+                CMG_LOG_INFO() << "GESTURE: " << input->ToString();
+                return input;
             }
 
             template <>
@@ -212,8 +317,76 @@ namespace mappings
 
                 std::string path = data["path"].GetString();
                 auto action = m_actions.GetActionOfType<JoystickAction>(path);
-                if (action)
-                    return std::make_shared<inputs::JoystickAxis>(action, axis);
+                if (!action)
+                    return nullptr;
+                auto input = std::make_shared<inputs::JoystickAxis>(action, axis);
+                if (data.HasMember("filter"))
+                {
+                    util::FilterChain chain;
+                    if (!LoadFilterChain(data["filter"], chain))
+                        return nullptr;
+                    auto filters = m_mapper.GetFilters();
+                    input->SetFilter(filters, filters->AddChannel(chain));
+                }
+                return input;
+            }
+
+            /// @brief Load a curve by name, or bake one from a preset or a
+            /// list of [x, y] control points
+            std::shared_ptr<const ResponseCurve> LoadCurve(rapidjson::Value &data)
+            {
+                if (data.IsString())
+                {
+                    std::string name = data.GetString();
+                    auto it = m_curves.find(name);
+                    if (it != m_curves.end())
+                        return it->second;
+                    CMG_LOG_ERROR() << "Unknown response curve '" << name << "'";
+                    return nullptr;
+                }
+
+                if (data.HasMember("points"))
+                {
+                    rapidjson::Value &pointListData = data["points"];
+                    std::vector<Vector2f> points;
+                    for (auto it = pointListData.Begin(); it != pointListData.End(); it++)
+                    {
+                        Vector2f point((*it)[0u].GetFloat(), (*it)[1u].GetFloat());
+                        if (point.x < 0.0f || (!points.empty() && point.x <= points.back().x))
+                        {
+                            CMG_LOG_ERROR() << "Response curve points must have increasing, non-negative x";
+                            return nullptr;
+                        }
+                        points.push_back(point);
+                    }
+                    if (points.size() < 2)
+                    {
+                        CMG_LOG_ERROR() << "Response curve needs at least 2 points";
+                        return nullptr;
+                    }
+                    return std::make_shared<ResponseCurve>(ResponseCurve::FromPoints(points));
+                }
+
+                std::string preset = cmg::string::ToLower(std::string(data["preset"].GetString()));
+                auto getFloat = [&data](const char *name, float defaultValue)
+                {
+                    return data.HasMember(name) ? data[name].GetFloat() : defaultValue;
+                };
+                if (preset == "linear")
+                    return std::make_shared<ResponseCurve>(ResponseCurve::Linear());
+                else if (preset == "expo")
+                    return std::make_shared<ResponseCurve>(
+                        ResponseCurve::Expo(getFloat("amount", 0.5f)));
+                else if (preset == "s_curve")
+                    return std::make_shared<ResponseCurve>(
+                        ResponseCurve::SCurve(getFloat("strength", 0.5f)));
+                else if (preset == "acceleration")
+                {
+                    return std::make_shared<ResponseCurve>(ResponseCurve::Acceleration(
+                        getFloat("min_speed", 0.0f), getFloat("max_speed", 360.0f),
+                        getFloat("min_gain", 1.0f), getFloat("max_gain", 2.0f)));
+                }
+                CMG_LOG_ERROR() << "Unsupported response curve preset '" << preset << "'";
                 return nullptr;
             }
 
@@ -251,6 +424,12 @@ namespace mappings
                     bind->scale = data["scale"].GetFloat();
                 if (data.HasMember("inverted"))
                     bind->inverted = data["inverted"].GetBool();
+                if (data.HasMember("curve"))
+                {
+                    bind->curve = LoadCurve(data["curve"]);
+                    if (bind->curve == nullptr)
+                        return nullptr;
+                }
                 return bind;
             }
 
@@ -280,8 +459,218 @@ namespace mappings
             template <>
             std::shared_ptr<SphereAimController> LoadMappingType(rapidjson::Value &data)
             {
-                CMG_LOG_ERROR() << "Not Implemented: LoadMappingType<SphereAimController>";
-                return nullptr;
+                // The tracked device is assigned by the mapping thread
+                auto enableButton = LoadInput<inputs::Button>(data["input_enable"]);
+                if (enableButton == nullptr)
+                    return nullptr;
+                auto outputX = LoadOutput<outputs::Analog>(data["output_az"]);
+                auto outputY = LoadOutput<outputs::Analog>(data["output_el"]);
+                if (outputX == nullptr || outputY == nullptr)
+                    return nullptr;
+
+                auto bind = std::make_shared<SphereAimController>(
+                    nullptr, enableButton, outputX, outputY);
+                if (data.HasMember("mode"))
+                {
+                    std::string mode = data["mode"].GetString();
+                    if (mode == "sphere")
+                        bind->m_mode = AimMode::kSphere;
+                    else if (mode == "quaternion")
+                        bind->m_mode = AimMode::kQuaternion;
+                    else
+                    {
+                        CMG_LOG_ERROR() << "Unknown aim mode: \"" << mode << "\"";
+                        return nullptr;
+                    }
+                }
+                if (data.HasMember("late_latch"))
+                    bind->m_lateLatch = data["late_latch"].GetBool();
+                if (data.HasMember("sphere_radius"))
+                    bind->m_radius = data["sphere_radius"].GetFloat();
+                if (data.HasMember("output_scale"))
+                    bind->m_outputScale = data["output_scale"].GetFloat();
+                if (data.HasMember("acceleration"))
+                {
+                    bind->m_accelerationCurve = LoadCurve(data["acceleration"]);
+                    if (bind->m_accelerationCurve == nullptr)
+                        return nullptr;
+                }
+                return bind;
+            }
+
+            template <>
+            std::shared_ptr<GyroAimController> LoadMappingType(rapidjson::Value &data)
+            {
+                // Without an enable button, aim is always on
+                std::shared_ptr<inputs::Button> enableButton;
+                if (data.HasMember("input_enable"))
+                {
+                    enableButton = LoadInput<inputs::Button>(data["input_enable"]);
+                    if (enableButton == nullptr)
+                        return nullptr;
+                }
+                auto outputX = LoadOutput<outputs::Analog>(data["output_az"]);
+                auto outputY = LoadOutput<outputs::Analog>(data["output_el"]);
+                if (outputX == nullptr || outputY == nullptr)
+                    return nullptr;
+
+                // The tracked device is assigned by the mapping thread
+                auto bind = std::make_shared<GyroAimController>(enableButton, outputX, outputY);
+                if (data.HasMember("tracker_device"))
+                {
+                    std::string device = data["tracker_device"].GetString();
+                    if (device != "hmd" && device != "left" && device != "right")
+                    {
+                        CMG_LOG_ERROR() << "Unsupported tracker device '" << device << "'";
+                        return nullptr;
+                    }
+                    bind->SetDeviceKey(device);
+                }
+                if (data.HasMember("output_scale"))
+                    bind->m_outputScale = data["output_scale"].GetFloat();
+                if (data.HasMember("deadzone"))
+                    bind->m_deadzone = data["deadzone"].GetFloat();
+                if (data.HasMember("acceleration"))
+                {
+                    bind->m_accelerationCurve = LoadCurve(data["acceleration"]);
+                    if (bind->m_accelerationCurve == nullptr)
+                        return nullptr;
+                }
+                return bind;
+            }
+
+            ModulationTiming LoadModulationTiming(rapidjson::Value &data)
+            {
+                ModulationTiming timing = m_modulation;
+                if (data.HasMember("min_on_ms"))
+                    timing.minOn = util::SecondsToDuration(data["min_on_ms"].GetFloat() * 0.001f);
+                if (data.HasMember("min_off_ms"))
+                    timing.minOff = util::SecondsToDuration(data["min_off_ms"].GetFloat() * 0.001f);
+                return timing;
+            }
+
+            template <>
+            std::shared_ptr<TurboButton> LoadMappingType(rapidjson::Value &data)
+            {
+                auto input = LoadInput<inputs::Button>(data["input"]);
+                if (input == nullptr)
+                    return nullptr;
+
+                auto output = LoadOutput<outputs::Button>(data["output"]);
+                if (output == nullptr)
+                    return nullptr;
+
+                float rate = data.HasMember("rate") ? data["rate"].GetFloat() : 10.0f;
+                float duty = data.HasMember("duty") ? data["duty"].GetFloat() : 0.5f;
+                if (rate <= 0.0f)
+                {
+                    CMG_LOG_ERROR() << "Turbo rate must be positive";
+                    return nullptr;
+                }
+                return std::make_shared<TurboButton>(input, output, m_mapper.GetTimers(),
+                                                     rate, duty, LoadModulationTiming(data));
+            }
+
+            template <>
+            std::shared_ptr<AxisToPwm> LoadMappingType(rapidjson::Value &data)
+            {
+                auto input = LoadInput<inputs::Analog>(data["input"]);
+                if (input == nullptr)
+                    return nullptr;
+
+                std::shared_ptr<outputs::Button> outputPositive;
+                std::shared_ptr<outputs::Button> outputNegative;
+                if (data.HasMember("output_positive"))
+                {
+                    outputPositive = LoadOutput<outputs::Button>(data["output_positive"]);
+                    if (outputPositive == nullptr)
+                        return nullptr;
+                }
+                if (data.HasMember("output_negative"))
+                {
+                    outputNegative = LoadOutput<outputs::Button>(data["output_negative"]);
+                    if (outputNegative == nullptr)
+                        return nullptr;
+                }
+
+                float periodMs = data.HasMember("period_ms") ? data["period_ms"].GetFloat() : 100.0f;
+                auto bind = std::make_shared<AxisToPwm>(
+                    input, outputPositive, outputNegative, m_mapper.GetTimers(),
+                    util::SecondsToDuration(periodMs * 0.001f), LoadModulationTiming(data));
+                if (data.HasMember("deadzone"))
+                    bind->deadzone = data["deadzone"].GetFloat();
+                if (data.HasMember("saturation"))
+                    bind->saturation = data["saturation"].GetFloat();
+                return bind;
+            }
+
+            bool LoadMacroStep(rapidjson::Value &data, MacroStep &step)
+            {
+                if (data.HasMember("press"))
+                {
+                    step.type = MacroStep::Type::kPress;
+                    step.button = LoadOutput<outputs::Button>(data["press"]);
+                    return step.button != nullptr;
+                }
+                if (data.HasMember("release"))
+                {
+                    step.type = MacroStep::Type::kRelease;
+                    step.button = LoadOutput<outputs::Button>(data["release"]);
+                    return step.button != nullptr;
+                }
+                if (data.HasMember("move"))
+                {
+                    step.type = MacroStep::Type::kMove;
+                    step.analog = LoadOutput<outputs::Analog>(data["move"]);
+                    if (data.HasMember("amount"))
+                        step.amount = data["amount"].GetFloat();
+                    return step.analog != nullptr;
+                }
+                if (data.HasMember("wait_ms"))
+                {
+                    step.type = MacroStep::Type::kWait;
+                    step.duration = util::SecondsToDuration(data["wait_ms"].GetFloat() * 0.001f);
+                    return true;
+                }
+                if (data.HasMember("wait_ticks"))
+                {
+                    step.type = MacroStep::Type::kWaitTicks;
+                    step.ticks = data["wait_ticks"].GetUint();
+                    return true;
+                }
+                if (data.HasMember("wait_input"))
+                {
+                    step.type = MacroStep::Type::kWaitInput;
+                    step.input = LoadInput<inputs::Button>(data["wait_input"]);
+                    if (data.HasMember("state"))
+                        step.inputDown = cmg::string::ToLower(std::string(data["state"].GetString())) != "up";
+                    return step.input != nullptr;
+                }
+                CMG_LOG_ERROR() << "Unsupported macro step";
+                return false;
+            }
+
+            template <>
+            std::shared_ptr<MacroBind> LoadMappingType(rapidjson::Value &data)
+            {
+                auto input = LoadInput<inputs::Button>(data["input"]);
+                if (input == nullptr)
+                    return nullptr;
+
+                std::vector<MacroStep> steps;
+                rapidjson::Value &stepListData = data["steps"];
+                for (auto it = stepListData.Begin(); it != stepListData.End(); it++)
+                {
+                    MacroStep step;
+                    if (!LoadMacroStep(*it, step))
+                        return nullptr;
+                    steps.push_back(step);
+                }
+
+                auto bind = std::make_shared<MacroBind>(input, std::move(steps), m_mapper.GetTimers());
+                if (data.HasMember("cancel_on_release"))
+                    bind->cancelOnRelease = data["cancel_on_release"].GetBool();
+                return bind;
             }
 
             std::shared_ptr<BindBase> LoadMapping(
@@ -300,6 +689,14 @@ namespace mappings
                     bind = LoadMappingType<AxisToAxis>(data);
                 else if (type == "SphereAimController")
                     bind = LoadMappingType<SphereAimController>(data);
+                else if (type == "GyroAimController")
+                    bind = LoadMappingType<GyroAimController>(data);
+                else if (type == "Macro")
+                    bind = LoadMappingType<MacroBind>(data);
+                else if (type == "Turbo")
+                    bind = LoadMappingType<TurboButton>(data);
+                else if (type == "AxisToPwm")
+                    bind = LoadMappingType<AxisToPwm>(data);
                 else
                 {
                     CMG_LOG_ERROR() << "Unsupported mapping type: \"" << type << "\"";
@@ -313,6 +710,26 @@ namespace mappings
         };
     }
 
+    PosePrediction BindSettings::GetPosePrediction(const std::string &device) const
+    {
+        auto it = posePrediction.find(device);
+        if (it == posePrediction.end())
+            it = posePrediction.find("default");
+        if (it == posePrediction.end())
+            return PosePrediction();
+        return it->second;
+    }
+
+    util::FilterChain BindSettings::GetPoseFilter(const std::string &device) const
+    {
+        auto it = poseFilter.find(device);
+        if (it == poseFilter.end())
+            it = poseFilter.find("default");
+        if (it == poseFilter.end())
+            return util::FilterChain();
+        return it->second;
+    }
+
     BindConfigLoader::BindConfigLoader(BindMapper &mapper, ActionSet &actions)
         : m_mapper(mapper), m_actions(actions)
     {
@@ -334,6 +751,60 @@ namespace mappings
 
         LoadFunctions loadFuncs(m_actions, m_mapper);
 
+        if (document.HasMember("settings"))
+        {
+            rapidjson::Value &settingsData = document["settings"];
+            if (settingsData.HasMember("tick_rate"))
+            {
+                m_settings.tickRate = Math::Clamp(settingsData["tick_rate"].GetFloat(),
+                                                  BindSettings::kMinTickRate,
+                                                  BindSettings::kMaxTickRate);
+            }
+            if (settingsData.HasMember("flight_recorder_seconds"))
+                m_settings.flightRecorderSeconds = Math::Max(settingsData["flight_recorder_seconds"].GetFloat(), 0.0f);
+            if (settingsData.HasMember("incremental_update"))
+                m_settings.incrementalUpdate = settingsData["incremental_update"].GetBool();
+            if (settingsData.HasMember("modulation"))
+            {
+                rapidjson::Value &modulationData = settingsData["modulation"];
+                if (modulationData.HasMember("min_on_ms"))
+                    m_settings.modulation.minOn = util::SecondsToDuration(modulationData["min_on_ms"].GetFloat() * 0.001f);
+                if (modulationData.HasMember("min_off_ms"))
+                    m_settings.modulation.minOff = util::SecondsToDuration(modulationData["min_off_ms"].GetFloat() * 0.001f);
+            }
+            if (settingsData.HasMember("pose_prediction"))
+            {
+                rapidjson::Value &predictionList = settingsData["pose_prediction"];
+                for (auto it = predictionList.MemberBegin(); it != predictionList.MemberEnd(); it++)
+                {
+                    std::string device = it->name.GetString();
+                    PosePrediction prediction;
+                    prediction.mode = PredictionMode::kRuntime;
+                    if (it->value.HasMember("mode") &&
+                        !ParsePredictionMode(it->value["mode"].GetString(), prediction.mode))
+                    {
+                        CMG_LOG_ERROR() << "Unsupported pose prediction mode: \""
+                                        << it->value["mode"].GetString() << "\"";
+                    }
+                    if (it->value.HasMember("predict_ms"))
+                        prediction.seconds = it->value["predict_ms"].GetFloat() * 0.001f;
+                    m_settings.posePrediction[device] = prediction;
+                }
+            }
+            if (settingsData.HasMember("pose_filter"))
+            {
+                rapidjson::Value &filterList = settingsData["pose_filter"];
+                for (auto it = filterList.MemberBegin(); it != filterList.MemberEnd(); it++)
+                {
+                    util::FilterChain chain;
+                    if (LoadFilterChain(it->value, chain))
+                        m_settings.poseFilter[it->name.GetString()] = chain;
+                }
+            }
+        }
+
+        loadFuncs.m_modulation = m_settings.modulation;
+
         CMG_LOG_DEBUG() << "Loading button inputs";
         rapidjson::Value &inputListButtons = document["inputs"]["buttons"];
         std::map<std::string, std::shared_ptr<inputs::Button>> buttonInputs;
@@ -410,17 +881,53 @@ namespace mappings
             }
         }
 
+        if (document.HasMember("curves"))
+        {
+            CMG_LOG_DEBUG() << "Loading response curves";
+            rapidjson::Value &curveList = document["curves"];
+            for (auto it = curveList.MemberBegin(); it != curveList.MemberEnd(); it++)
+            {
+                std::string name = it->name.GetString();
+                auto curve = loadFuncs.LoadCurve(it->value);
+                if (curve)
+                {
+                    CMG_LOG_DEBUG() << "  " << name;
+                    loadFuncs.m_curves[name] = curve;
+                }
+            }
+        }
+
         // Process all mappings
         CMG_LOG_DEBUG() << "Loading mappings";
 
         rapidjson::Value &mappingData = document["mappings"];
         for (auto it = mappingData.Begin(); it != mappingData.End(); it++)
         {
+            // Mappings with "enabled": false are kept in the config but not loaded
+            if (it->HasMember("enabled") && !(*it)["enabled"].GetBool())
+            {
+                CMG_LOG_DEBUG() << "Skipping disabled mapping \"" << (*it)["name"].GetString() << "\"";
+                continue;
+            }
+
             std::shared_ptr<BindBase> mapping = loadFuncs.LoadMapping(*it);
             if (mapping)
+            {
                 m_mapper.AddBind(mapping);
+                if (!m_aimController)
+                    m_aimController = std::dynamic_pointer_cast<SphereAimController>(mapping);
+                if (auto gyroAim = std::dynamic_pointer_cast<GyroAimController>(mapping))
+                    m_gyroAimControllers.push_back(gyroAim);
+            }
         }
 
+        auto &program = *m_mapper.GetButtonProgram();
+        CMG_LOG_INFO() << "Button logic: " << program.GetInstructionCount()
+                       << " nodes for " << program.GetRequestedCount()
+                       << " operations ("
+                       << (program.GetRequestedCount() - program.GetInstructionCount())
+                       << " shared)";
+
         return CMG_ERROR_SUCCESS;
     }
 }
@@ -3,10 +3,53 @@
 #include "vr/actions.hpp"
 #include "outputs/outputs.hpp"
 #include "mappings/bindings.hpp"
+#include "mappings/modulation.hpp"
+#include "mappings/sphere_aim_controller.hpp"
+#include "mappings/gyro_aim_controller.hpp"
+#include "vr/pose_prediction.hpp"
+#include "util/filter_bank.hpp"
+#include <map>
 #include <vector>
 
 namespace mappings
 {
+    /// @brief Global settings from the optional "settings" block of a bind
+    /// config
+    struct BindSettings
+    {
+        static constexpr float kMinTickRate = 250.0f;
+        static constexpr float kMaxTickRate = 2000.0f;
+
+        /// @brief Rate in Hz at which inputs are polled and binds are updated
+        float tickRate = 1000.0f;
+
+        /// @brief Seconds of input history kept by the flight recorder, or 0
+        /// to disable it
+        float flightRecorderSeconds = 30.0f;
+
+        /// @brief Only run binds whose inputs changed this tick
+        bool incrementalUpdate = false;
+
+        /// @brief Default minimum on and off times of turbo and PWM
+        /// outputs, for the game's input sampling rate
+        ModulationTiming modulation;
+
+        /// @brief Pose prediction per device, keyed by "hmd", "left",
+        /// "right" or "default"
+        std::map<std::string, PosePrediction> posePrediction;
+
+        /// @brief Get the pose prediction for a device key, falling back to
+        /// "default" and then to no prediction
+        PosePrediction GetPosePrediction(const std::string &device) const;
+
+        /// @brief Pose filter chain per device, keyed as above
+        std::map<std::string, util::FilterChain> poseFilter;
+
+        /// @brief Get the pose filter chain for a device key, falling back
+        /// to "default" and then to no filtering
+        util::FilterChain GetPoseFilter(const std::string &device) const;
+    };
+
     class BindConfigLoader
     {
     public:
@@ -14,9 +57,20 @@ namespace mappings
 
         Error LoadConfig(const Path &path);
 
+        inline const BindSettings &GetSettings() const { return m_settings; }
+
+        /// @brief First SphereAimController in the config's mappings, if any
+        inline std::shared_ptr<SphereAimController> GetAimController() const { return m_aimController; }
+
+        /// @brief Every GyroAimController in the config's mappings
+        inline const std::vector<std::shared_ptr<GyroAimController>> &GetGyroAimControllers() const { return m_gyroAimControllers; }
+
     private:
         BindMapper &m_mapper;
         ActionSet &m_actions;
+        BindSettings m_settings;
         std::vector<std::shared_ptr<BindBase>> m_binds;
+        std::shared_ptr<SphereAimController> m_aimController;
+        std::vector<std::shared_ptr<GyroAimController>> m_gyroAimControllers;
     };
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "mappings/bind_tables.hpp"
+
+#include <cmgMath/cmg_math.h>
+
+namespace mappings
+{
+
+    void ButtonToButtonTable::Clear()
+    {
+        m_inputs.clear();
+        m_outputs.clear();
+        m_inverted.clear();
+    }
+
+    void ButtonToButtonTable::Add(inputs::Button *input, outputs::Button *output, bool inverted)
+    {
+        m_inputs.push_back(input);
+        m_outputs.push_back(output);
+        m_inverted.push_back(inverted ? 1 : 0);
+    }
+
+    void ButtonToButtonTable::Update(RowRange rows) const
+    {
+        for (uint32_t row = rows.begin; row < rows.end; row++)
+        {
+            const inputs::Button *input = m_inputs[row];
+            m_outputs[row]->SetState(input->IsDown() != (m_inverted[row] != 0), input->GetTimestamp());
+        }
+    }
+
+    AxisToAxisTable::AxisToAxisTable()
+        : m_kernel(GetAxisCurveKernel(GetBestKernelIsa()))
+    {
+    }
+
+    void AxisToAxisTable::Clear()
+    {
+        m_inputs.clear();
+        m_outputIndex.clear();
+        m_deadzone.clear();
+        m_exponent.clear();
+        m_scale.clear();
+        m_values.clear();
+        m_curves.clear();
+        m_curveDeadzone.clear();
+        m_outputsBefore.clear();
+        m_outputs.clear();
+        m_outputLookup.clear();
+        m_accumulators.clear();
+        m_outputTimes.clear();
+    }
+
+    void AxisToAxisTable::Add(inputs::Analog *input, outputs::Analog *output,
+                              float scale, float sensitivity, float deadzone, bool inverted,
+                              const ResponseCurve *curve)
+    {
+        m_outputsBefore.push_back(static_cast<uint32_t>(m_outputs.size()));
+        auto it = m_outputLookup.find(output);
+        uint32_t outputIndex;
+        if (it != m_outputLookup.end())
+        {
+            outputIndex = it->second;
+        }
+        else
+        {
+            outputIndex = static_cast<uint32_t>(m_outputs.size());
+            m_outputLookup[output] = outputIndex;
+            m_outputs.push_back(output);
+            m_accumulators.push_back(0.0f);
+            m_outputTimes.push_back(util::Timestamp());
+        }
+
+        m_inputs.push_back(input);
+        m_outputIndex.push_back(outputIndex);
+        m_deadzone.push_back(curve ? 0.0f : deadzone);
+        m_exponent.push_back(curve ? 1.0f : sensitivity);
+        m_scale.push_back(Math::Abs(scale) * (inverted ? -1.0f : 1.0f));
+        m_values.push_back(0.0f);
+        m_curves.push_back(curve);
+        m_curveDeadzone.push_back(deadzone);
+    }
+
+    void AxisToAxisTable::Update(RowRange rows)
+    {
+        if (rows.GetSize() == 0)
+            return;
+
+        for (uint32_t row = rows.begin; row < rows.end; row++)
+        {
+            float value = m_inputs[row]->GetValue();
+            if (const ResponseCurve *curve = m_curves[row])
+                value = Math::Abs(value) < m_curveDeadzone[row] ? 0.0f : curve->Evaluate(value);
+            m_values[row] = value;
+        }
+
+        m_kernel(m_values.data() + rows.begin, m_deadzone.data() + rows.begin,
+                 m_exponent.data() + rows.begin, m_scale.data() + rows.begin,
+                 rows.GetSize());
+
+        for (uint32_t row = rows.begin; row < rows.end; row++)
+        {
+            uint32_t output = m_outputIndex[row];
+            m_accumulators[output] += m_values[row];
+            util::Timestamp timestamp = m_inputs[row]->GetTimestamp();
+            if (timestamp > m_outputTimes[output])
+                m_outputTimes[output] = timestamp;
+        }
+
+        uint32_t outputEnd = rows.end < GetSize() ? m_outputsBefore[rows.end]
+                                                  : static_cast<uint32_t>(m_outputs.size());
+        for (uint32_t output = m_outputsBefore[rows.begin]; output < outputEnd; output++)
+        {
+            m_outputs[output]->SetValue(m_accumulators[output], m_outputTimes[output]);
+            m_accumulators[output] = 0.0f;
+            m_outputTimes[output] = util::Timestamp();
+        }
+    }
+
+    void AxisRangeToButtonTable::Clear()
+    {
+        m_inputs.clear();
+        m_minValue.clear();
+        m_maxValue.clear();
+        m_inverted.clear();
+        m_outputs.clear();
+        m_active.clear();
+    }
+
+    void AxisRangeToButtonTable::Add(inputs::Analog *input, float minValue, float maxValue,
+                                     bool inverted, outputs::Button *output)
+    {
+        m_inputs.push_back(input);
+        m_minValue.push_back(minValue);
+        m_maxValue.push_back(maxValue);
+        m_inverted.push_back(inverted ? 1 : 0);
+        m_outputs.push_back(output);
+        m_active.push_back(0);
+    }
+
+    void AxisRangeToButtonTable::Update(RowRange rows)
+    {
+        for (uint32_t row = rows.begin; row < rows.end; row++)
+        {
+            const inputs::Analog *input = m_inputs[row];
+            float value = input->GetValue();
+            bool active = value >= m_minValue[row] && value < m_maxValue[row];
+            active = active != (m_inverted[row] != 0);
+            m_active[row] = active ? 1 : 0;
+            m_outputs[row]->SetState(active, input->GetTimestamp());
+        }
+    }
+
+}
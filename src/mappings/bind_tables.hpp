@@ -0,0 +1,105 @@
+#pragma once
+
+#include "outputs/outputs.hpp"
+#include "inputs/inputs.hpp"
+#include "mappings/axis_curve_kernel.hpp"
+#include "mappings/response_curve.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace mappings
+{
+
+    /// @brief Contiguous range of rows in a bind table
+    struct RowRange
+    {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+
+        inline uint32_t GetSize() const { return end - begin; }
+    };
+
+    /// @brief ButtonToButton binds stored as parallel arrays, evaluated by a
+    /// single loop without virtual calls
+    class ButtonToButtonTable
+    {
+    public:
+        void Clear();
+        void Add(inputs::Button *input, outputs::Button *output, bool inverted);
+        void Update(RowRange rows) const;
+
+        inline uint32_t GetSize() const { return static_cast<uint32_t>(m_inputs.size()); }
+
+    private:
+        std::vector<inputs::Button *> m_inputs;
+        std::vector<outputs::Button *> m_outputs;
+        std::vector<uint8_t> m_inverted;
+    };
+
+    /// @brief AxisToAxis binds stored as parallel arrays. Input values are
+    /// gathered into a packed buffer, run through the response curve by a
+    /// vectorized kernel, then summed into packed per-output accumulators
+    /// which are written to each output once. Rows with a lookup table curve
+    /// apply it and their deadzone while gathering, and pass through the
+    /// kernel with an exponent of 1.
+    class AxisToAxisTable
+    {
+    public:
+        AxisToAxisTable();
+
+        void Clear();
+        void Add(inputs::Analog *input, outputs::Analog *output,
+                 float scale, float sensitivity, float deadzone, bool inverted,
+                 const ResponseCurve *curve = nullptr);
+        void Update(RowRange rows);
+
+        inline uint32_t GetSize() const { return static_cast<uint32_t>(m_inputs.size()); }
+
+    private:
+        AxisCurveKernel m_kernel = nullptr;
+
+        // Per row
+        std::vector<inputs::Analog *> m_inputs;
+        std::vector<uint32_t> m_outputIndex;
+        std::vector<float> m_deadzone;
+        std::vector<float> m_exponent;
+        std::vector<float> m_scale;
+        std::vector<float> m_values;
+        std::vector<const ResponseCurve *> m_curves;
+        std::vector<float> m_curveDeadzone;
+
+        // Outputs are numbered in order of first use. Rows are added
+        // component by component and components don't share outputs, so the
+        // outputs a component's row range writes are the indices first used
+        // within it.
+        std::vector<uint32_t> m_outputsBefore;
+
+        // Per output
+        std::vector<outputs::Analog *> m_outputs;
+        std::unordered_map<outputs::Analog *, uint32_t> m_outputLookup;
+        std::vector<float> m_accumulators;
+        std::vector<util::Timestamp> m_outputTimes;
+    };
+
+    /// @brief AxisRangeToButton binds flattened to one row per range
+    class AxisRangeToButtonTable
+    {
+    public:
+        void Clear();
+        void Add(inputs::Analog *input, float minValue, float maxValue,
+                 bool inverted, outputs::Button *output);
+        void Update(RowRange rows);
+
+        inline uint32_t GetSize() const { return static_cast<uint32_t>(m_inputs.size()); }
+
+    private:
+        std::vector<inputs::Analog *> m_inputs;
+        std::vector<float> m_minValue;
+        std::vector<float> m_maxValue;
+        std::vector<uint8_t> m_inverted;
+        std::vector<outputs::Button *> m_outputs;
+        std::vector<uint8_t> m_active;
+    };
+
+}
@@ -1,62 +1,380 @@
 #include "mappings/bindings.hpp"
 
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace mappings
 {
 
     BindMapper::BindMapper()
+        : m_buttonProgram(std::make_shared<inputs::ButtonProgram>()),
+          m_timers(std::make_shared<util::TimerWheel>()),
+          m_filters(std::make_shared<util::FilterBank>()),
+          m_outputSink(std::make_shared<outputs::OutputSink>())
     {
     }
 
     void BindMapper::AddInput(std::shared_ptr<inputs::InputBase> input)
     {
         m_inputs[input->GetName()] = input;
+        m_compiled = false;
     }
 
     void BindMapper::AddOutput(std::shared_ptr<outputs::OutputBase> output)
     {
         m_outputs[output->GetName()] = output;
+        m_compiled = false;
     }
 
     void BindMapper::AddBind(std::shared_ptr<BindBase> bind)
     {
         CMG_LOG_DEBUG() << "Adding bind: " << bind->GetName();
         m_binds.push_back(bind);
+        m_compiled = false;
     }
 
     void BindMapper::Update()
     {
+        if (!m_compiled)
+            Compile();
+        if (m_incremental)
+            UpdateIncremental();
+        else
+            UpdateAll();
+    }
+
+    void BindMapper::UpdateInputs()
+    {
+        // Fire due gesture timers, then evaluate button logic, which
+        // evaluates gestures in order with it, then update inputs
+        util::Timestamp now = util::Clock::now();
+        m_timers->Advance(now);
+        m_buttonProgram->Update();
+        for (auto input : m_inputList)
+            input->Update();
+
+        // Filter analog inputs in one pass over the bank
+        if (!m_filteredInputs.empty())
+        {
+            for (auto input : m_filteredInputs)
+                input->SubmitToFilter();
+            m_filters->Update(now);
+            for (auto input : m_filteredInputs)
+                input->ApplyFilter();
+        }
+    }
+
+    void BindMapper::UpdateComponents(size_t first, size_t last)
+    {
+        // Consecutive components have adjacent rows, so each table runs once
+        // over the whole span
+        const Component &front = m_components[first];
+        const Component &back = m_components[last - 1];
+        m_buttonToButton.Update({front.buttonToButton.begin, back.buttonToButton.end});
+        m_axisToAxis.Update({front.axisToAxis.begin, back.axisToAxis.end});
+        m_axisRangeToButton.Update({front.axisRangeToButton.begin, back.axisRangeToButton.end});
+        for (size_t index = first; index < last; index++)
+        {
+            for (auto bind : m_components[index].binds)
+                bind->Update();
+        }
+    }
+
+    void BindMapper::UpdateAll()
+    {
+        m_skippedBinds = 0;
+        m_skippedOutputs = 0;
+
         // Pre-Update outputs
-        for (auto &it : m_outputs)
+        for (auto output : m_outputList)
+            output->PreUpdate();
+
+        UpdateInputs();
+
+        // Update bind mappings
+        if (!m_components.empty())
+            UpdateComponents(0, m_components.size());
+
+        m_pendingOutputs.clear();
+        for (auto output : m_outputList)
+        {
+            if (output->HasPendingEvent())
+                m_pendingOutputs.push_back(output);
+        }
+        InjectPendingOutputs();
+    }
+
+    void BindMapper::UpdateIncremental()
+    {
+        // Update inputs, marking the components downstream of any that
+        // changed
+        for (size_t index = 0; index < m_components.size(); index++)
+        {
+            const Component &component = m_components[index];
+            m_componentDirty[index] = component.continuous || component.settling;
+        }
+        UpdateInputs();
+        for (const InputLink &link : m_inputLinks)
+        {
+            if (link.input->HasChanged())
+            {
+                for (uint32_t index : link.components)
+                    m_componentDirty[index] = 2;
+            }
+        }
+
+        // Run dirty components, batching runs of consecutive ones. A
+        // component stays dirty for one tick after an input change so its
+        // button outputs latch their state.
+        m_pendingOutputs.clear();
+        m_skippedBinds = 0;
+        m_skippedOutputs = 0;
+        size_t runBegin = 0;
+        for (size_t index = 0; index < m_components.size(); index++)
+        {
+            Component &component = m_components[index];
+            component.settling = m_componentDirty[index] == 2;
+            if (!m_componentDirty[index])
+            {
+                if (runBegin < index)
+                    UpdateComponents(runBegin, index);
+                runBegin = index + 1;
+                m_skippedBinds += component.bindCount;
+                m_skippedOutputs += component.outputs.size() - component.heldOutputs.size();
+                continue;
+            }
+
+            for (auto output : component.outputs)
+                output->PreUpdate();
+        }
+        if (runBegin < m_components.size())
+            UpdateComponents(runBegin, m_components.size());
+
+        // Clean components can only have events from held analog outputs
+        for (size_t index = 0; index < m_components.size(); index++)
+        {
+            const Component &component = m_components[index];
+            const auto &outputs = m_componentDirty[index] ? component.outputs : component.heldOutputs;
+            for (auto output : outputs)
+            {
+                if (output->HasPendingEvent())
+                    m_pendingOutputs.push_back(output);
+            }
+        }
+
+        // Outputs no bind claims to write are handled as in a full update
+        for (auto output : m_looseOutputs)
+            output->PreUpdate();
+        for (auto output : m_looseOutputs)
+        {
+            if (output->HasPendingEvent())
+                m_pendingOutputs.push_back(output);
+        }
+        InjectPendingOutputs();
+    }
+
+    void BindMapper::InjectPendingOutputs()
+    {
+        // Batch output events in the order their inputs changed on the
+        // hardware, rather than in output name order, and inject the whole
+        // tick at once
+        std::stable_sort(m_pendingOutputs.begin(), m_pendingOutputs.end(),
+                         [](const outputs::OutputBase *a, const outputs::OutputBase *b)
+                         { return a->GetTimestamp() < b->GetTimestamp(); });
+        for (auto output : m_pendingOutputs)
+            output->Update(*m_outputSink);
+        m_outputSink->Flush();
+    }
+
+    void BindMapper::Compile()
+    {
+        std::vector<std::vector<inputs::InputBase *>> bindInputs(m_binds.size());
+        std::vector<std::vector<outputs::OutputBase *>> bindOutputs(m_binds.size());
+        for (size_t index = 0; index < m_binds.size(); index++)
+        {
+            if (m_binds[index])
+                m_binds[index]->GetConnections(bindInputs[index], bindOutputs[index]);
+        }
+
+        // Union binds which write the same output
+        std::vector<uint32_t> parent(m_binds.size());
+        std::iota(parent.begin(), parent.end(), 0);
+        auto find = [&](uint32_t index)
+        {
+            while (parent[index] != index)
+                index = parent[index] = parent[parent[index]];
+            return index;
+        };
+        std::unordered_map<outputs::OutputBase *, uint32_t> outputOwners;
+        for (uint32_t index = 0; index < m_binds.size(); index++)
+        {
+            for (auto output : bindOutputs[index])
+            {
+                if (!output)
+                    continue;
+                auto it = outputOwners.find(output);
+                if (it == outputOwners.end())
+                    outputOwners[output] = index;
+                else
+                    parent[find(index)] = find(it->second);
+            }
+        }
+
+        // Number components in order of their first bind
+        std::vector<uint32_t> componentIndex(m_binds.size(), UINT32_MAX);
+        std::vector<std::vector<uint32_t>> componentBinds;
+        for (uint32_t index = 0; index < m_binds.size(); index++)
+        {
+            if (!m_binds[index])
+                continue;
+            uint32_t root = find(index);
+            if (componentIndex[root] == UINT32_MAX)
+            {
+                componentIndex[root] = static_cast<uint32_t>(componentBinds.size());
+                componentBinds.emplace_back();
+            }
+            componentIndex[index] = componentIndex[root];
+            componentBinds[componentIndex[root]].push_back(index);
+        }
+
+        // Lay out each kind's table component by component, so a component
+        // owns one contiguous row range per table
+        m_components.clear();
+        m_components.resize(componentBinds.size());
+        m_buttonToButton.Clear();
+        m_axisToAxis.Clear();
+        m_axisRangeToButton.Clear();
+        for (size_t index = 0; index < m_components.size(); index++)
+        {
+            Component &component = m_components[index];
+            component.buttonToButton.begin = m_buttonToButton.GetSize();
+            component.axisToAxis.begin = m_axisToAxis.GetSize();
+            component.axisRangeToButton.begin = m_axisRangeToButton.GetSize();
+            for (uint32_t bindIndex : componentBinds[index])
+            {
+                BindBase *bind = m_binds[bindIndex].get();
+                component.bindCount++;
+                component.continuous = component.continuous || bind->IsContinuous();
+
+                if (auto buttonBind = dynamic_cast<ButtonToButton *>(bind))
+                {
+                    m_buttonToButton.Add(buttonBind->input.get(), buttonBind->output.get(),
+                                         buttonBind->inverted);
+                }
+                else if (auto axisBind = dynamic_cast<AxisToAxis *>(bind))
+                {
+                    m_axisToAxis.Add(axisBind->input.get(), axisBind->output.get(),
+                                     axisBind->scale, axisBind->sensitivity,
+                                     axisBind->deadzone, axisBind->inverted,
+                                     axisBind->curve.get());
+                }
+                else if (auto rangeBind = dynamic_cast<AxisRangeToButton *>(bind))
+                {
+                    for (auto &range : rangeBind->outputs)
+                    {
+                        m_axisRangeToButton.Add(rangeBind->input.get(), range.minValue,
+                                                range.maxValue, range.inverted,
+                                                range.output.get());
+                    }
+                }
+                else
+                {
+                    component.binds.push_back(bind);
+                }
+            }
+            component.buttonToButton.end = m_buttonToButton.GetSize();
+            component.axisToAxis.end = m_axisToAxis.GetSize();
+            component.axisRangeToButton.end = m_axisRangeToButton.GetSize();
+        }
+
+        for (uint32_t index = 0; index < m_binds.size(); index++)
         {
-            if (it.second)
-                it.second->PreUpdate();
+            for (auto output : bindOutputs[index])
+            {
+                if (!output || outputOwners[output] != index)
+                    continue;
+                Component &component = m_components[componentIndex[index]];
+                component.outputs.push_back(output);
+                if (dynamic_cast<outputs::Analog *>(output))
+                    component.heldOutputs.push_back(output);
+            }
         }
+        m_componentDirty.assign(m_components.size(), 1);
 
-        // Update inputs
+        // Link inputs to the components reading them. Inputs created inline
+        // by a bind aren't named, but still need updating.
+        m_inputList.clear();
+        std::unordered_set<inputs::InputBase *> listedInputs;
         for (auto &it : m_inputs)
         {
-            if (it.second)
-                it.second->Update();
+            if (it.second && listedInputs.insert(it.second.get()).second)
+                m_inputList.push_back(it.second.get());
+        }
+        std::unordered_map<inputs::InputBase *, size_t> inputLinks;
+        m_inputLinks.clear();
+        for (uint32_t index = 0; index < m_binds.size(); index++)
+        {
+            if (!m_binds[index])
+                continue;
+            uint32_t component = componentIndex[index];
+            for (auto input : bindInputs[index])
+            {
+                if (!input)
+                    continue;
+                auto it = inputLinks.find(input);
+                if (it == inputLinks.end())
+                {
+                    it = inputLinks.emplace(input, m_inputLinks.size()).first;
+                    m_inputLinks.emplace_back();
+                    m_inputLinks.back().input = input;
+                    if (listedInputs.insert(input).second)
+                        m_inputList.push_back(input);
+                }
+                auto &components = m_inputLinks[it->second].components;
+                if (std::find(components.begin(), components.end(), component) == components.end())
+                    components.push_back(component);
+            }
         }
 
-        // Update bind mappings
-        for (auto &bind : m_binds)
+        m_filteredInputs.clear();
+        for (auto input : m_inputList)
         {
-            if (bind)
-                bind->Update();
+            auto analog = dynamic_cast<inputs::Analog *>(input);
+            if (analog && analog->IsFiltered())
+                m_filteredInputs.push_back(analog);
         }
 
-        // Update outputs
+        m_outputList.clear();
+        m_looseOutputs.clear();
         for (auto &it : m_outputs)
         {
-            if (it.second)
-                it.second->Update();
+            if (!it.second)
+                continue;
+            m_outputList.push_back(it.second.get());
+            if (outputOwners.find(it.second.get()) == outputOwners.end())
+                m_looseOutputs.push_back(it.second.get());
         }
+
+        m_compiled = true;
+        CMG_LOG_DEBUG() << "Bind mapper: " << m_binds.size() << " binds in "
+                        << m_components.size() << " components ("
+                        << m_buttonToButton.GetSize() << " button, "
+                        << m_axisToAxis.GetSize() << " axis, "
+                        << m_axisRangeToButton.GetSize() << " axis range rows)";
+    }
+
+    void ButtonToButton::GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                        std::vector<outputs::OutputBase *> &outputs) const
+    {
+        inputs.push_back(input.get());
+        outputs.push_back(output.get());
     }
 
     void ButtonToButton::Update()
     {
-        output->SetState(input->IsDown() != inverted);
+        output->SetState(input->IsDown() != inverted, input->GetTimestamp());
     }
 
     void AxisRangeToButton::AddRange(float minValue, float maxValue,
@@ -70,6 +388,14 @@ namespace mappings
         outputs.push_back(range);
     }
 
+    void AxisRangeToButton::GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                           std::vector<outputs::OutputBase *> &outputs) const
+    {
+        inputs.push_back(input.get());
+        for (auto &range : this->outputs)
+            outputs.push_back(range.output.get());
+    }
+
     void AxisRangeToButton::Update()
     {
         float value = input->GetValue();
@@ -79,24 +405,34 @@ namespace mappings
             range.active = value >= range.minValue && value < range.maxValue;
             if (range.inverted)
                 range.active = !range.active;
-            range.output->SetState(range.active);
+            range.output->SetState(range.active, input->GetTimestamp());
         }
     }
 
+    void AxisToAxis::GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const
+    {
+        inputs.push_back(input.get());
+        outputs.push_back(output.get());
+    }
+
     void AxisToAxis::Update()
     {
         float value = input->GetValue();
-        if (Math::Abs(value) < deadzone)
+        float magnitude = Math::Abs(value);
+        if (magnitude < deadzone)
         {
-            output->SetValue(0.0f);
+            output->SetValue(0.0f, input->GetTimestamp());
         }
         else
         {
-            value = Math::Abs(Math::Pow(value, sensitivity) * scale);
-            value *= Math::Sign(input->GetValue());
+            if (curve)
+                value = curve->Evaluate(value) * Math::Abs(scale);
+            else
+                value = Math::Abs(Math::Pow(magnitude, sensitivity) * scale) * Math::Sign(value);
             if (inverted)
                 value = -value;
-            output->SetValue(value);
+            output->SetValue(value, input->GetTimestamp());
         }
     }
 
@@ -3,10 +3,14 @@
 #include "vr/actions.hpp"
 #include "outputs/outputs.hpp"
 #include "inputs/inputs.hpp"
+#include "mappings/bind_tables.hpp"
+#include "mappings/response_curve.hpp"
+#include "util/timer_wheel.hpp"
 #include <vector>
 
 namespace mappings
 {
+    class BindMapper;
 
     /// @brief Base class for all input-to-output mappings
     class BindBase
@@ -16,6 +20,16 @@ namespace mappings
         /// state
         virtual void Update() {}
 
+        /// @brief List the inputs the bind reads and the outputs it writes,
+        /// for incremental updates
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const {}
+
+        /// @brief Whether the bind depends on state other than its inputs
+        /// (such as device poses) and so must run every tick. Binds which
+        /// don't describe their connections must keep this true.
+        virtual bool IsContinuous() const { return true; }
+
         void SetName(const std::string &name) { m_name = name; }
         inline const std::string &GetName() const { return m_name; }
 
@@ -32,8 +46,13 @@ namespace mappings
             std::shared_ptr<outputs::Button> output) : input(input), output(output) {}
 
         virtual void Update() override;
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const override;
+        virtual bool IsContinuous() const override { return false; }
 
     private:
+        friend class BindMapper;
+
         std::shared_ptr<inputs::Button> input;
         std::shared_ptr<outputs::Button> output;
         bool inverted = false;
@@ -50,8 +69,13 @@ namespace mappings
                       std::shared_ptr<outputs::Button> output);
 
         virtual void Update() override;
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const override;
+        virtual bool IsContinuous() const override { return false; }
 
     private:
+        friend class BindMapper;
+
         struct OutputRange
         {
             float minValue = 0.0f;
@@ -75,6 +99,9 @@ namespace mappings
             std::shared_ptr<outputs::Analog> output) : input(input), output(output) {}
 
         virtual void Update() override;
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const override;
+        virtual bool IsContinuous() const override { return false; }
 
         std::shared_ptr<inputs::Analog> input;
         std::shared_ptr<outputs::Analog> output;
@@ -82,9 +109,26 @@ namespace mappings
         float sensitivity = 1.0f;
         float deadzone = 0.0f;
         bool inverted = false;
+
+        /// @brief Shapes the value outside the deadzone in place of
+        /// sensitivity when set
+        std::shared_ptr<const ResponseCurve> curve;
     };
 
-    /// @brief Manager class which can process multiple bind mappings
+    /// @brief Manager class which can process multiple bind mappings.
+    ///
+    /// Before the first update after binds are added, the built-in bind
+    /// kinds are compiled into per-kind tables (see bind_tables.hpp) and run
+    /// by one loop per kind; other binds fall back to a virtual Update().
+    /// Bind parameters are copied at that point, so changing a bind after it
+    /// has been compiled has no effect.
+    ///
+    /// In incremental mode, binds are grouped into components that share
+    /// outputs, and a component only runs on ticks where one of its inputs
+    /// changed (plus one tick after, so button outputs settle without an
+    /// edge). Clean components keep last tick's output state, so held analog
+    /// outputs such as mouse movement are re-emitted without re-running their
+    /// binds. Components containing a continuous bind run every tick.
     class BindMapper
     {
     public:
@@ -126,13 +170,104 @@ namespace mappings
         /// @param bind the bind mapping to add
         void AddBind(std::shared_ptr<BindBase> bind);
 
+        /// @brief Program that all button logic inputs are compiled into
+        inline const std::shared_ptr<inputs::ButtonProgram> &GetButtonProgram() const { return m_buttonProgram; }
+
+        /// @brief Timers for gesture inputs, advanced each update before
+        /// button logic is evaluated
+        inline const std::shared_ptr<util::TimerWheel> &GetTimers() const { return m_timers; }
+
+        /// @brief Filters for analog inputs, run over every filtered input
+        /// at once after inputs update
+        inline const std::shared_ptr<util::FilterBank> &GetFilters() const { return m_filters; }
+
+        /// @brief Time the next gesture timer could fire, for waking up to
+        /// update at its deadline rather than on the next tick
+        inline util::Timestamp GetNextTimerDeadline() const { return m_timers->GetNextDeadline(); }
+
+        /// @brief Sink which output events are batched into, flushed once
+        /// at the end of each update. Events are discarded until one is set.
+        void SetOutputSink(std::shared_ptr<outputs::OutputSink> sink) { m_outputSink = sink; }
+        inline const std::shared_ptr<outputs::OutputSink> &GetOutputSink() const { return m_outputSink; }
+
+        /// @brief Only run binds downstream of changed inputs
+        void SetIncremental(bool incremental) { m_incremental = incremental; }
+        inline bool IsIncremental() const { return m_incremental; }
+
         /// @brief Updates all bind mappings
         void Update();
 
+        inline size_t GetBindCount() const { return m_binds.size(); }
+        inline size_t GetOutputCount() const { return m_outputs.size(); }
+
+        /// @brief Work skipped by incremental evaluation in the last Update()
+        inline size_t GetSkippedBindCount() const { return m_skippedBinds; }
+        inline size_t GetSkippedOutputCount() const { return m_skippedOutputs; }
+
     private:
+        /// @brief Binds connected through shared outputs, with the outputs
+        /// they write. Each component's rows are contiguous in every table.
+        struct Component
+        {
+            RowRange buttonToButton;
+            RowRange axisToAxis;
+            RowRange axisRangeToButton;
+
+            // Binds with no table, updated through BindBase::Update()
+            std::vector<BindBase *> binds;
+            size_t bindCount = 0;
+
+            std::vector<outputs::OutputBase *> outputs;
+
+            // Analog outputs, which can have pending events while clean
+            std::vector<outputs::OutputBase *> heldOutputs;
+
+            bool continuous = false;
+            bool settling = true;
+        };
+
+        /// @brief Input and the components which read it
+        struct InputLink
+        {
+            inputs::InputBase *input = nullptr;
+            std::vector<uint32_t> components;
+        };
+
+        void UpdateAll();
+        void UpdateIncremental();
+        void UpdateInputs();
+        /// @brief Update the binds of components [first, last)
+        void UpdateComponents(size_t first, size_t last);
+        /// @brief Update the pending outputs into the sink and flush it
+        void InjectPendingOutputs();
+        void Compile();
+
+        std::shared_ptr<inputs::ButtonProgram> m_buttonProgram;
+        std::shared_ptr<util::TimerWheel> m_timers;
+        std::shared_ptr<util::FilterBank> m_filters;
+        std::shared_ptr<outputs::OutputSink> m_outputSink;
         InputMap m_inputs;
         OutputMap m_outputs;
         std::vector<std::shared_ptr<BindBase>> m_binds;
+        std::vector<outputs::OutputBase *> m_pendingOutputs;
+
+        bool m_incremental = false;
+        bool m_compiled = false;
+        ButtonToButtonTable m_buttonToButton;
+        AxisToAxisTable m_axisToAxis;
+        AxisRangeToButtonTable m_axisRangeToButton;
+
+        // Named inputs, then inputs which binds created inline
+        std::vector<inputs::InputBase *> m_inputList;
+        std::vector<inputs::Analog *> m_filteredInputs;
+        std::vector<outputs::OutputBase *> m_outputList;
+
+        std::vector<Component> m_components;
+        std::vector<InputLink> m_inputLinks;
+        std::vector<outputs::OutputBase *> m_looseOutputs;
+        std::vector<uint8_t> m_componentDirty;
+        size_t m_skippedBinds = 0;
+        size_t m_skippedOutputs = 0;
     };
 
 }
\ No newline at end of file
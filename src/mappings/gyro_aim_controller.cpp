@@ -0,0 +1,51 @@
+#include "mappings/gyro_aim_controller.hpp"
+
+#include <algorithm>
+
+namespace mappings
+{
+
+    void GyroAimController::Update()
+    {
+        if (!m_inputDevice || !m_inputDevice->connected || !m_inputDevice->poseValid)
+        {
+            m_enabled = false;
+            m_poseTime = util::Timestamp();
+            return;
+        }
+        m_enabled = !m_enableButton || m_enableButton->IsDown();
+
+        // Integrate over the time since the last pose, starting from the
+        // first pose after a gap
+        util::Timestamp poseTime = m_inputDevice->poseTime;
+        float seconds = 0.0f;
+        if (m_poseTime != util::Timestamp() && poseTime > m_poseTime)
+            seconds = std::min(std::chrono::duration<float>(poseTime - m_poseTime).count(), kMaxTimeStep);
+        m_poseTime = poseTime;
+        if (!m_enabled || seconds <= 0.0f)
+            return;
+
+        // Angular velocity is in world space. Turning left about world up
+        // and pitching up about the device's right axis are positive
+        // rotations, and negative mouse motion.
+        const Vector3f &angularVelocity = m_inputDevice->angularVelocity;
+        const Matrix3f &orientation = m_inputDevice->orientation;
+        float pitchRate = angularVelocity.x * orientation.c[0][0] +
+                          angularVelocity.y * orientation.c[0][1] +
+                          angularVelocity.z * orientation.c[0][2];
+        Vector2f rate(-Math::ToDegrees(angularVelocity.y), -Math::ToDegrees(pitchRate));
+
+        float speed = Math::Sqrt(rate.x * rate.x + rate.y * rate.y);
+        float gain = 1.0f;
+        if (speed < m_deadzone)
+            gain = speed / m_deadzone;
+        if (m_accelerationCurve)
+            gain *= m_accelerationCurve->Lookup(speed);
+
+        // Output fractional counts, which mouse outputs carry across ticks
+        Vector2f counts = rate * (seconds * m_outputScale * gain);
+        m_outputX->SetValue(counts.x, poseTime);
+        m_outputY->SetValue(counts.y, poseTime);
+    }
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+
+#include "mappings/bindings.hpp"
+#include "mappings/response_curve.hpp"
+#include "outputs/outputs.hpp"
+#include "inputs/inputs.hpp"
+#include "vr/device.hpp"
+#include <cmgMath/cmg_math.h>
+
+namespace mappings
+{
+
+    /// @brief Aims by integrating a tracked device's angular velocity, like
+    /// gyro aiming on a gamepad. The runtime measures angular velocity
+    /// directly, so unlike differencing orientations it adds no frame of
+    /// delay and isn't affected by position noise.
+    ///
+    /// Yaw is rotation about world up and pitch is rotation about the
+    /// device's right axis, so it works in any pose, including for head-look
+    /// with the HMD. With an enable button, aim only moves while it is held,
+    /// so releasing it ratchets: the device can be brought back to rest
+    /// without moving aim.
+    class GyroAimController : public BindBase
+    {
+    public:
+        GyroAimController(
+            std::shared_ptr<inputs::Button> enableButton,
+            std::shared_ptr<outputs::Analog> outputX,
+            std::shared_ptr<outputs::Analog> outputY)
+            : m_enableButton(enableButton),
+              m_outputX(outputX),
+              m_outputY(outputY)
+        {
+        }
+
+        /// @brief Settings key of the device to follow ("hmd", "left" or
+        /// "right")
+        inline const std::string &GetDeviceKey() const { return m_deviceKey; }
+        inline void SetDeviceKey(const std::string &deviceKey) { m_deviceKey = deviceKey; }
+
+        inline void SetInputDevice(VrDevice *inputDevice) { m_inputDevice = inputDevice; }
+        inline VrDevice *GetInputDevice() const { return m_inputDevice; }
+
+        /// @brief Whether aim is engaged: the device is tracked and the
+        /// enable button, if any, is held
+        inline bool IsEnabled() const { return m_enabled; }
+
+        virtual void Update() override;
+
+        // Follows the device pose, so stays continuous
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const override
+        {
+            if (m_enableButton)
+                inputs.push_back(m_enableButton.get());
+            outputs.push_back(m_outputX.get());
+            outputs.push_back(m_outputY.get());
+        }
+
+        /// @brief Mouse counts per degree of rotation
+        float m_outputScale = 40.0f;
+
+        /// @brief Angular speed in degrees per second below which rotation
+        /// is scaled down towards zero, to hold aim still against tremor and
+        /// sensor noise
+        float m_deadzone = 0.0f;
+
+        /// @brief Optional gain applied to the output scale by angular speed
+        /// in degrees per second
+        std::shared_ptr<const ResponseCurve> m_accelerationCurve;
+
+    private:
+        /// @brief Longest time step integrated, so a stall or a lost pose
+        /// doesn't fling aim
+        static constexpr float kMaxTimeStep = 0.05f;
+
+        std::string m_deviceKey = "right";
+        VrDevice *m_inputDevice = nullptr;
+        std::shared_ptr<inputs::Button> m_enableButton;
+        std::shared_ptr<outputs::Analog> m_outputX;
+        std::shared_ptr<outputs::Analog> m_outputY;
+
+        bool m_enabled = false;
+        util::Timestamp m_poseTime;
+    };
+
+}
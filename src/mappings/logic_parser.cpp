@@ -3,152 +3,268 @@
 #include "inputs/inputs.hpp"
 #include "outputs/outputs.hpp"
 
-#include "rapidjson/prettywriter.h"
-#include "rapidjson/filewritestream.h"
-#include "rapidjson/document.h"
-#include <set>
+#include <string>
 
-void LogicParser::Tokenize(const std::string &text, std::vector<std::string> &tokens)
+namespace
 {
-    std::set<std::string> double_special_chars = {"&&", "||"};
-    std::set<char> special_chars = {'(', '(', '!', '&', '|'};
+    using Register = inputs::ButtonProgram::Register;
+    using OpCode = inputs::ButtonProgram::OpCode;
 
-    std::string token = cmg::string::Trim(text.substr(0, 1));
-
-    // Iterate every character in the string
-    size_t length = text.length();
-    for (size_t index = 1; index < length + 1; index++)
+    enum class TokenType
     {
-        char c = ' ';
-        if (index < length)
-            c = text[index];
-
-        // Check if this character completes the token
-        bool complete = false;
-        if (index >= length)
-            complete = true;
-        else if (double_special_chars.find(token) != double_special_chars.end())
-            complete = true;
-        else if (token.length() == 1 && special_chars.find(token[0]) != special_chars.end())
-        {
-            std::string tokenWithChar = token;
-            tokenWithChar += c;
-            if (double_special_chars.find(tokenWithChar) == double_special_chars.end())
-                complete = true;
-        }
-        else if (special_chars.find(c) != special_chars.end())
-            complete = true;
-
-        // If complete, then begin a new token
-        if (complete)
-        {
-            cmg::string::TrimIP(token);
-            if (token.length() > 0)
-                tokens.push_back(token);
-            token = "";
-        }
-
-        // Add the character to the token
-        if (token.length() > 0 || c != ' ')
-            token += c;
-    }
-}
+        kEnd,
+        kName,
+        kNot,
+        kAnd,
+        kOr,
+        kXor,
+        kOpen,
+        kClose,
+        kInvalid,
+    };
 
-std::shared_ptr<inputs::Button> LogicParser::ParseButtonLogic(
-    const std::string &text, mappings::BindMapper &mapper, ActionSet &actions)
-{
-    struct Node
+    struct Token
     {
-        std::string token = "";
-        std::shared_ptr<inputs::Button> input;
+        TokenType type = TokenType::kEnd;
+        std::string_view text;
+        size_t offset = 0;
     };
 
-    std::vector<std::string> tokens;
-    std::vector<Node> nodes;
-    LogicParser::Tokenize(text, tokens);
-    for (auto token : tokens)
+    inline bool IsOperatorChar(char c)
     {
-        Node node;
-        node.token = token;
-        nodes.push_back(node);
+        return c == '(' || c == ')' || c == '!' || c == '&' ||
+               c == '|' || c == '^' || c == '=';
     }
 
-    // std::cout << "text: " << text << std::endl;
-    // std::cout << "tokens: ";
-    // for (auto token : tokens)
-    //     std::cout << "\"" << token << "\", ";
-    // std::cout << std::endl;
+    inline bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
 
-    bool updated = true;
-    while (updated)
+    /// @brief Single-pass precedence climbing parser that emits instructions
+    /// straight into a button program as it reduces
+    class Parser
     {
-        updated = false;
+    public:
+        Parser(std::string_view text, mappings::BindMapper &mapper, ActionSet &actions) :
+            m_text(text),
+            m_mapper(mapper),
+            m_actions(actions),
+            m_program(*mapper.GetButtonProgram())
+        {
+        }
 
-        for (size_t i = 0; i < nodes.size(); i++)
+        bool Parse(Register &result)
         {
-            auto &node = nodes[i];
-            bool last = i == tokens.size() - 1;
-            bool first = i == 0;
-            if (node.input != nullptr)
-                continue;
+            Next();
+            if (!ParseExpression(1, result))
+                return false;
+            if (m_token.type == TokenType::kInvalid)
+                return Fail("unexpected character, expected '&&', '||', '^' or '!='");
+            if (m_token.type != TokenType::kEnd)
+                return Fail("expected an operator or end of expression");
+            return true;
+        }
 
-            if (node.token == "!")
+        inline const char *GetError() const { return m_error; }
+        inline size_t GetErrorOffset() const { return m_errorOffset; }
+
+    private:
+        static int GetPrecedence(TokenType type)
+        {
+            switch (type)
             {
-                if (last)
-                    return nullptr;
-                if (nodes[i + 1].input)
-                {
-                    node.input = std::make_shared<inputs::ButtonUnaryOp>(
-                        inputs::ButtonUnaryOp::Operator::kNot,
-                        nodes[i + 1].input);
-                    nodes.erase(nodes.begin() + i + 1);
-                    updated = true;
-                    i--;
-                }
+            case TokenType::kOr:
+                return 1;
+            case TokenType::kAnd:
+                return 2;
+            case TokenType::kXor:
+                return 3;
+            default:
+                return 0;
             }
-            else if (node.token == "&&" || node.token == "||")
+        }
+
+        static OpCode GetOpCode(TokenType type)
+        {
+            switch (type)
             {
-                if (first || last)
-                    return nullptr;
-                if (nodes[i - 1].input && nodes[i + 1].input)
-                {
-                    node.input = std::make_shared<inputs::ButtonBooleanOp>(
-                        node.token == "&&" ? inputs::ButtonBooleanOp::Operator::kAnd : inputs::ButtonBooleanOp::Operator::kOr,
-                        nodes[i - 1].input, nodes[i + 1].input);
-                    nodes.erase(nodes.begin() + i + 1);
-                    nodes.erase(nodes.begin() + i - 1);
-                    i -= 2;
-                    updated = true;
-                }
+            case TokenType::kOr:
+                return OpCode::kOr;
+            case TokenType::kAnd:
+                return OpCode::kAnd;
+            default:
+                return OpCode::kXor;
             }
-            else
+        }
+
+        bool Fail(const char *message)
+        {
+            m_error = message;
+            m_errorOffset = m_token.offset;
+            return false;
+        }
+
+        void Next()
+        {
+            while (m_position < m_text.size() && IsSpace(m_text[m_position]))
+                m_position++;
+
+            m_token.offset = m_position;
+            if (m_position >= m_text.size())
             {
-                node.input = mapper.GetInputOfType<inputs::Button>(node.token);
-                if (node.input == nullptr)
+                m_token.type = TokenType::kEnd;
+                m_token.text = std::string_view();
+                return;
+            }
+
+            size_t start = m_position;
+            char c = m_text[m_position];
+            char next = m_position + 1 < m_text.size() ? m_text[m_position + 1] : '\0';
+            size_t length = 1;
+            switch (c)
+            {
+            case '(':
+                m_token.type = TokenType::kOpen;
+                break;
+            case ')':
+                m_token.type = TokenType::kClose;
+                break;
+            case '^':
+                m_token.type = TokenType::kXor;
+                break;
+            case '!':
+                if (next == '=')
                 {
-                    auto action = actions.GetActionOfType<ButtonAction>(node.token);
-                    if (action != nullptr)
-                        node.input = std::make_shared<inputs::ButtonFromAction>(action);
+                    m_token.type = TokenType::kXor;
+                    length = 2;
                 }
-                if (node.input == nullptr)
+                else
+                    m_token.type = TokenType::kNot;
+                break;
+            case '&':
+            case '|':
+                if (next == c)
                 {
-                    CMG_LOG_ERROR() << "Unknown input: " << node.token;
-                    return nullptr;
+                    m_token.type = c == '&' ? TokenType::kAnd : TokenType::kOr;
+                    length = 2;
                 }
-                updated = true;
+                else
+                    m_token.type = TokenType::kInvalid;
+                break;
+            case '=':
+                m_token.type = TokenType::kInvalid;
+                break;
+            default:
+                m_token.type = TokenType::kName;
+                length = 0;
+                while (start + length < m_text.size() &&
+                       !IsSpace(m_text[start + length]) &&
+                       !IsOperatorChar(m_text[start + length]))
+                    length++;
+                break;
             }
+            m_token.text = m_text.substr(start, length);
+            m_position = start + length;
+        }
+
+        bool ParseExpression(int minPrecedence, Register &result)
+        {
+            if (!ParseUnary(result))
+                return false;
+
+            int precedence = GetPrecedence(m_token.type);
+            while (precedence >= minPrecedence)
+            {
+                OpCode op = GetOpCode(m_token.type);
+                Next();
+                Register right;
+                if (!ParseExpression(precedence + 1, right))
+                    return false;
+                result = m_program.AddInstruction(op, result, right);
+                precedence = GetPrecedence(m_token.type);
+            }
+            return true;
+        }
+
+        bool ParseUnary(Register &result)
+        {
+            switch (m_token.type)
+            {
+            case TokenType::kNot:
+                Next();
+                if (!ParseUnary(result))
+                    return false;
+                result = m_program.AddInstruction(OpCode::kNot, result);
+                return true;
+            case TokenType::kOpen:
+                Next();
+                if (!ParseExpression(1, result))
+                    return false;
+                if (m_token.type != TokenType::kClose)
+                    return Fail("expected ')'");
+                Next();
+                return true;
+            case TokenType::kName:
+                if (!Resolve(m_token.text, result))
+                    return Fail("unknown input or action");
+                Next();
+                return true;
+            case TokenType::kInvalid:
+                return Fail("unexpected character, expected '&&', '||', '^' or '!='");
+            case TokenType::kEnd:
+                return Fail("unexpected end of expression");
+            default:
+                return Fail("expected an input name, '!' or '('");
+            }
+        }
+
+        bool Resolve(std::string_view name, Register &result)
+        {
+            std::string key(name);
+
+            // Named inputs share their register rather than being
+            // evaluated again
+            auto input = m_mapper.GetInputOfType<inputs::ButtonFromProgram>(key);
+            if (input != nullptr && input->GetProgram() == m_mapper.GetButtonProgram())
+            {
+                result = input->GetRegister();
+                return true;
+            }
+
+            auto action = m_actions.GetActionOfType<ButtonAction>(key);
+            if (action != nullptr)
+            {
+                result = m_program.AddAction(*action);
+                return true;
+            }
+            return false;
         }
-    }
 
-    if (nodes.size() != 1)
+        std::string_view m_text;
+        size_t m_position = 0;
+        Token m_token;
+        const char *m_error = nullptr;
+        size_t m_errorOffset = 0;
+        mappings::BindMapper &m_mapper;
+        ActionSet &m_actions;
+        inputs::ButtonProgram &m_program;
+    };
+}
+
+std::shared_ptr<inputs::Button> LogicParser::ParseButtonLogic(
+    std::string_view text, mappings::BindMapper &mapper, ActionSet &actions)
+{
+    Parser parser(text, mapper, actions);
+    Register reg;
+    if (!parser.Parse(reg))
     {
-        CMG_LOG_ERROR() << "error parsing logic: " << text;
+        CMG_LOG_ERROR() << "Error parsing logic at column " << (parser.GetErrorOffset() + 1)
+                        << ": " << parser.GetError();
+        CMG_LOG_ERROR() << "  " << std::string(text);
+        CMG_LOG_ERROR() << "  " << std::string(parser.GetErrorOffset(), ' ') << "^";
         return nullptr;
     }
-    else if (nodes[0].input == nullptr)
-    {
-        CMG_LOG_ERROR() << "error parsing logic: " << text;
-    }
 
-    return nodes[0].input;
-}
\ No newline at end of file
+    return std::make_shared<inputs::ButtonFromProgram>(mapper.GetButtonProgram(), reg);
+}
@@ -5,12 +5,17 @@
 #include "inputs/inputs.hpp"
 #include "outputs/outputs.hpp"
 
-#include <set>
+#include <string_view>
 
 class LogicParser
 {
 public:
-    static void Tokenize(const std::string &text, std::vector<std::string> &tokens);
+    /// @brief Compile a button logic expression into the mapper's button
+    /// program. Operands are input names or digital action paths. From
+    /// loosest to tightest binding, the operators are `||`, `&&`, `^` (or
+    /// `!=`) and unary `!`; parentheses group. Errors are logged with the
+    /// column they occurred at.
+    /// @return the compiled input, or nullptr on error
     static std::shared_ptr<inputs::Button> ParseButtonLogic(
-        const std::string &text, mappings::BindMapper &mapper, ActionSet &actions);
+        std::string_view text, mappings::BindMapper &mapper, ActionSet &actions);
 };
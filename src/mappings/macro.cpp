@@ -0,0 +1,201 @@
+#include "mappings/macro.hpp"
+
+#include <algorithm>
+
+namespace mappings
+{
+
+    MacroTask &MacroTask::operator=(MacroTask &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+        return *this;
+    }
+
+    MacroTask::~MacroTask()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    MacroBind::MacroBind(std::shared_ptr<inputs::Button> input,
+                         std::vector<MacroStep> steps,
+                         std::shared_ptr<util::TimerWheel> timers)
+        : input(input),
+          steps(std::move(steps)),
+          m_timers(timers)
+    {
+    }
+
+    MacroBind::~MacroBind()
+    {
+        if (m_timer != util::TimerWheel::kInvalidTimer)
+            m_timers->Cancel(m_timer);
+    }
+
+    void MacroBind::Update()
+    {
+        m_tick++;
+
+        if (input->IsPressed())
+        {
+            Stop(input->GetTimestamp());
+            Start(input->GetTimestamp());
+        }
+        else if (input->IsReleased() && cancelOnRelease && IsRunning())
+        {
+            Stop(input->GetTimestamp());
+        }
+
+        if (IsRunning() && IsReady())
+            m_task.Resume();
+        if (m_task.IsValid() && m_task.IsDone())
+            Stop(m_stepTime);
+
+        // Keep holding outputs pressed on an earlier tick; those pressed
+        // this tick already contributed with their step time
+        for (size_t i = 0; i < m_held.size(); i++)
+        {
+            if (m_heldSince[i] != m_tick)
+                m_held[i]->SetState(true);
+        }
+    }
+
+    void MacroBind::GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                   std::vector<outputs::OutputBase *> &outputs) const
+    {
+        inputs.push_back(input.get());
+        for (const MacroStep &step : steps)
+        {
+            if (step.button)
+                outputs.push_back(step.button.get());
+            if (step.analog)
+                outputs.push_back(step.analog.get());
+            if (step.input)
+                inputs.push_back(step.input.get());
+        }
+    }
+
+    MacroTask MacroBind::Run()
+    {
+        for (const MacroStep &step : steps)
+        {
+            switch (step.type)
+            {
+            case MacroStep::Type::kPress:
+                Press(step.button.get());
+                break;
+            case MacroStep::Type::kRelease:
+            {
+                // Hold for at least one tick so the press isn't lost
+                auto it = std::find(m_held.begin(), m_held.end(), step.button.get());
+                if (it != m_held.end() && m_heldSince[it - m_held.begin()] == m_tick)
+                    co_await WaitTicks{*this, 1};
+                Release(step.button.get());
+                break;
+            }
+            case MacroStep::Type::kMove:
+                step.analog->SetValue(step.amount, m_stepTime);
+                break;
+            case MacroStep::Type::kWait:
+                co_await WaitUntil{*this, m_stepTime + step.duration};
+                break;
+            case MacroStep::Type::kWaitTicks:
+                co_await WaitTicks{*this, step.ticks};
+                break;
+            case MacroStep::Type::kWaitInput:
+                co_await WaitInput{*this, step.input.get(), step.inputDown};
+                break;
+            }
+        }
+    }
+
+    void MacroBind::Start(util::Timestamp time)
+    {
+        m_task = Run();
+        m_stepTime = time == util::Timestamp() ? util::Clock::now() : time;
+        m_wake = Wake::kNow;
+    }
+
+    void MacroBind::Stop(util::Timestamp time)
+    {
+        if (m_timer != util::TimerWheel::kInvalidTimer)
+            m_timers->Cancel(m_timer);
+        m_timer = util::TimerWheel::kInvalidTimer;
+        m_timerFired = false;
+        m_task = MacroTask();
+
+        for (outputs::Button *output : m_held)
+            output->SetState(false, time);
+        m_held.clear();
+        m_heldSince.clear();
+    }
+
+    void MacroBind::Press(outputs::Button *output)
+    {
+        output->SetState(true, m_stepTime);
+        if (std::find(m_held.begin(), m_held.end(), output) != m_held.end())
+            return;
+        m_held.push_back(output);
+        m_heldSince.push_back(m_tick);
+    }
+
+    void MacroBind::Release(outputs::Button *output)
+    {
+        auto it = std::find(m_held.begin(), m_held.end(), output);
+        if (it == m_held.end())
+            return;
+        size_t index = it - m_held.begin();
+        m_held.erase(it);
+        m_heldSince.erase(m_heldSince.begin() + index);
+        output->SetState(false, m_stepTime);
+    }
+
+    bool MacroBind::IsReady() const
+    {
+        switch (m_wake)
+        {
+        case Wake::kNow:
+            return true;
+        case Wake::kTimer:
+            return m_timerFired;
+        case Wake::kTick:
+            return m_tick >= m_wakeTick;
+        case Wake::kInput:
+            return m_waitInput->IsDown() == m_waitDown;
+        }
+        return false;
+    }
+
+    void MacroBind::OnTimer(uint32_t cookie, util::Timestamp deadline)
+    {
+        m_timer = util::TimerWheel::kInvalidTimer;
+        m_timerFired = true;
+    }
+
+    void MacroBind::WaitUntil::await_suspend(std::coroutine_handle<>)
+    {
+        bind.m_wake = Wake::kTimer;
+        bind.m_timerFired = false;
+        bind.m_timer = bind.m_timers->Schedule(deadline, &bind);
+    }
+
+    void MacroBind::WaitTicks::await_suspend(std::coroutine_handle<>)
+    {
+        bind.m_wake = Wake::kTick;
+        bind.m_wakeTick = bind.m_tick + ticks;
+    }
+
+    void MacroBind::WaitInput::await_suspend(std::coroutine_handle<>)
+    {
+        bind.m_wake = Wake::kInput;
+        bind.m_waitInput = input;
+        bind.m_waitDown = down;
+    }
+
+}
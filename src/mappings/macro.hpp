@@ -0,0 +1,169 @@
+#pragma once
+
+#include <coroutine>
+#include <vector>
+
+#include "mappings/bindings.hpp"
+#include "util/timer_wheel.hpp"
+
+namespace mappings
+{
+
+    /// @brief One step of a macro
+    struct MacroStep
+    {
+        enum class Type
+        {
+            kPress,
+            kRelease,
+            kMove,
+            kWait,
+            kWaitTicks,
+            kWaitInput,
+        };
+
+        Type type = Type::kWait;
+
+        // kPress, kRelease
+        std::shared_ptr<outputs::Button> button;
+
+        // kMove
+        std::shared_ptr<outputs::Analog> analog;
+        float amount = 0.0f;
+
+        // kWait
+        util::Clock::duration duration = util::Clock::duration::zero();
+
+        // kWaitTicks
+        uint32_t ticks = 0;
+
+        // kWaitInput
+        std::shared_ptr<inputs::Button> input;
+        bool inputDown = true;
+    };
+
+    /// @brief Handle to a running macro coroutine. It starts suspended, and
+    /// destroying the handle cancels the macro wherever it is waiting.
+    class MacroTask
+    {
+    public:
+        struct promise_type
+        {
+            MacroTask get_return_object()
+            {
+                return MacroTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        MacroTask() = default;
+        explicit MacroTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+        MacroTask(MacroTask &&other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+        MacroTask &operator=(MacroTask &&other) noexcept;
+        MacroTask(const MacroTask &) = delete;
+        MacroTask &operator=(const MacroTask &) = delete;
+        ~MacroTask();
+
+        inline bool IsValid() const { return static_cast<bool>(m_handle); }
+        inline bool IsDone() const { return !m_handle || m_handle.done(); }
+        inline void Resume() { m_handle.resume(); }
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    /// @brief Plays a sequence of output steps when its input is pressed.
+    /// The steps run as a coroutine which suspends at each wait and is
+    /// resumed by the bind's update on the mapping tick: timed waits are
+    /// scheduled on the mapper's timer wheel so they resume at their exact
+    /// deadline, measured from the previous step's deadline so a sequence
+    /// doesn't drift. Pressed outputs are held until released by a step,
+    /// the macro ends, or it is cancelled by the input being released.
+    /// Pressing the input again restarts the macro.
+    class MacroBind : public BindBase, public util::TimerListener
+    {
+    public:
+        MacroBind(std::shared_ptr<inputs::Button> input,
+                  std::vector<MacroStep> steps,
+                  std::shared_ptr<util::TimerWheel> timers);
+        virtual ~MacroBind();
+
+        virtual void Update() override;
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const override;
+
+        inline bool IsRunning() const { return !m_task.IsDone(); }
+
+        std::shared_ptr<inputs::Button> input;
+        std::vector<MacroStep> steps;
+        bool cancelOnRelease = true;
+
+    private:
+        enum class Wake
+        {
+            kNow,
+            kTimer,
+            kTick,
+            kInput,
+        };
+
+        struct WaitUntil
+        {
+            MacroBind &bind;
+            util::Timestamp deadline;
+
+            bool await_ready() const { return deadline <= util::Clock::now(); }
+            void await_suspend(std::coroutine_handle<>);
+            void await_resume() { bind.m_stepTime = deadline; }
+        };
+
+        struct WaitTicks
+        {
+            MacroBind &bind;
+            uint32_t ticks;
+
+            bool await_ready() const { return ticks == 0; }
+            void await_suspend(std::coroutine_handle<>);
+            void await_resume() { bind.m_stepTime = util::Clock::now(); }
+        };
+
+        struct WaitInput
+        {
+            MacroBind &bind;
+            inputs::Button *input;
+            bool down;
+
+            bool await_ready() const { return input->IsDown() == down; }
+            void await_suspend(std::coroutine_handle<>);
+            void await_resume() { bind.m_stepTime = input->GetTimestamp(); }
+        };
+
+        MacroTask Run();
+        void Start(util::Timestamp time);
+        void Stop(util::Timestamp time);
+        void Press(outputs::Button *output);
+        void Release(outputs::Button *output);
+        bool IsReady() const;
+        virtual void OnTimer(uint32_t cookie, util::Timestamp deadline) override;
+
+        std::shared_ptr<util::TimerWheel> m_timers;
+        MacroTask m_task;
+        util::Timestamp m_stepTime;
+        uint64_t m_tick = 0;
+
+        Wake m_wake = Wake::kNow;
+        util::TimerWheel::TimerId m_timer = util::TimerWheel::kInvalidTimer;
+        bool m_timerFired = false;
+        uint64_t m_wakeTick = 0;
+        inputs::Button *m_waitInput = nullptr;
+        bool m_waitDown = true;
+
+        // Outputs held down by the macro, and the tick each was pressed
+        std::vector<outputs::Button *> m_held;
+        std::vector<uint64_t> m_heldSince;
+    };
+
+}
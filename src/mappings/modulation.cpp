@@ -0,0 +1,168 @@
+#include "mappings/modulation.hpp"
+
+namespace mappings
+{
+
+    PwmGenerator::PwmGenerator(std::shared_ptr<util::TimerWheel> timers,
+                               util::Clock::duration period,
+                               const ModulationTiming &timing)
+        : m_timers(timers),
+          m_period(period),
+          m_timing(timing)
+    {
+    }
+
+    PwmGenerator::~PwmGenerator()
+    {
+        if (m_timer != util::TimerWheel::kInvalidTimer)
+            m_timers->Cancel(m_timer);
+    }
+
+    void PwmGenerator::SetDuty(float duty, util::Timestamp time)
+    {
+        duty = Math::Clamp(duty, 0.0f, 1.0f);
+        if (duty == m_duty)
+            return;
+        m_duty = duty;
+
+        // An edge fired this tick after the change was timed for the old
+        // duty cycle, so undo it and decide again
+        if (time < m_edgeTime)
+        {
+            m_on = !m_on;
+            m_edgeTime = m_prevEdgeTime;
+        }
+
+        util::Clock::duration phase = GetPhaseDuration(m_on);
+        if (phase != kForever && time - m_edgeTime >= phase)
+        {
+            m_on = !m_on;
+            m_prevEdgeTime = m_edgeTime;
+            m_edgeTime = time;
+        }
+        ScheduleEdge();
+    }
+
+    util::Clock::duration PwmGenerator::GetPhaseDuration(bool on) const
+    {
+        if (m_duty <= 0.0f)
+            return on ? m_timing.minOn : kForever;
+        if (m_duty >= 1.0f)
+            return on ? kForever : m_timing.minOff;
+
+        // Stretch the period rather than shorten a phase below its minimum
+        float period = std::chrono::duration<float>(m_period).count();
+        float minOn = std::chrono::duration<float>(m_timing.minOn).count();
+        float minOff = std::chrono::duration<float>(m_timing.minOff).count();
+        float onTime = period * m_duty;
+        float offTime = period - onTime;
+        if (onTime < minOn)
+        {
+            onTime = minOn;
+            offTime = onTime * (1.0f - m_duty) / m_duty;
+        }
+        if (offTime < minOff)
+        {
+            offTime = minOff;
+            onTime = offTime * m_duty / (1.0f - m_duty);
+        }
+        return util::SecondsToDuration(on ? onTime : offTime);
+    }
+
+    void PwmGenerator::ScheduleEdge()
+    {
+        if (m_timer != util::TimerWheel::kInvalidTimer)
+            m_timers->Cancel(m_timer);
+        m_timer = util::TimerWheel::kInvalidTimer;
+
+        util::Clock::duration phase = GetPhaseDuration(m_on);
+        if (phase != kForever)
+            m_timer = m_timers->Schedule(m_edgeTime + phase, this);
+    }
+
+    void PwmGenerator::OnTimer(uint32_t cookie, util::Timestamp deadline)
+    {
+        // Edges are timed from the previous deadline, so a late tick doesn't
+        // shift the phase of the wave
+        m_timer = util::TimerWheel::kInvalidTimer;
+        m_on = !m_on;
+        m_prevEdgeTime = m_edgeTime;
+        m_edgeTime = deadline;
+        ScheduleEdge();
+    }
+
+    TurboButton::TurboButton(std::shared_ptr<inputs::Button> input,
+                             std::shared_ptr<outputs::Button> output,
+                             std::shared_ptr<util::TimerWheel> timers,
+                             float rate,
+                             float duty,
+                             const ModulationTiming &timing)
+        : input(input),
+          output(output),
+          duty(duty),
+          m_generator(timers, util::SecondsToDuration(1.0f / Math::Max(rate, 0.001f)), timing)
+    {
+    }
+
+    void TurboButton::Update()
+    {
+        util::Timestamp time = input->GetTimestamp();
+        if (time == util::Timestamp())
+            time = util::Clock::now();
+        m_generator.SetDuty(input->IsDown() ? duty : 0.0f, time);
+        output->SetState(m_generator.IsOn(), m_generator.GetEdgeTime());
+    }
+
+    void TurboButton::GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                     std::vector<outputs::OutputBase *> &outputs) const
+    {
+        inputs.push_back(input.get());
+        outputs.push_back(output.get());
+    }
+
+    AxisToPwm::AxisToPwm(std::shared_ptr<inputs::Analog> input,
+                         std::shared_ptr<outputs::Button> outputPositive,
+                         std::shared_ptr<outputs::Button> outputNegative,
+                         std::shared_ptr<util::TimerWheel> timers,
+                         util::Clock::duration period,
+                         const ModulationTiming &timing)
+        : input(input),
+          outputPositive(outputPositive),
+          outputNegative(outputNegative),
+          m_positive(timers, period, timing),
+          m_negative(timers, period, timing)
+    {
+    }
+
+    void AxisToPwm::Update()
+    {
+        util::Timestamp time = input->GetTimestamp();
+        if (time == util::Timestamp())
+            time = util::Clock::now();
+
+        float value = input->GetValue();
+        float duty = 0.0f;
+        if (saturation > deadzone)
+            duty = Math::Clamp((Math::Abs(value) - deadzone) / (saturation - deadzone), 0.0f, 1.0f);
+        else if (Math::Abs(value) >= deadzone)
+            duty = 1.0f;
+
+        m_positive.SetDuty(value > 0.0f ? duty : 0.0f, time);
+        m_negative.SetDuty(value < 0.0f ? duty : 0.0f, time);
+        if (outputPositive)
+            outputPositive->SetState(m_positive.IsOn(), m_positive.GetEdgeTime());
+        if (outputNegative)
+            outputNegative->SetState(m_negative.IsOn(), m_negative.GetEdgeTime());
+    }
+
+    void AxisToPwm::GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                   std::vector<outputs::OutputBase *> &outputs) const
+    {
+        inputs.push_back(input.get());
+        if (outputPositive)
+            outputs.push_back(outputPositive.get());
+        if (outputNegative)
+            outputs.push_back(outputNegative.get());
+    }
+
+}
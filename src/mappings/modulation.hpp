@@ -0,0 +1,112 @@
+#pragma once
+
+#include "mappings/bindings.hpp"
+#include "util/timer_wheel.hpp"
+
+namespace mappings
+{
+
+    /// @brief Shortest on and off phases of a modulated output, so each
+    /// press and release lasts long enough for the game to sample it
+    struct ModulationTiming
+    {
+        util::Clock::duration minOn = std::chrono::milliseconds(16);
+        util::Clock::duration minOff = std::chrono::milliseconds(16);
+    };
+
+    /// @brief Square wave with a variable duty cycle. Edges are fired by a
+    /// timer wheel at their exact time, independent of the mapping tick
+    /// rate. When a phase would be shorter than its minimum, the period is
+    /// stretched so the duty cycle is kept.
+    class PwmGenerator : public util::TimerListener
+    {
+    public:
+        PwmGenerator(std::shared_ptr<util::TimerWheel> timers,
+                     util::Clock::duration period,
+                     const ModulationTiming &timing);
+        virtual ~PwmGenerator();
+
+        /// @brief Change the duty cycle. A phase which has already run
+        /// longer than its new length ends at the given time.
+        /// @param duty fraction of the period to be on, where 0 is always
+        /// off and 1 is always on
+        void SetDuty(float duty, util::Timestamp time);
+
+        inline float GetDuty() const { return m_duty; }
+        inline bool IsOn() const { return m_on; }
+
+        /// @brief Time of the most recent edge
+        inline util::Timestamp GetEdgeTime() const { return m_edgeTime; }
+
+    private:
+        static constexpr util::Clock::duration kForever = util::Clock::duration::max();
+
+        util::Clock::duration GetPhaseDuration(bool on) const;
+        void ScheduleEdge();
+        virtual void OnTimer(uint32_t cookie, util::Timestamp deadline) override;
+
+        std::shared_ptr<util::TimerWheel> m_timers;
+        util::TimerWheel::TimerId m_timer = util::TimerWheel::kInvalidTimer;
+        util::Clock::duration m_period;
+        ModulationTiming m_timing;
+        float m_duty = 0.0f;
+        bool m_on = false;
+        util::Timestamp m_edgeTime;
+        util::Timestamp m_prevEdgeTime;
+    };
+
+    /// @brief Presses a button output repeatedly at a fixed rate while a
+    /// button input is held, starting as soon as it is pressed
+    class TurboButton : public BindBase
+    {
+    public:
+        /// @param rate presses per second
+        /// @param duty fraction of each press period the output is down
+        TurboButton(std::shared_ptr<inputs::Button> input,
+                    std::shared_ptr<outputs::Button> output,
+                    std::shared_ptr<util::TimerWheel> timers,
+                    float rate,
+                    float duty,
+                    const ModulationTiming &timing);
+
+        virtual void Update() override;
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const override;
+
+    private:
+        std::shared_ptr<inputs::Button> input;
+        std::shared_ptr<outputs::Button> output;
+        float duty;
+        PwmGenerator m_generator;
+    };
+
+    /// @brief Drives a button output for each direction of an analog input
+    /// with a duty cycle proportional to how far past the deadzone the input
+    /// is, reaching always on at the saturation value. Gives fine control
+    /// of digital movement keys from a thumbstick.
+    class AxisToPwm : public BindBase
+    {
+    public:
+        AxisToPwm(std::shared_ptr<inputs::Analog> input,
+                  std::shared_ptr<outputs::Button> outputPositive,
+                  std::shared_ptr<outputs::Button> outputNegative,
+                  std::shared_ptr<util::TimerWheel> timers,
+                  util::Clock::duration period,
+                  const ModulationTiming &timing);
+
+        virtual void Update() override;
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const override;
+
+        float deadzone = 0.15f;
+        float saturation = 0.9f;
+
+    private:
+        std::shared_ptr<inputs::Analog> input;
+        std::shared_ptr<outputs::Button> outputPositive;
+        std::shared_ptr<outputs::Button> outputNegative;
+        PwmGenerator m_positive;
+        PwmGenerator m_negative;
+    };
+
+}
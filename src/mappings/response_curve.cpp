@@ -0,0 +1,116 @@
+#include "mappings/response_curve.hpp"
+
+namespace mappings
+{
+
+    template <class Function>
+    void ResponseCurve::Bake(float inputMax, Function function)
+    {
+        m_inputMax = inputMax;
+        m_indexScale = static_cast<float>(kTableSize) / inputMax;
+        for (size_t index = 0; index <= kTableSize; index++)
+            m_table[index] = function(inputMax * index / kTableSize);
+    }
+
+    ResponseCurve::ResponseCurve()
+    {
+        Bake(1.0f, [](float x)
+             { return x; });
+    }
+
+    ResponseCurve ResponseCurve::Linear()
+    {
+        return ResponseCurve();
+    }
+
+    ResponseCurve ResponseCurve::Expo(float amount)
+    {
+        ResponseCurve curve;
+        curve.Bake(1.0f, [amount](float x)
+                   { return (1.0f - amount) * x + amount * x * x * x; });
+        return curve;
+    }
+
+    ResponseCurve ResponseCurve::SCurve(float strength)
+    {
+        ResponseCurve curve;
+        curve.Bake(1.0f, [strength](float x)
+                   { return (1.0f - strength) * x + strength * x * x * (3.0f - 2.0f * x); });
+        return curve;
+    }
+
+    ResponseCurve ResponseCurve::Acceleration(float minSpeed, float maxSpeed,
+                                              float minGain, float maxGain)
+    {
+        ResponseCurve curve;
+        float range = Math::Max(maxSpeed - minSpeed, 1e-6f);
+        curve.Bake(Math::Max(maxSpeed, 1e-6f), [=](float speed)
+                   {
+                       float t = Math::Clamp((speed - minSpeed) / range, 0.0f, 1.0f);
+                       return minGain + (maxGain - minGain) * t; });
+        return curve;
+    }
+
+    ResponseCurve ResponseCurve::FromPoints(const std::vector<Vector2f> &points)
+    {
+        ResponseCurve curve;
+        if (points.size() < 2)
+            return curve;
+
+        // Fritsch-Carlson tangents, which keep the spline monotone between
+        // monotone control points so it can't overshoot them
+        size_t count = points.size();
+        std::vector<float> secants(count - 1);
+        for (size_t k = 0; k + 1 < count; k++)
+        {
+            float width = Math::Max(points[k + 1].x - points[k].x, 1e-6f);
+            secants[k] = (points[k + 1].y - points[k].y) / width;
+        }
+        std::vector<float> tangents(count);
+        tangents[0] = secants[0];
+        tangents[count - 1] = secants[count - 2];
+        for (size_t k = 1; k + 1 < count; k++)
+        {
+            if (secants[k - 1] * secants[k] <= 0.0f)
+                tangents[k] = 0.0f;
+            else
+                tangents[k] = (secants[k - 1] + secants[k]) * 0.5f;
+        }
+        for (size_t k = 0; k + 1 < count; k++)
+        {
+            if (secants[k] == 0.0f)
+            {
+                tangents[k] = 0.0f;
+                tangents[k + 1] = 0.0f;
+                continue;
+            }
+            float a = tangents[k] / secants[k];
+            float b = tangents[k + 1] / secants[k];
+            float length = a * a + b * b;
+            if (length > 9.0f)
+            {
+                float tau = 3.0f / Math::Sqrt(length);
+                tangents[k] = tau * a * secants[k];
+                tangents[k + 1] = tau * b * secants[k];
+            }
+        }
+
+        curve.Bake(points[count - 1].x, [&](float x)
+                   {
+                       if (x <= points[0].x)
+                           return points[0].y;
+                       size_t k = 0;
+                       while (k + 2 < count && x > points[k + 1].x)
+                           k++;
+                       float width = Math::Max(points[k + 1].x - points[k].x, 1e-6f);
+                       float t = Math::Clamp((x - points[k].x) / width, 0.0f, 1.0f);
+                       float t2 = t * t;
+                       float t3 = t2 * t;
+                       return (2.0f * t3 - 3.0f * t2 + 1.0f) * points[k].y +
+                              (t3 - 2.0f * t2 + t) * width * tangents[k] +
+                              (-2.0f * t3 + 3.0f * t2) * points[k + 1].y +
+                              (t3 - t2) * width * tangents[k + 1]; });
+        return curve;
+    }
+
+}
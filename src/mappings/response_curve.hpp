@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <cmgMath/cmg_math.h>
+
+namespace mappings
+{
+
+    /// @brief Response curve mapping an input magnitude to an output
+    /// magnitude, baked at load time into a fixed-size lookup table which is
+    /// sampled with linear interpolation. Inputs beyond the curve's domain
+    /// clamp to its last value.
+    class ResponseCurve
+    {
+    public:
+        static constexpr size_t kTableSize = 256;
+
+        /// @brief Identity curve over [0, 1]
+        ResponseCurve();
+
+        /// @brief y = x over [0, 1]
+        static ResponseCurve Linear();
+
+        /// @brief Blend of linear and cubic, y = (1 - amount) x + amount x^3,
+        /// over [0, 1]. Softens the center without reducing the maximum.
+        static ResponseCurve Expo(float amount);
+
+        /// @brief Blend of linear and smoothstep over [0, 1]. Slow near the
+        /// center and near full deflection, fast in between.
+        static ResponseCurve SCurve(float strength);
+
+        /// @brief Gain by speed: minGain up to minSpeed, ramping linearly to
+        /// maxGain at maxSpeed
+        static ResponseCurve Acceleration(float minSpeed, float maxSpeed,
+                                          float minGain, float maxGain);
+
+        /// @brief Monotone cubic spline through control points sorted by x,
+        /// starting at x >= 0. The domain ends at the last point.
+        static ResponseCurve FromPoints(const std::vector<Vector2f> &points);
+
+        /// @brief Look up the curve for a magnitude
+        inline float Lookup(float magnitude) const
+        {
+            float position = magnitude * m_indexScale;
+            if (!(position < static_cast<float>(kTableSize)))
+                return m_table[kTableSize];
+            if (position <= 0.0f)
+                return m_table[0];
+            size_t index = static_cast<size_t>(position);
+            float t = position - static_cast<float>(index);
+            return m_table[index] + (m_table[index + 1] - m_table[index]) * t;
+        }
+
+        /// @brief Apply the curve to a signed value, keeping its sign
+        inline float Evaluate(float value) const
+        {
+            float result = Lookup(Math::Abs(value));
+            return value < 0.0f ? -result : result;
+        }
+
+        inline float GetInputMax() const { return m_inputMax; }
+
+    private:
+        template <class Function>
+        void Bake(float inputMax, Function function);
+
+        float m_inputMax = 1.0f;
+        float m_indexScale = static_cast<float>(kTableSize);
+        std::array<float, kTableSize + 1> m_table = {};
+    };
+
+}
@@ -1,17 +1,71 @@
 #include "mappings/sphere_aim_controller.hpp"
+#include "mappings/aim_late_latch.hpp"
 
 namespace mappings
 {
 
+    bool SphereAimController::SetLateLatch(std::shared_ptr<AimLateLatch> latch)
+    {
+        auto outputX = std::dynamic_pointer_cast<outputs::MouseMovement>(m_outputX);
+        auto outputY = std::dynamic_pointer_cast<outputs::MouseMovement>(m_outputY);
+        if (latch)
+        {
+            if (!outputX || !outputY || outputX->IsStreamed() || outputY->IsStreamed())
+                return false;
+            latch->SetOutputAxes(outputX->GetAxis(), outputY->GetAxis());
+        }
+        m_latch = latch;
+        m_latchOutput = latch ? outputX : nullptr;
+        return true;
+    }
+
     void SphereAimController::Update()
     {
         if (!m_inputDevice || !m_inputDevice->connected || !m_inputDevice->poseValid)
             return;
 
-        bool enabledPrev = m_enabled;
         m_enabled = m_enableButton->IsDown();
-        Vector2i mouseOffsetPrev = m_mouseOffset;
+        Vector2f aimPositionPrev = m_aimPosition;
+        Vector2f step = m_mode == AimMode::kQuaternion ? UpdateQuaternion() : UpdateSphere();
+
+        // Convert this tick's change in aim angles to pixels, with a gain
+        // looked up by angular speed when accelerated
+        util::Timestamp poseTime = m_inputDevice->poseTime;
+        float gain = 1.0f;
+        if (m_accelerationCurve && m_poseTime != util::Timestamp() && poseTime > m_poseTime)
+        {
+            float seconds = std::chrono::duration<float>(poseTime - m_poseTime).count();
+            float speed = Math::Sqrt(step.x * step.x + step.y * step.y) / seconds;
+            gain = m_accelerationCurve->Lookup(speed);
+        }
+        m_poseTime = poseTime;
+        m_aimPosition = m_aimPosition + step * (m_outputScale * gain);
+
+        // When late latched, the injection thread moves by its own pose, so
+        // only pass on whether aim is engaged and the gain
+        if (m_latch)
+        {
+            m_latch->Publish(m_enabled, m_outputScale * gain);
+            if (m_enabled)
+                m_latchOutput->RequestLateLatch();
+            return;
+        }
+
+        // Output fractional counts, which mouse outputs carry across ticks
+        if (m_enabled)
+        {
+            m_outputX->SetValue(m_aimPosition.x - aimPositionPrev.x, poseTime);
+            m_outputY->SetValue(m_aimPosition.y - aimPositionPrev.y, poseTime);
+        }
+        else
+        {
+            m_outputX->SetValue(0.0f, poseTime);
+            m_outputY->SetValue(0.0f, poseTime);
+        }
+    }
 
+    Vector2f SphereAimController::UpdateSphere()
+    {
         Matrix3f orientation = m_inputDevice->orientation;
         Vector3f direction = orientation * -Vector3f::UNITZ;
 
@@ -40,7 +94,8 @@ namespace mappings
         // If became enabled, then reset center point and home angles
         if (!m_enabled)
         {
-            m_mouseOffset = Vector2i::ZERO;
+            m_aimAngles = Vector2f::ZERO;
+            m_aimPosition = Vector2f::ZERO;
             m_center = m_inputDevice->position + (ray.direction * m_centerBias);
             m_azimuthOffset = azimuth;
             m_elevationOffset = elevation;
@@ -57,24 +112,80 @@ namespace mappings
         m_azimuth = azimuth;
         m_elevation = elevation;
 
-        // Convert az/el angles to pixels
-        const float degreesToPixels = 40;
-        m_mouseOffset.x = static_cast<int32_t>(Math::ToDegrees(azDelta) * degreesToPixels);
-        m_mouseOffset.y = static_cast<int32_t>(-Math::ToDegrees(elDelta) * degreesToPixels);
+        // Aim angles are in degrees, with Y down like the mouse
+        Vector2f aimAngles(Math::ToDegrees(azDelta), -Math::ToDegrees(elDelta));
+        Vector2f step = aimAngles - m_aimAngles;
+        m_aimAngles = aimAngles;
+        return step;
+    }
 
-        if (m_enabled)
+    util::Quaternion SphereAimController::ToQuaternion(const Matrix3f &orientation)
+    {
+        float rows[3][3];
+        for (size_t col = 0; col < 3; col++)
         {
-            m_outputX->SetValue(
-                static_cast<float>(m_mouseOffset.x - mouseOffsetPrev.x));
-            m_outputY->SetValue(
-                static_cast<float>(m_mouseOffset.y - mouseOffsetPrev.y));
+            for (size_t row = 0; row < 3; row++)
+                rows[row][col] = orientation.c[col][row];
         }
-        else
+        return util::Quaternion::FromMatrix(rows);
+    }
+
+    util::Quaternion SphereAimController::GetEngageFrame(const Matrix3f &orientation)
+    {
+        // Right is level unless pointing straight up or down, where the
+        // device's own right axis stands in
+        Vector3f forward = orientation * -Vector3f::UNITZ;
+        Vector3f right(-forward.z, 0.0f, forward.x);
+        if (right.x * right.x + right.z * right.z < 1e-6f)
+            right = Vector3f(orientation.c[0][0], orientation.c[0][1], orientation.c[0][2]);
+        right.Normalize();
+        Vector3f up(right.y * forward.z - right.z * forward.y,
+                    right.z * forward.x - right.x * forward.z,
+                    right.x * forward.y - right.y * forward.x);
+
+        float rows[3][3] = {{right.x, up.x, -forward.x},
+                            {right.y, up.y, -forward.y},
+                            {right.z, up.z, -forward.z}};
+        return util::Quaternion::FromMatrix(rows);
+    }
+
+    Vector2f SphereAimController::GetAimAngles(const Matrix3f &orientation, const util::Quaternion &engageFrame)
+    {
+        // Rotation from the engage frame in its own axes. The twist about
+        // the pointing axis is roll, and the swing left over only depends on
+        // where the device points.
+        util::Quaternion local = engageFrame.Conjugate() * ToQuaternion(orientation);
+        util::Quaternion swing = local * local.GetTwist(0.0f, 0.0f, 1.0f).Conjugate();
+        Vector3f rotation;
+        swing.GetRotationVector(rotation.x, rotation.y, rotation.z);
+
+        // Turning left about up is a negative azimuth change, and pitching
+        // up about right a positive elevation change, so both aim angles
+        // are negated rotations
+        return Vector2f(-Math::ToDegrees(rotation.y), -Math::ToDegrees(rotation.x));
+    }
+
+    Vector2f SphereAimController::UpdateQuaternion()
+    {
+        const Matrix3f &orientation = m_inputDevice->orientation;
+
+        // The sphere isn't cast against here, but keep it for the HUD
+        m_direction = orientation * -Vector3f::UNITZ;
+        m_rayHitPoint = m_center;
+        if (!m_enabled)
         {
-            mouseOffsetPrev = m_mouseOffset;
-            m_outputX->SetValue(0.0f);
-            m_outputY->SetValue(0.0f);
+            m_aimAngles = Vector2f::ZERO;
+            m_aimPosition = Vector2f::ZERO;
+            m_center = m_inputDevice->position - (m_direction * m_centerBias);
+            m_directionOffset = m_direction;
+            m_engageFrame = GetEngageFrame(orientation);
+            return Vector2f::ZERO;
         }
+
+        Vector2f aimAngles = GetAimAngles(orientation, m_engageFrame);
+        Vector2f step = aimAngles - m_aimAngles;
+        m_aimAngles = aimAngles;
+        return step;
     }
 
-}
\ No newline at end of file
+}
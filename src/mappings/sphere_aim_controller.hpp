@@ -2,19 +2,41 @@
 
 #include "vr/actions.hpp"
 #include "mappings/bindings.hpp"
+#include "mappings/response_curve.hpp"
 #include "outputs/outputs.hpp"
 #include "inputs/inputs.hpp"
 #include "vr/device.hpp"
+#include "util/quaternion.hpp"
 #include <cmgMath/cmg_math.h>
 
 namespace mappings
 {
 
+    /// @brief How the aim controller turns device orientation into aim
+    enum class AimMode
+    {
+        /// @brief Azimuth and elevation of the pointing direction relative
+        /// to the engage pose. Azimuth is undefined pointing straight up or
+        /// down, so aim jumps near there.
+        kSphere,
+        /// @brief Rotation from a level frame facing the engage pointing
+        /// direction, with its twist about the pointing axis removed by a
+        /// swing/twist decomposition. Yaw and pitch are the remaining
+        /// swing's components about the frame's up and right axes. Aim
+        /// depends only on where the device points, so roll never moves it,
+        /// and is defined everywhere short of pointing directly behind the
+        /// engage direction. Needs no trig per tick beyond a polynomial
+        /// arctangent.
+        kQuaternion,
+    };
+
+    class AimLateLatch;
+
     class SphereAimController : public BindBase
     {
     public:
         SphereAimController(
-            std::shared_ptr<VrDevice> device,
+            VrDevice *device,
             std::shared_ptr<inputs::Button> enableButton,
             std::shared_ptr<outputs::Analog> outputX,
             std::shared_ptr<outputs::Analog> outputY)
@@ -25,15 +47,46 @@ namespace mappings
         {
         }
 
-        inline void SetInputDevice(
-            std::shared_ptr<VrDevice> inputDevice) { m_inputDevice = inputDevice; }
+        inline void SetInputDevice(VrDevice *inputDevice) { m_inputDevice = inputDevice; }
 
         inline void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+        /// @brief Hand motion over to a late latch on the injection thread.
+        /// The controller keeps deciding when aim is engaged and its gain,
+        /// but no longer outputs motion itself.
+        /// @return false unless both outputs are mouse movement without a
+        /// stream rate. Other outputs can't request a late latch, and the
+        /// latch moves once per batch, so it can't pace streamed motion.
+        bool SetLateLatch(std::shared_ptr<AimLateLatch> latch);
+        inline bool IsLateLatched() const { return m_latch != nullptr; }
+
         virtual void Update() override;
 
+        // Follows the device pose, so stays continuous
+        virtual void GetConnections(std::vector<inputs::InputBase *> &inputs,
+                                    std::vector<outputs::OutputBase *> &outputs) const override
+        {
+            inputs.push_back(m_enableButton.get());
+            outputs.push_back(m_outputX.get());
+            outputs.push_back(m_outputY.get());
+        }
+
+        AimMode m_mode = AimMode::kSphere;
+
+        /// @brief Whether the config asks for late latched aim
+        bool m_lateLatch = false;
+
         float m_radius = 3.0f;
         float m_centerBias = 1.5f;
-        std::shared_ptr<VrDevice> m_inputDevice;
+
+        /// @brief Mouse counts per degree of aim rotation
+        float m_outputScale = 40.0f;
+
+        /// @brief Optional gain applied to the output scale by angular speed
+        /// in degrees per second
+        std::shared_ptr<const ResponseCurve> m_accelerationCurve;
+
+        VrDevice *m_inputDevice = nullptr;
         std::shared_ptr<inputs::Button> m_enableButton;
         std::shared_ptr<outputs::Analog> m_outputX;
         std::shared_ptr<outputs::Analog> m_outputY;
@@ -46,8 +99,29 @@ namespace mappings
         Vector3f m_direction = Vector3f::ZERO;
         Vector3f m_directionOffset = Vector3f::ZERO;
         Vector3f m_rayHitPoint = Vector3f::ZERO;
-        Vector2i m_mouseOffset = Vector2i::ZERO;
+        Vector2f m_aimAngles = Vector2f::ZERO;
+        Vector2f m_aimPosition = Vector2f::ZERO;
+        util::Timestamp m_poseTime;
         Vector3f m_center = Vector3f::ZERO;
+        util::Quaternion m_engageFrame;
+
+        static util::Quaternion ToQuaternion(const Matrix3f &orientation);
+
+        /// @brief Get the level frame facing an orientation's pointing
+        /// direction, which quaternion mode aims relative to
+        static util::Quaternion GetEngageFrame(const Matrix3f &orientation);
+
+        /// @brief Get the aim angles in degrees of an orientation relative
+        /// to an engage frame, as in quaternion mode
+        static Vector2f GetAimAngles(const Matrix3f &orientation, const util::Quaternion &engageFrame);
+
+    private:
+        std::shared_ptr<AimLateLatch> m_latch;
+        std::shared_ptr<outputs::MouseMovement> m_latchOutput;
+
+        /// @brief Get this tick's aim step in degrees
+        Vector2f UpdateSphere();
+        Vector2f UpdateQuaternion();
     };
 
 }
@@ -0,0 +1,258 @@
+#include "outputs/injection_thread.hpp"
+
+#include <algorithm>
+
+#include <cmgCore/cmg_core.h>
+
+namespace outputs
+{
+
+    InjectionThread::InjectionThread(std::shared_ptr<OutputSink> target)
+        : m_target(target)
+    {
+        m_backlog.reserve(kBacklogCapacity);
+    }
+
+    InjectionThread::~InjectionThread()
+    {
+        Stop();
+    }
+
+    void InjectionThread::Start()
+    {
+        if (m_running)
+            return;
+        m_running = true;
+        m_thread = std::thread(&InjectionThread::Run, this);
+    }
+
+    void InjectionThread::Stop()
+    {
+        if (!m_thread.joinable())
+            return;
+
+        // The thread drains the queue before it exits
+        m_running = false;
+        Wake();
+        m_thread.join();
+
+        // Then the backlog goes straight to the target, which nothing else
+        // uses now, instead of waiting for room in the queue
+        bool lateLatch = false;
+        for (const QueuedEvent &queued : m_backlog)
+            Inject(queued, lateLatch);
+        m_backlog.clear();
+    }
+
+    void InjectionThread::Submit(const std::vector<OutputEvent> &events)
+    {
+        if (events.size() > kQueueCapacity)
+        {
+            CMG_LOG_ERROR() << "Dropped output batch of " << events.size()
+                            << " events, larger than the injection queue";
+            m_droppedBatches++;
+            AddReleasesToBacklog(events);
+            return;
+        }
+        // Only held back behind earlier batches, or when the queue is full
+        if (m_backlog.empty() && kQueueCapacity - m_queue.GetSize() >= events.size())
+        {
+            util::Timestamp now = util::Clock::now();
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                TrackHeld(events[i]);
+                m_queue.Push(MakeQueued(events, i, now));
+            }
+            Wake();
+            return;
+        }
+        if (m_backlog.size() + events.size() > kBacklogCapacity)
+        {
+            m_droppedBatches++;
+            AddReleasesToBacklog(events);
+            return;
+        }
+        AddToBacklog(events);
+    }
+
+    void InjectionThread::Flush()
+    {
+        OutputSink::Flush();
+        if (!m_backlog.empty())
+        {
+            QueueBacklog();
+            if (!m_backlog.empty())
+                m_overflows++;
+        }
+        m_maxQueueDepth = std::max(m_maxQueueDepth, m_queue.GetSize());
+    }
+
+    void InjectionThread::QueueBacklog()
+    {
+        // Free space only grows while the consumer runs, so each push is
+        // guaranteed
+        size_t begin = 0;
+        while (begin < m_backlog.size())
+        {
+            size_t end = begin;
+            while (!m_backlog[end].endOfBatch)
+                end++;
+            size_t count = end + 1 - begin;
+            if (kQueueCapacity - m_queue.GetSize() < count)
+                break;
+            for (size_t i = begin; i <= end; i++)
+                m_queue.Push(m_backlog[i]);
+            begin = end + 1;
+        }
+        if (begin > 0)
+        {
+            m_backlog.erase(m_backlog.begin(), m_backlog.begin() + begin);
+            Wake();
+        }
+    }
+
+    void InjectionThread::Wake()
+    {
+        m_wakeCount.fetch_add(1, std::memory_order_release);
+        m_wakeCount.notify_one();
+    }
+
+    InjectionThread::QueuedEvent InjectionThread::MakeQueued(
+        const std::vector<OutputEvent> &events, size_t index, util::Timestamp flushTime)
+    {
+        QueuedEvent queued;
+        queued.event = events[index];
+        queued.endOfBatch = index + 1 == events.size();
+        queued.flushTime = flushTime;
+        return queued;
+    }
+
+    void InjectionThread::AddToBacklog(const std::vector<OutputEvent> &events)
+    {
+        util::Timestamp now = util::Clock::now();
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            TrackHeld(events[i]);
+            m_backlog.push_back(MakeQueued(events, i, now));
+        }
+    }
+
+    void InjectionThread::TrackHeld(const OutputEvent &event)
+    {
+        if (event.type != OutputEvent::Type::kKey && event.type != OutputEvent::Type::kMouseButton)
+            return;
+        auto it = FindHeld(event);
+        if (event.down && it == m_held.end())
+            m_held.push_back(event);
+        else if (!event.down && it != m_held.end())
+            m_held.erase(it);
+    }
+
+    std::vector<OutputEvent>::iterator InjectionThread::FindHeld(const OutputEvent &event)
+    {
+        return std::find_if(m_held.begin(), m_held.end(), [&](const OutputEvent &held)
+                            { return held.type == event.type && held.code == event.code; });
+    }
+
+    void InjectionThread::AddReleasesToBacklog(const std::vector<OutputEvent> &events)
+    {
+        // Presses in the batch are dropped, so only keys held before it
+        // need releasing, once each
+        m_releases.clear();
+        for (const OutputEvent &event : events)
+        {
+            if (event.down || (event.type != OutputEvent::Type::kKey &&
+                               event.type != OutputEvent::Type::kMouseButton))
+                continue;
+            auto it = FindHeld(event);
+            if (it == m_held.end())
+                continue;
+            m_held.erase(it);
+            m_releases.push_back(event);
+        }
+        if (!m_releases.empty())
+            AddToBacklog(m_releases);
+    }
+
+    InjectionStats InjectionThread::GetStats()
+    {
+        InjectionStats stats;
+        stats.batches = m_batches.load(std::memory_order_relaxed);
+        stats.overflows = m_overflows;
+        stats.droppedBatches = m_droppedBatches;
+        stats.queueDepth = m_queue.GetSize();
+        stats.maxQueueDepth = m_maxQueueDepth;
+        m_maxQueueDepth = stats.queueDepth;
+
+        m_latency.Take(stats.averageLatencyUs, stats.maxLatencyUs);
+        m_lateLatchLatency.Take(stats.averageLateLatchUs, stats.maxLateLatchUs);
+        return stats;
+    }
+
+    void InjectionThread::Run()
+    {
+        util::SetCurrentThreadPriorityHigh();
+
+        QueuedEvent queued;
+        bool lateLatch = false;
+        while (true)
+        {
+            // Sample the wake count before draining, so a batch queued after
+            // the queue looks empty wakes the wait below
+            uint32_t wakeCount = m_wakeCount.load(std::memory_order_acquire);
+            while (m_queue.Pop(queued))
+                Inject(queued, lateLatch);
+            if (!m_running.load(std::memory_order_acquire))
+                break;
+            m_wakeCount.wait(wakeCount, std::memory_order_acquire);
+        }
+    }
+
+    void InjectionThread::Inject(const QueuedEvent &queued, bool &lateLatch)
+    {
+        if (queued.event.type == OutputEvent::Type::kLateLatch)
+            lateLatch = true;
+        else
+            m_target->AddEvent(queued.event);
+        if (!queued.endOfBatch)
+            return;
+
+        // Latch as late as possible, right before injecting
+        util::Timestamp latchTime;
+        if (lateLatch && m_lateLatch)
+        {
+            latchTime = util::Clock::now();
+            m_lateLatch->Latch(*m_target);
+        }
+        lateLatch = false;
+        m_target->Flush();
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        util::Timestamp now = util::Clock::now();
+        m_latency.Record(now - queued.flushTime);
+        if (latchTime != util::Timestamp())
+            m_lateLatchLatency.Record(now - latchTime);
+    }
+
+    void InjectionThread::LatencyCounters::Record(util::Clock::duration latency)
+    {
+        uint64_t ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+        sumNs.fetch_add(ns, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        uint64_t oldMaxNs = maxNs.load(std::memory_order_relaxed);
+        while (ns > oldMaxNs &&
+               !maxNs.compare_exchange_weak(oldMaxNs, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void InjectionThread::LatencyCounters::Take(float &averageUs, float &maxUs)
+    {
+        uint64_t takenCount = count.exchange(0, std::memory_order_relaxed);
+        uint64_t takenSumNs = sumNs.exchange(0, std::memory_order_relaxed);
+        uint64_t takenMaxNs = maxNs.exchange(0, std::memory_order_relaxed);
+        averageUs = takenCount > 0 ? static_cast<float>(takenSumNs / takenCount) * 0.001f : 0.0f;
+        maxUs = static_cast<float>(takenMaxNs) * 0.001f;
+    }
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "outputs/late_latch.hpp"
+#include "outputs/output_sink.hpp"
+#include "util/spsc_queue.hpp"
+#include "util/timing.hpp"
+
+namespace outputs
+{
+
+    /// @brief Snapshot of an injection thread's counters
+    struct InjectionStats
+    {
+        /// @brief Batches injected since the thread started
+        uint64_t batches = 0;
+
+        /// @brief Flushes which couldn't queue every batch, since the thread
+        /// started
+        uint64_t overflows = 0;
+
+        /// @brief Batches discarded because the backlog behind a full queue
+        /// was also full, since the thread started. Their releases of held
+        /// keys and buttons are still injected.
+        uint64_t droppedBatches = 0;
+
+        /// @brief Events queued now, and the most seen since the last
+        /// snapshot
+        size_t queueDepth = 0;
+        size_t maxQueueDepth = 0;
+
+        /// @brief Time from flush to the end of injection for batches
+        /// injected since the last snapshot
+        float averageLatencyUs = 0.0f;
+        float maxLatencyUs = 0.0f;
+
+        /// @brief Time from calling the late latch to the end of injection
+        /// for batches late latched since the last snapshot
+        float averageLateLatchUs = 0.0f;
+        float maxLateLatchUs = 0.0f;
+    };
+
+    /// @brief Output sink which hands each batch to a dedicated high
+    /// priority thread through a bounded lock-free queue, so a slow or
+    /// blocking injection call never delays the thread producing output.
+    /// The injection thread replays batches into a target sink unchanged.
+    /// A batch which doesn't fit in the queue is held back and queued ahead
+    /// of later ones on the next flush, so no event (such as a key release)
+    /// is reordered. While nothing is held back, batches go straight into
+    /// the queue. Only when that backlog fills too are new batches
+    /// dropped, so a stalled target can't grow memory without bound. A
+    /// dropped batch still queues its releases of keys and buttons held by
+    /// earlier batches, so nothing is left stuck down; these are bounded by
+    /// the number of keys and buttons.
+    ///
+    /// Batches which ask for late latched motion get it from the late latch
+    /// just before they are flushed to the target.
+    class InjectionThread : public OutputSink
+    {
+    public:
+        static constexpr size_t kQueueCapacity = 1024;
+        static constexpr size_t kBacklogCapacity = 1024;
+
+        explicit InjectionThread(std::shared_ptr<OutputSink> target);
+        virtual ~InjectionThread();
+
+        InjectionThread(const InjectionThread &) = delete;
+        InjectionThread &operator=(const InjectionThread &) = delete;
+
+        /// @brief Set where late latched motion comes from. Must be called
+        /// before Start().
+        inline void SetLateLatch(std::shared_ptr<LateLatch> lateLatch) { m_lateLatch = lateLatch; }
+
+        void Start();
+
+        /// @brief Stop the thread once it has injected everything queued,
+        /// then inject anything held back directly into the target
+        void Stop();
+
+        /// @brief Queue the batch. Must be called from a single producer
+        /// thread.
+        virtual void Flush() override;
+
+        /// @brief Take a snapshot of the counters, starting a new window for
+        /// the windowed ones. Must be called from the producer thread.
+        InjectionStats GetStats();
+
+    protected:
+        virtual void Submit(const std::vector<OutputEvent> &events) override;
+
+    private:
+        struct QueuedEvent
+        {
+            OutputEvent event;
+            bool endOfBatch = false;
+            util::Timestamp flushTime;
+        };
+
+        struct LatencyCounters
+        {
+            std::atomic<uint64_t> sumNs{0};
+            std::atomic<uint64_t> count{0};
+            std::atomic<uint64_t> maxNs{0};
+
+            void Record(util::Clock::duration latency);
+
+            /// @brief Take the average and maximum in microseconds, and reset
+            void Take(float &averageUs, float &maxUs);
+        };
+
+        /// @brief Queue whole batches from the backlog in order while they
+        /// fit, and wake the thread if any were queued
+        void QueueBacklog();
+
+        /// @brief Wake the injection thread to drain the queue
+        void Wake();
+
+        static QueuedEvent MakeQueued(const std::vector<OutputEvent> &events, size_t index,
+                                      util::Timestamp flushTime);
+
+        /// @brief Add a batch to the backlog, and track which keys and
+        /// buttons it leaves held
+        void AddToBacklog(const std::vector<OutputEvent> &events);
+
+        /// @brief Track whether an event leaves a key or button held
+        void TrackHeld(const OutputEvent &event);
+
+        /// @brief Add a batch of only the releases of held keys and buttons
+        /// in a batch which is being dropped
+        void AddReleasesToBacklog(const std::vector<OutputEvent> &events);
+
+        /// @brief Find a held key or button with the same type and code
+        std::vector<OutputEvent>::iterator FindHeld(const OutputEvent &event);
+
+        void Run();
+
+        /// @brief Add a queued event to the target, injecting the batch if
+        /// it's the last one in it
+        void Inject(const QueuedEvent &queued, bool &lateLatch);
+
+        std::shared_ptr<OutputSink> m_target;
+        std::shared_ptr<LateLatch> m_lateLatch;
+        util::SpscQueue<QueuedEvent, kQueueCapacity> m_queue;
+
+        // Owned by the producer
+        std::vector<QueuedEvent> m_backlog;
+        std::vector<OutputEvent> m_held;
+        std::vector<OutputEvent> m_releases;
+        uint64_t m_overflows = 0;
+        uint64_t m_droppedBatches = 0;
+        size_t m_maxQueueDepth = 0;
+
+        // Shared with the injection thread
+        std::thread m_thread;
+        std::atomic<bool> m_running{false};
+        std::atomic<uint32_t> m_wakeCount{0};
+        std::atomic<uint64_t> m_batches{0};
+        LatencyCounters m_latency;
+        LatencyCounters m_lateLatchLatency;
+    };
+
+}
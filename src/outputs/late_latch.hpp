@@ -0,0 +1,22 @@
+#pragma once
+
+#include "outputs/output_sink.hpp"
+
+namespace outputs
+{
+
+    /// @brief Source of motion computed at the last moment before a batch
+    /// is injected, from state sampled then rather than at the start of the
+    /// tick that produced the batch. Batches ask for it with
+    /// OutputSink::AddLateLatch().
+    class LateLatch
+    {
+    public:
+        virtual ~LateLatch() {}
+
+        /// @brief Add motion to a batch about to be injected. Called on the
+        /// injection thread, once per batch which asked for it.
+        virtual void Latch(OutputSink &sink) = 0;
+    };
+
+}
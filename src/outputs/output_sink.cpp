@@ -0,0 +1,74 @@
+#include "outputs/output_sink.hpp"
+
+namespace outputs
+{
+
+    void OutputSink::AddKey(int32_t scanCode, bool down)
+    {
+        OutputEvent event;
+        event.type = OutputEvent::Type::kKey;
+        event.down = down;
+        event.code = scanCode;
+        m_batch.push_back(event);
+    }
+
+    void OutputSink::AddMouseButton(MouseButtons::value_type button, bool down)
+    {
+        OutputEvent event;
+        event.type = OutputEvent::Type::kMouseButton;
+        event.down = down;
+        event.code = static_cast<int32_t>(button);
+        m_batch.push_back(event);
+    }
+
+    void OutputSink::AddMouseWheel(int32_t delta)
+    {
+        OutputEvent event;
+        event.type = OutputEvent::Type::kMouseWheel;
+        event.code = delta;
+        m_batch.push_back(event);
+    }
+
+    void OutputSink::AddMouseMove(int32_t dx, int32_t dy)
+    {
+        if (m_moveIndex == kNoMove)
+        {
+            m_moveIndex = m_batch.size();
+            OutputEvent event;
+            event.type = OutputEvent::Type::kMouseMove;
+            m_batch.push_back(event);
+        }
+        m_batch[m_moveIndex].dx += dx;
+        m_batch[m_moveIndex].dy += dy;
+    }
+
+    void OutputSink::AddLateLatch()
+    {
+        if (m_lateLatch)
+            return;
+        m_lateLatch = true;
+        OutputEvent event;
+        event.type = OutputEvent::Type::kLateLatch;
+        m_batch.push_back(event);
+    }
+
+    void OutputSink::AddEvent(const OutputEvent &event)
+    {
+        if (event.type == OutputEvent::Type::kMouseMove)
+            AddMouseMove(event.dx, event.dy);
+        else if (event.type == OutputEvent::Type::kLateLatch)
+            AddLateLatch();
+        else
+            m_batch.push_back(event);
+    }
+
+    void OutputSink::Flush()
+    {
+        if (!m_batch.empty())
+            Submit(m_batch);
+        m_batch.clear();
+        m_moveIndex = kNoMove;
+        m_lateLatch = false;
+    }
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmgInput/cmg_input.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace outputs
+{
+
+    /// @brief A keyboard or mouse event to inject
+    struct OutputEvent
+    {
+        enum class Type : uint8_t
+        {
+            kKey,
+            kMouseButton,
+            kMouseWheel,
+            kMouseMove,
+            /// @brief Request for late latched motion, which the injection
+            /// thread replaces with motion sampled just before injecting
+            kLateLatch,
+        };
+
+        Type type = Type::kKey;
+
+        // kKey, kMouseButton
+        bool down = false;
+
+        // Scan code for kKey, MouseButtons value for kMouseButton, and
+        // wheel delta for kMouseWheel
+        int32_t code = 0;
+
+        // kMouseMove
+        int32_t dx = 0;
+        int32_t dy = 0;
+    };
+
+    /// @brief Destination for injected output events. Outputs add their
+    /// events during the tick, and Flush() submits them as one batch, with
+    /// all mouse motion merged into a single event in the position of the
+    /// first. The base sink discards batches, for running without
+    /// injection.
+    class OutputSink
+    {
+    public:
+        virtual ~OutputSink() {}
+
+        void AddKey(int32_t scanCode, bool down);
+        void AddMouseButton(MouseButtons::value_type button, bool down);
+        void AddMouseWheel(int32_t delta);
+        void AddMouseMove(int32_t dx, int32_t dy);
+
+        /// @brief Request late latched motion in this batch, once however
+        /// many times it is called
+        void AddLateLatch();
+
+        /// @brief Add an event of any type, merging motion as above
+        void AddEvent(const OutputEvent &event);
+
+        /// @brief Submit the events added since the last flush, if any
+        virtual void Flush();
+
+        /// @brief Events added since the last flush
+        inline const std::vector<OutputEvent> &GetBatch() const { return m_batch; }
+
+    protected:
+        /// @brief Inject a non-empty batch of events, in order
+        virtual void Submit(const std::vector<OutputEvent> &events) {}
+
+    private:
+        static constexpr size_t kNoMove = SIZE_MAX;
+
+        std::vector<OutputEvent> m_batch;
+        size_t m_moveIndex = kNoMove;
+        bool m_lateLatch = false;
+    };
+
+}
@@ -1,107 +1,191 @@
 #include "outputs/outputs.hpp"
-#include <Windows.h>
+
+#include <algorithm>
 
 namespace outputs
 {
 
+    void OutputBase::RecordLatency()
+    {
+        util::Timestamp timestamp = GetTimestamp();
+        if (timestamp == util::Timestamp())
+            return;
+        m_lastLatencyMs = std::chrono::duration<float, std::milli>(
+                              util::Clock::now() - timestamp)
+                              .count();
+    }
+
 	void Button::PreUpdate()
 	{
 		m_downPrev = m_down;
 		m_down = false;
+        m_downTime = util::Timestamp::max();
+        m_upTime = util::Timestamp();
 	}
 
-    void Button::Update()
+    void Button::SetState(bool state, util::Timestamp timestamp)
+    {
+        if (state)
+        {
+            m_down = true;
+            if (timestamp < m_downTime)
+                m_downTime = timestamp;
+        }
+        else if (timestamp > m_upTime)
+        {
+            m_upTime = timestamp;
+        }
+    }
+
+    util::Timestamp Button::GetTimestamp() const
+    {
+        if (IsPressed())
+            return m_downTime;
+        if (IsReleased())
+            return m_upTime;
+        return util::Timestamp();
+    }
+
+    void Button::Update(OutputSink &sink)
     {
         if (IsPressed())
-            OnPressed();
+        {
+            RecordLatency();
+            OnPressed(sink);
+        }
         if (IsReleased())
-            OnReleased();
+        {
+            RecordLatency();
+            OnReleased(sink);
+        }
     }
 
     void Analog::PreUpdate()
     {
         m_value = 0.0f;
+        m_timestamp = util::Timestamp();
+    }
+
+    void KeyboardKey::OnPressed(OutputSink &sink)
+    {
+        sink.AddKey(scanCode, true);
     }
 
-    void KeyboardKey::OnPressed()
+    void KeyboardKey::OnReleased(OutputSink &sink)
     {
-        INPUT ip;
-        ip.type = INPUT_KEYBOARD;
-        ip.ki.wScan = 0;
-        ip.ki.time = 0;
-        ip.ki.dwExtraInfo = 0;
-        ip.ki.wVk = 0;
-        ip.ki.wScan = scanCode;
-        ip.ki.dwFlags = KEYEVENTF_SCANCODE;
-        SendInput(1, &ip, sizeof(INPUT));
+        sink.AddKey(scanCode, false);
     }
 
-    void KeyboardKey::OnReleased()
+    void MouseButton::OnPressed(OutputSink &sink)
     {
-        INPUT ip;
-        ip.type = INPUT_KEYBOARD;
-        ip.ki.wScan = 0;
-        ip.ki.time = 0;
-        ip.ki.dwExtraInfo = 0;
-        ip.ki.wVk = 0;
-        ip.ki.wScan = scanCode;
-        ip.ki.dwFlags = KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP;
-        SendInput(1, &ip, sizeof(INPUT));
+        sink.AddMouseButton(button, true);
     }
 
-    void MouseButton::OnPressed()
+    void MouseButton::OnReleased(OutputSink &sink)
     {
-        INPUT input;
-        input.type = INPUT_MOUSE;
-        input.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-        if (button == MouseButtons::right)
-            input.mi.dwFlags = MOUSEEVENTF_RIGHTDOWN;
-        else if (button == MouseButtons::middle)
-            input.mi.dwFlags = MOUSEEVENTF_MIDDLEDOWN;
-        SendInput(1, &input, sizeof(INPUT));
+        sink.AddMouseButton(button, false);
     }
 
-    void MouseButton::OnReleased()
+    void MouseWheelButton::OnPressed(OutputSink &sink)
     {
-        INPUT input;
-        input.type = INPUT_MOUSE;
-        input.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        if (button == MouseButtons::right)
-            input.mi.dwFlags = MOUSEEVENTF_RIGHTUP;
-        else if (button == MouseButtons::middle)
-            input.mi.dwFlags = MOUSEEVENTF_MIDDLEUP;
-        SendInput(1, &input, sizeof(INPUT));
+        sink.AddMouseWheel(positive ? 1 : -1);
     }
 
-    void MouseWheelButton::OnPressed()
+    MouseMovement::~MouseMovement()
     {
-        INPUT input;
-        input.type = INPUT_MOUSE;
-        input.mi.dwFlags = MOUSEEVENTF_WHEEL;
-        input.mi.mouseData = positive ? 1 : -1;
-        input.mi.dx = 0;
-        input.mi.dy = 0;
-        input.mi.time = 0;
-        input.mi.dwExtraInfo = 0;
-        SendInput(1, &input, sizeof(INPUT));
+        if (m_timer != util::TimerWheel::kInvalidTimer)
+            m_timers->Cancel(m_timer);
     }
 
-    void MouseMovement::Update()
+    void MouseMovement::SetStreamRate(float rate, std::shared_ptr<util::TimerWheel> timers)
     {
-        LONG intValue = static_cast<LONG>(m_value);
-        if (intValue == 0)
+        if (m_timer != util::TimerWheel::kInvalidTimer)
+            m_timers->Cancel(m_timer);
+        m_timer = util::TimerWheel::kInvalidTimer;
+        m_timers = timers;
+        m_stepInterval = rate > 0.0f ? util::SecondsToDuration(1.0f / rate) : util::Clock::duration::zero();
+        m_motionInterval = m_stepInterval;
+    }
+
+    bool MouseMovement::HasPendingEvent() const
+    {
+        // Motion of under a count is still pending, to be carried
+        return m_value != 0.0f || m_stepDue || m_lateLatch;
+    }
+
+    void MouseMovement::Update(OutputSink &sink)
+    {
+        if (m_lateLatch)
+        {
+            sink.AddLateLatch();
+            m_lateLatch = false;
+        }
+
+        if (m_stepInterval == util::Clock::duration::zero())
+        {
+            Move(sink, m_value);
             return;
-        INPUT input;
-        input.type = INPUT_MOUSE;
-        input.mi.dx = m_axis == 0 ? intValue : 0;
-        input.mi.dy = m_axis == 1 ? intValue : 0;
-        input.mi.mouseData = 0;
-        input.mi.dwFlags = MOUSEEVENTF_MOVE;
-        input.mi.time = 0;
-        input.mi.dwExtraInfo = 0;
-        SendInput(1, &input, sizeof(INPUT));
-
-		Analog::Update();
-	}
+        }
+
+        util::Timestamp now = util::Clock::now();
+        if (m_value != 0.0f)
+        {
+            // Spread the motion left over and the new motion across the time
+            // until the next is expected, judged by the gap before this one
+            if (m_motionTime != util::Timestamp())
+            {
+                util::Clock::duration gap = now - m_motionTime;
+                if (gap <= kMaxStreamWindow)
+                    m_motionInterval += (std::max(gap, m_stepInterval) - m_motionInterval) / 4;
+            }
+            m_motionTime = now;
+            m_streamRemaining += m_value;
+            m_stepsLeft = static_cast<uint32_t>(std::max<util::Clock::rep>(
+                1, m_motionInterval.count() / m_stepInterval.count()));
+
+            // Start right away unless a micro-move is already scheduled
+            if (m_timer == util::TimerWheel::kInvalidTimer)
+            {
+                m_stepDue = true;
+                m_stepTime = now;
+            }
+        }
+        if (m_stepDue)
+            Step(sink, m_stepTime);
+    }
+
+    void MouseMovement::Step(OutputSink &sink, util::Timestamp time)
+    {
+        m_stepDue = false;
+        if (m_stepsLeft == 0)
+            return;
+        float amount = m_streamRemaining / m_stepsLeft;
+        m_stepsLeft--;
+        m_streamRemaining = m_stepsLeft > 0 ? m_streamRemaining - amount : 0.0f;
+        Move(sink, amount);
+
+        // Pace from the previous deadline, but never schedule into the past
+        // and burst to catch up after a late tick
+        if (m_stepsLeft > 0)
+            m_timer = m_timers->Schedule(std::max(time + m_stepInterval, util::Clock::now()), this);
+    }
+
+    void MouseMovement::OnTimer(uint32_t cookie, util::Timestamp deadline)
+    {
+        m_timer = util::TimerWheel::kInvalidTimer;
+        m_stepDue = true;
+        m_stepTime = deadline;
+    }
+
+    void MouseMovement::Move(OutputSink &sink, float amount)
+    {
+        m_residual += amount;
+        int32_t count = static_cast<int32_t>(m_residual);
+        m_residual -= static_cast<float>(count);
+        if (count == 0)
+            return;
+        RecordLatency();
+        sink.AddMouseMove(m_axis == 0 ? count : 0, m_axis == 1 ? count : 0);
+    }
 
 }
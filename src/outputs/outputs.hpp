@@ -2,6 +2,10 @@
 
 #include <cmgInput/cmg_input.h>
 
+#include "outputs/output_sink.hpp"
+#include "util/timer_wheel.hpp"
+#include "util/timing.hpp"
+
 namespace outputs
 {
 
@@ -19,10 +23,27 @@ namespace outputs
         }
 
 		virtual void PreUpdate() {}
-		virtual void Update() {}
+
+        /// @brief Add this tick's events to the sink
+		virtual void Update(OutputSink &sink) {}
+
+        /// @brief Whether Update() will inject anything this tick
+        virtual bool HasPendingEvent() const { return false; }
+
+        /// @brief Time of the hardware input change behind the pending event
+        virtual util::Timestamp GetTimestamp() const { return m_timestamp; }
+
+        /// @brief Time from the hardware input change to injection of the
+        /// most recent event, in milliseconds
+        inline float GetLastLatencyMs() const { return m_lastLatencyMs; }
 
     protected:
+        /// @brief Record the latency of an event being injected now
+        void RecordLatency();
+
         std::string m_name;
+        util::Timestamp m_timestamp;
+        float m_lastLatencyMs = 0.0f;
     };
 
     /// @brief Base class for binary/digital button outputs
@@ -33,36 +54,56 @@ namespace outputs
         bool IsPressed() const { return m_down && !m_downPrev; }
         bool IsReleased() const { return !m_down && m_downPrev; }
 
-        void SetState(bool state) { m_down = m_down || state; }
+        /// @brief Contribute to the output state for this tick. The output is
+        /// down if any contribution is down.
+        /// @param timestamp time of the input change behind the contribution
+        void SetState(bool state, util::Timestamp timestamp = util::Timestamp());
 		 
-        virtual void OnPressed() {}
-        virtual void OnReleased() {}
+        virtual void OnPressed(OutputSink &sink) {}
+        virtual void OnReleased(OutputSink &sink) {}
 		virtual void PreUpdate() override;
-		virtual void Update() override;
+		virtual void Update(OutputSink &sink) override;
+        virtual bool HasPendingEvent() const override { return IsPressed() || IsReleased(); }
+        virtual util::Timestamp GetTimestamp() const override;
 
         virtual std::ostream &DebugString(std::ostream &stream) const
         {
-            stream << m_name << ": " << (m_down ? "DOWN" : "UP");
+            stream << m_name << ": " << (m_down ? "DOWN" : "UP")
+                   << " (" << m_lastLatencyMs << " ms)";
             return stream;
         }
 
     protected:
         bool m_down = false;
         bool m_downPrev = false;
+
+        // A press is caused by the earliest down contribution, a release by
+        // the latest up contribution
+        util::Timestamp m_downTime;
+        util::Timestamp m_upTime;
     };
 
     /// @brief Base class for analog outputs with a single float value
     class Analog : public OutputBase
     {
     public:
-        inline virtual float GetValue() const { return m_value; }
-        inline virtual void SetValue(float value) { m_value += value; }
+        inline float GetValue() const { return m_value; }
+
+        /// @brief Add a contribution to the output value for this tick
+        /// @param timestamp time of the input change behind the contribution
+        inline void SetValue(float value, util::Timestamp timestamp = util::Timestamp())
+        {
+            m_value += value;
+            if (timestamp > m_timestamp)
+                m_timestamp = timestamp;
+        }
 
 		virtual void PreUpdate() override;
+        virtual bool HasPendingEvent() const override { return m_value != 0.0f; }
 
 		virtual std::ostream &DebugString(std::ostream &stream) const
 		{
-			stream << m_name << ": " << m_value;
+			stream << m_name << ": " << m_value << " (" << m_lastLatencyMs << " ms)";
 			return stream;
 		}
 
@@ -76,8 +117,8 @@ namespace outputs
     public:
         KeyboardKey(int32_t scanCode) : scanCode(scanCode) {}
 
-        virtual void OnPressed() override;
-        virtual void OnReleased() override;
+        virtual void OnPressed(OutputSink &sink) override;
+        virtual void OnReleased(OutputSink &sink) override;
 
         int32_t scanCode = 0;
     };
@@ -88,8 +129,8 @@ namespace outputs
     public:
         MouseButton(MouseButtons::value_type button) : button(button) {}
 
-        virtual void OnPressed() override;
-        virtual void OnReleased() override;
+        virtual void OnPressed(OutputSink &sink) override;
+        virtual void OnReleased(OutputSink &sink) override;
 
         MouseButtons::value_type button = MouseButtons::left;
     };
@@ -100,21 +141,67 @@ namespace outputs
     public:
         MouseWheelButton(bool positive) : positive(positive) {}
 
-        virtual void OnPressed() override;
+        virtual void OnPressed(OutputSink &sink) override;
 
         bool positive = true;
     };
 
-    /// @brief Analog output which moves the mouse cursor along the X or Y axis
-    class MouseMovement : public Analog
+    /// @brief Analog output which moves the mouse cursor along the X or Y
+    /// axis. The fraction of a count left over each tick is carried into the
+    /// next, so slow movement isn't lost to truncation.
+    ///
+    /// With a stream rate set, motion is instead spread evenly over the time
+    /// until more is expected, in micro-moves at that rate, so the game sees
+    /// a smooth stream rather than a jump each time a new pose arrives.
+    class MouseMovement : public Analog, public util::TimerListener
     {
     public:
         MouseMovement(size_t axis) : m_axis(axis) {}
+        virtual ~MouseMovement();
+
+        /// @brief Stream motion in micro-moves paced by a timer wheel
+        /// @param rate micro-moves per second, or 0 to move once per tick
+        void SetStreamRate(float rate, std::shared_ptr<util::TimerWheel> timers);
+
+        /// @brief Ask the injection thread for late latched motion this tick
+        inline void RequestLateLatch() { m_lateLatch = true; }
+
+        /// @brief Mouse axis moved: 0 for x, 1 for y
+        inline size_t GetAxis() const { return m_axis; }
+
+        /// @brief Whether motion is streamed in paced micro-moves
+        inline bool IsStreamed() const { return m_stepInterval != util::Clock::duration::zero(); }
 
-        virtual void Update() override;
+        virtual void Update(OutputSink &sink) override;
+        virtual bool HasPendingEvent() const override;
 
     private:
+        // Longest gap between motion updates which is spread over, beyond
+        // which motion is treated as starting afresh
+        static constexpr util::Clock::duration kMaxStreamWindow = std::chrono::milliseconds(50);
+
+        /// @brief Move by an amount, carrying the fraction of a count
+        void Move(OutputSink &sink, float amount);
+
+        /// @brief Take the next micro-move of the motion being streamed
+        void Step(OutputSink &sink, util::Timestamp time);
+
+        virtual void OnTimer(uint32_t cookie, util::Timestamp deadline) override;
+
         size_t m_axis = 0;
+        float m_residual = 0.0f;
+        bool m_lateLatch = false;
+
+        // Streaming
+        std::shared_ptr<util::TimerWheel> m_timers;
+        util::TimerWheel::TimerId m_timer = util::TimerWheel::kInvalidTimer;
+        util::Clock::duration m_stepInterval = util::Clock::duration::zero();
+        util::Clock::duration m_motionInterval = util::Clock::duration::zero();
+        util::Timestamp m_motionTime;
+        util::Timestamp m_stepTime;
+        float m_streamRemaining = 0.0f;
+        uint32_t m_stepsLeft = 0;
+        bool m_stepDue = false;
     };
 
 }
\ No newline at end of file
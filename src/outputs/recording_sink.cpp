@@ -0,0 +1,25 @@
+#include "outputs/recording_sink.hpp"
+
+namespace outputs
+{
+
+    const OutputEvent *RecordingSink::GetBatch(size_t batch, size_t &count) const
+    {
+        size_t begin = batch == 0 ? 0 : m_batchEnds[batch - 1];
+        count = m_batchEnds[batch] - begin;
+        return m_events.data() + begin;
+    }
+
+    void RecordingSink::Clear()
+    {
+        m_events.clear();
+        m_batchEnds.clear();
+    }
+
+    void RecordingSink::Submit(const std::vector<OutputEvent> &events)
+    {
+        m_events.insert(m_events.end(), events.begin(), events.end());
+        m_batchEnds.push_back(m_events.size());
+    }
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "outputs/output_sink.hpp"
+
+namespace outputs
+{
+
+    /// @brief Keeps every submitted batch in memory instead of injecting it,
+    /// for checking and benchmarking output without touching the desktop
+    class RecordingSink : public OutputSink
+    {
+    public:
+        /// @brief Every event submitted, in order
+        inline const std::vector<OutputEvent> &GetEvents() const { return m_events; }
+
+        inline size_t GetBatchCount() const { return m_batchEnds.size(); }
+
+        /// @brief Events of one submitted batch
+        /// @param count receives the number of events in the batch
+        const OutputEvent *GetBatch(size_t batch, size_t &count) const;
+
+        void Clear();
+
+    protected:
+        virtual void Submit(const std::vector<OutputEvent> &events) override;
+
+    private:
+        std::vector<OutputEvent> m_events;
+        std::vector<size_t> m_batchEnds;
+    };
+
+}
@@ -0,0 +1,92 @@
+#include "outputs/send_input_sink.hpp"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+
+namespace outputs
+{
+
+#if defined(_WIN32)
+
+    struct SendInputSink::InputBuffer
+    {
+        std::vector<INPUT> inputs;
+    };
+
+    namespace
+    {
+        DWORD GetMouseButtonFlags(int32_t button, bool down)
+        {
+            if (button == MouseButtons::right)
+                return down ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP;
+            if (button == MouseButtons::middle)
+                return down ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP;
+            return down ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+        }
+    }
+
+    void SendInputSink::Submit(const std::vector<OutputEvent> &events)
+    {
+        std::vector<INPUT> &inputs = m_buffer->inputs;
+        inputs.resize(events.size());
+        size_t count = 0;
+        for (const OutputEvent &event : events)
+        {
+            // Without an injection thread to latch it, there's no motion
+            if (event.type == OutputEvent::Type::kLateLatch)
+                continue;
+
+            INPUT &input = inputs[count++];
+            ZeroMemory(&input, sizeof(INPUT));
+            switch (event.type)
+            {
+            case OutputEvent::Type::kKey:
+                input.type = INPUT_KEYBOARD;
+                input.ki.wScan = static_cast<WORD>(event.code);
+                input.ki.dwFlags = KEYEVENTF_SCANCODE;
+                if (!event.down)
+                    input.ki.dwFlags |= KEYEVENTF_KEYUP;
+                break;
+            case OutputEvent::Type::kMouseButton:
+                input.type = INPUT_MOUSE;
+                input.mi.dwFlags = GetMouseButtonFlags(event.code, event.down);
+                break;
+            case OutputEvent::Type::kMouseWheel:
+                input.type = INPUT_MOUSE;
+                input.mi.dwFlags = MOUSEEVENTF_WHEEL;
+                input.mi.mouseData = static_cast<DWORD>(event.code);
+                break;
+            case OutputEvent::Type::kMouseMove:
+                input.type = INPUT_MOUSE;
+                input.mi.dwFlags = MOUSEEVENTF_MOVE;
+                input.mi.dx = event.dx;
+                input.mi.dy = event.dy;
+                break;
+            case OutputEvent::Type::kLateLatch:
+                break;
+            }
+        }
+        if (count > 0)
+            SendInput(static_cast<UINT>(count), inputs.data(), sizeof(INPUT));
+    }
+
+#else
+
+    struct SendInputSink::InputBuffer
+    {
+    };
+
+    void SendInputSink::Submit(const std::vector<OutputEvent> &events) {}
+
+#endif
+
+    SendInputSink::SendInputSink() : m_buffer(std::make_unique<InputBuffer>())
+    {
+    }
+
+    SendInputSink::~SendInputSink()
+    {
+    }
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+
+#include "outputs/output_sink.hpp"
+
+namespace outputs
+{
+
+    /// @brief Injects each batch into the Windows input stream with a single
+    /// SendInput() call. Elsewhere batches are discarded.
+    class SendInputSink : public OutputSink
+    {
+    public:
+        SendInputSink();
+        virtual ~SendInputSink();
+
+    protected:
+        virtual void Submit(const std::vector<OutputEvent> &events) override;
+
+    private:
+        // INPUT array reused between batches
+        struct InputBuffer;
+        std::unique_ptr<InputBuffer> m_buffer;
+    };
+
+}
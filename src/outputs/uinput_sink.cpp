@@ -0,0 +1,174 @@
+#include "outputs/uinput_sink.hpp"
+
+#include <cmgCore/cmg_core.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace outputs
+{
+
+    UinputSink::~UinputSink()
+    {
+        Close();
+    }
+
+    int UinputSink::ScanCodeToKeyCode(int32_t scanCode)
+    {
+        // Evdev key codes up to KEY_F12 were chosen to match set 1 make
+        // codes, apart from two unused codes
+        if (scanCode >= 1 && scanCode <= 88 && scanCode != 84 && scanCode != 85)
+            return scanCode;
+        return -1;
+    }
+
+#if defined(__linux__)
+
+    bool UinputSink::Open(const std::string &path)
+    {
+        Close();
+        // Blocking, so a full event queue delays a frame rather than losing it
+        int fd = open(path.c_str(), O_WRONLY);
+        if (fd < 0)
+        {
+            CMG_LOG_ERROR() << "Failed to open " << path << ": " << std::strerror(errno);
+            return false;
+        }
+
+        bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) >= 0 &&
+                  ioctl(fd, UI_SET_EVBIT, EV_REL) >= 0 &&
+                  ioctl(fd, UI_SET_EVBIT, EV_SYN) >= 0;
+        for (int32_t scanCode = 1; ok && scanCode <= 88; scanCode++)
+        {
+            int keyCode = ScanCodeToKeyCode(scanCode);
+            if (keyCode >= 0)
+                ok = ioctl(fd, UI_SET_KEYBIT, keyCode) >= 0;
+        }
+        for (int code : {BTN_LEFT, BTN_RIGHT, BTN_MIDDLE})
+            ok = ok && ioctl(fd, UI_SET_KEYBIT, code) >= 0;
+        for (int code : {REL_X, REL_Y, REL_WHEEL})
+            ok = ok && ioctl(fd, UI_SET_RELBIT, code) >= 0;
+
+        uinput_setup setup;
+        std::memset(&setup, 0, sizeof(setup));
+        setup.id.bustype = BUS_VIRTUAL;
+        setup.id.vendor = 0x1209;
+        setup.id.product = 0xdd01;
+        std::strncpy(setup.name, "Dandy VR Remap", UINPUT_MAX_NAME_SIZE - 1);
+        ok = ok && ioctl(fd, UI_DEV_SETUP, &setup) >= 0 &&
+             ioctl(fd, UI_DEV_CREATE) >= 0;
+        if (!ok)
+        {
+            CMG_LOG_ERROR() << "Failed to create uinput device: " << std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        m_fd = fd;
+        return true;
+    }
+
+    void UinputSink::Close()
+    {
+        if (m_fd < 0)
+            return;
+        ioctl(m_fd, UI_DEV_DESTROY);
+        close(m_fd);
+        m_fd = -1;
+    }
+
+    void UinputSink::Submit(const std::vector<OutputEvent> &events)
+    {
+        if (m_fd < 0)
+            return;
+
+        // The kernel stamps event times itself
+        m_frame.clear();
+        auto add = [this](uint16_t type, uint16_t code, int32_t value)
+        {
+            input_event event;
+            std::memset(&event, 0, sizeof(event));
+            event.type = type;
+            event.code = code;
+            event.value = value;
+            m_frame.push_back(event);
+        };
+        for (const OutputEvent &event : events)
+        {
+            switch (event.type)
+            {
+            case OutputEvent::Type::kKey:
+            {
+                int keyCode = ScanCodeToKeyCode(event.code);
+                if (keyCode >= 0)
+                    add(EV_KEY, static_cast<uint16_t>(keyCode), event.down ? 1 : 0);
+                break;
+            }
+            case OutputEvent::Type::kMouseButton:
+            {
+                uint16_t code = BTN_LEFT;
+                if (event.code == MouseButtons::right)
+                    code = BTN_RIGHT;
+                else if (event.code == MouseButtons::middle)
+                    code = BTN_MIDDLE;
+                add(EV_KEY, code, event.down ? 1 : 0);
+                break;
+            }
+            case OutputEvent::Type::kMouseWheel:
+                add(EV_REL, REL_WHEEL, event.code);
+                break;
+            case OutputEvent::Type::kMouseMove:
+                if (event.dx != 0)
+                    add(EV_REL, REL_X, event.dx);
+                if (event.dy != 0)
+                    add(EV_REL, REL_Y, event.dy);
+                break;
+            case OutputEvent::Type::kLateLatch:
+                // Without an injection thread to latch it, there's no motion
+                break;
+            }
+        }
+        if (m_frame.empty())
+            return;
+        add(EV_SYN, SYN_REPORT, 0);
+
+        // Write the rest of the frame after a short or interrupted write,
+        // so no event in it is lost, key releases included
+        const char *data = reinterpret_cast<const char *>(m_frame.data());
+        size_t size = m_frame.size() * sizeof(input_event);
+        while (size > 0)
+        {
+            ssize_t written = write(m_fd, data, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                CMG_LOG_ERROR() << "Failed to write uinput events: " << std::strerror(errno);
+                return;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+#else
+
+    bool UinputSink::Open(const std::string &path)
+    {
+        CMG_LOG_ERROR() << "uinput is only available on Linux";
+        return false;
+    }
+
+    void UinputSink::Close() {}
+
+    void UinputSink::Submit(const std::vector<OutputEvent> &events) {}
+
+#endif
+
+}
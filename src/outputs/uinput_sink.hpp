@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "outputs/output_sink.hpp"
+
+#if defined(__linux__)
+#include <linux/input.h>
+#endif
+
+namespace outputs
+{
+
+    /// @brief Injects batches through a virtual keyboard and mouse created
+    /// with Linux uinput, for games running under Proton. Each batch is
+    /// written in one call and ends with a single SYN_REPORT, so the kernel
+    /// delivers its motion and buttons as one atomic frame. Elsewhere the
+    /// device can't be opened.
+    class UinputSink : public OutputSink
+    {
+    public:
+        UinputSink() {}
+        virtual ~UinputSink();
+
+        UinputSink(const UinputSink &) = delete;
+        UinputSink &operator=(const UinputSink &) = delete;
+
+        /// @brief Create the virtual device, destroying any previous one
+        /// @return false if uinput could not be opened or set up
+        bool Open(const std::string &path = "/dev/uinput");
+        void Close();
+
+        inline bool IsOpen() const { return m_fd >= 0; }
+
+        /// @brief Convert a set 1 scan code, as loaded for keyboard outputs,
+        /// to an evdev key code
+        /// @return the key code, or -1 if it has none
+        static int ScanCodeToKeyCode(int32_t scanCode);
+
+    protected:
+        virtual void Submit(const std::vector<OutputEvent> &events) override;
+
+    private:
+        int m_fd = -1;
+#if defined(__linux__)
+        // Frame of raw events reused between batches
+        std::vector<input_event> m_frame;
+#endif
+    };
+
+}
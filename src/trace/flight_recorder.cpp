@@ -0,0 +1,160 @@
+#include "trace/flight_recorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "trace/trace_codec.hpp"
+
+namespace trace
+{
+
+    namespace
+    {
+        inline int32_t GetAgeUs(util::Timestamp changeTime, util::Timestamp tickTime)
+        {
+            int64_t age = std::chrono::duration_cast<std::chrono::microseconds>(changeTime - tickTime).count();
+            age = std::max<int64_t>(age, std::numeric_limits<int32_t>::min());
+            age = std::min<int64_t>(age, std::numeric_limits<int32_t>::max());
+            return static_cast<int32_t>(age);
+        }
+    }
+
+    Error WriteTraceFile(const std::string &path, const Capture &capture)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+            return CMG_ERROR(Error::kFileNotFound);
+
+        std::vector<char> strings;
+        for (auto names : {&capture.digitalNames, &capture.analogNames})
+        {
+            for (const std::string &name : *names)
+                strings.insert(strings.end(), name.c_str(), name.c_str() + name.size() + 1);
+        }
+
+        std::vector<SegmentRecord> index;
+        uint64_t offset = 0;
+        uint64_t tickCount = 0;
+        for (const Segment &segment : capture.segments)
+        {
+            SegmentRecord record = {};
+            record.offset = offset;
+            record.size = segment.data.size();
+            record.firstTick = segment.firstTick;
+            record.tickCount = segment.tickCount;
+            index.push_back(record);
+            offset += segment.data.size();
+            tickCount += segment.tickCount;
+        }
+
+        FileHeader header = {};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.digitalCount = static_cast<uint32_t>(capture.digitalNames.size());
+        header.analogCount = static_cast<uint32_t>(capture.analogNames.size());
+        header.segmentCount = static_cast<uint32_t>(index.size());
+        header.tickCount = tickCount;
+        header.deviceTableOffset = sizeof(FileHeader);
+        header.stringTableOffset = header.deviceTableOffset + sizeof(DeviceTable);
+        header.stringTableSize = strings.size();
+        header.segmentIndexOffset = header.stringTableOffset + header.stringTableSize;
+        header.dataOffset = header.segmentIndexOffset + index.size() * sizeof(SegmentRecord);
+        header.dataSize = offset;
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(capture.devices.data()), sizeof(DeviceTable));
+        file.write(strings.data(), strings.size());
+        file.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(SegmentRecord));
+        for (const Segment &segment : capture.segments)
+            file.write(reinterpret_cast<const char *>(segment.data.data()), segment.data.size());
+        if (!file)
+            return CMG_ERROR(Error::kFileCorrupt);
+
+        CMG_LOG_INFO() << "Wrote trace: " << path << " (" << tickCount << " ticks, "
+                       << (offset / 1024) << " KiB)";
+        return CMG_ERROR_SUCCESS;
+    }
+
+    FlightRecorder::FlightRecorder(const ActionStateTable &table, uint32_t segmentTicks, size_t maxSegments)
+        : m_table(table), m_segmentTicks(std::max<uint32_t>(segmentTicks, 1)),
+          m_maxSegments(std::max<size_t>(maxSegments, 1))
+    {
+        m_frame.Reset(table.GetDigitalCount(), table.GetAnalogCount());
+        m_previousFrame.Reset(table.GetDigitalCount(), table.GetAnalogCount());
+    }
+
+    void FlightRecorder::Record(const DeviceRegistry::PoseArray &poses,
+                                const std::vector<vr::TrackedDeviceIndex_t> &activeIndices,
+                                util::Timestamp tickTime)
+    {
+        if (m_tickCount == 0)
+            m_startTime = tickTime;
+
+        // Snapshot this tick's state
+        Frame &frame = m_frame;
+        frame.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(tickTime - m_startTime).count();
+        for (size_t slot = 0; slot < frame.digitalDown.size(); slot++)
+        {
+            frame.digitalDown[slot] = m_table.IsDown(static_cast<ActionStateTable::Slot>(slot));
+            frame.digitalChangeAgeUs[slot] = GetAgeUs(
+                m_table.GetDigitalChangeTime(static_cast<ActionStateTable::Slot>(slot)), tickTime);
+        }
+        for (size_t slot = 0; slot < frame.analogX.size(); slot++)
+        {
+            frame.analogX[slot] = m_table.GetX(static_cast<ActionStateTable::Slot>(slot));
+            frame.analogY[slot] = m_table.GetY(static_cast<ActionStateTable::Slot>(slot));
+            frame.analogChangeAgeUs[slot] = GetAgeUs(
+                m_table.GetAnalogChangeTime(static_cast<ActionStateTable::Slot>(slot)), tickTime);
+        }
+        frame.deviceMask = 0;
+        for (auto index : activeIndices)
+        {
+            frame.deviceMask |= uint64_t(1) << index;
+            frame.poses[index] = poses[index];
+        }
+
+        // Start a new segment on the keyframe interval, recycling the oldest
+        // segment's buffer once the ring is full
+        bool keyframe = m_segments.empty() || m_segments.back().tickCount >= m_segmentTicks;
+        if (keyframe)
+        {
+            Segment segment;
+            if (m_segments.size() >= m_maxSegments)
+            {
+                segment.data = std::move(m_segments.front().data);
+                m_segments.pop_front();
+            }
+            else
+            {
+                segment.data = std::move(m_spareBuffer);
+            }
+            segment.data.clear();
+            segment.firstTick = m_tickCount;
+            m_segments.push_back(std::move(segment));
+        }
+
+        Segment &segment = m_segments.back();
+        EncodeTick(frame, m_previousFrame, keyframe, segment.data);
+        segment.tickCount++;
+        m_tickCount++;
+        std::swap(m_frame, m_previousFrame);
+    }
+
+    void FlightRecorder::TakeSegments(Capture &capture)
+    {
+        capture.segments = std::move(m_segments);
+        m_segments.clear();
+    }
+
+    size_t FlightRecorder::GetSizeBytes() const
+    {
+        size_t size = 0;
+        for (const Segment &segment : m_segments)
+            size += segment.data.size();
+        return size;
+    }
+
+}
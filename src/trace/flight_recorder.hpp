@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <cmgCore/cmg_core.h>
+
+#include "trace/trace_format.hpp"
+#include "vr/action_table.hpp"
+#include "vr/device_registry.hpp"
+#include "util/timing.hpp"
+
+namespace trace
+{
+
+    /// @brief A run of encoded ticks starting with a keyframe
+    struct Segment
+    {
+        std::vector<uint8_t> data;
+        uint64_t firstTick = 0;
+        uint32_t tickCount = 0;
+    };
+
+    /// @brief Everything needed to write a trace file
+    struct Capture
+    {
+        std::vector<std::string> digitalNames;
+        std::vector<std::string> analogNames;
+        DeviceTable devices = {};
+        std::deque<Segment> segments;
+    };
+
+    /// @brief Write a captured trace to disk
+    Error WriteTraceFile(const std::string &path, const Capture &capture);
+
+    /// @brief Always-on recorder that keeps the last few seconds of per-tick
+    /// action state and device poses in memory, delta encoded. History is
+    /// kept as keyframed segments so the oldest can be dropped whole without
+    /// breaking the delta chain, and dropped segments' buffers are reused so
+    /// recording doesn't allocate once the ring is full.
+    class FlightRecorder
+    {
+    public:
+        /// @param segmentTicks ticks per segment (keyframe interval)
+        /// @param maxSegments segments of history to keep
+        FlightRecorder(const ActionStateTable &table, uint32_t segmentTicks, size_t maxSegments);
+
+        /// @brief Record the state of one mapping tick
+        void Record(const DeviceRegistry::PoseArray &poses,
+                    const std::vector<vr::TrackedDeviceIndex_t> &activeIndices,
+                    util::Timestamp tickTime);
+
+        /// @brief Move the recorded history into a capture, leaving the
+        /// recorder empty. Recording continues with a new keyframe.
+        void TakeSegments(Capture &capture);
+
+        /// @brief Total encoded size of the history held
+        size_t GetSizeBytes() const;
+
+    private:
+        const ActionStateTable &m_table;
+        uint32_t m_segmentTicks;
+        size_t m_maxSegments;
+        std::deque<Segment> m_segments;
+        std::vector<uint8_t> m_spareBuffer;
+        Frame m_frame;
+        Frame m_previousFrame;
+        util::Timestamp m_startTime;
+        uint64_t m_tickCount = 0;
+    };
+
+}
@@ -0,0 +1,325 @@
+#include "trace/trace_codec.hpp"
+
+#include <cstring>
+
+namespace trace
+{
+
+    namespace
+    {
+        inline void WriteVarint(std::vector<uint8_t> &out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value) | 0x80);
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        inline void WriteZigzag(std::vector<uint8_t> &out, int32_t value)
+        {
+            WriteVarint(out, (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+        }
+
+        inline bool ReadVarint(const uint8_t *&cursor, const uint8_t *end, uint64_t &value)
+        {
+            value = 0;
+            for (uint32_t shift = 0; shift < 64; shift += 7)
+            {
+                if (cursor == end)
+                    return false;
+                uint8_t byte = *cursor++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        inline bool ReadZigzag(const uint8_t *&cursor, const uint8_t *end, int32_t &value)
+        {
+            uint64_t raw;
+            if (!ReadVarint(cursor, end, raw))
+                return false;
+            uint32_t bits = static_cast<uint32_t>(raw);
+            value = static_cast<int32_t>((bits >> 1) ^ (0u - (bits & 1)));
+            return true;
+        }
+
+        inline uint32_t FloatBits(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        inline float BitsToFloat(uint32_t bits)
+        {
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        inline void GetPoseFloats(const vr::TrackedDevicePose_t &pose, uint32_t (&bits)[kPoseFloatCount])
+        {
+            size_t i = 0;
+            for (size_t row = 0; row < 3; row++)
+            {
+                for (size_t col = 0; col < 4; col++)
+                    bits[i++] = FloatBits(pose.mDeviceToAbsoluteTracking.m[row][col]);
+            }
+            for (size_t axis = 0; axis < 3; axis++)
+                bits[i++] = FloatBits(pose.vVelocity.v[axis]);
+            for (size_t axis = 0; axis < 3; axis++)
+                bits[i++] = FloatBits(pose.vAngularVelocity.v[axis]);
+        }
+
+        inline void SetPoseFloats(vr::TrackedDevicePose_t &pose, const uint32_t (&bits)[kPoseFloatCount])
+        {
+            size_t i = 0;
+            for (size_t row = 0; row < 3; row++)
+            {
+                for (size_t col = 0; col < 4; col++)
+                    pose.mDeviceToAbsoluteTracking.m[row][col] = BitsToFloat(bits[i++]);
+            }
+            for (size_t axis = 0; axis < 3; axis++)
+                pose.vVelocity.v[axis] = BitsToFloat(bits[i++]);
+            for (size_t axis = 0; axis < 3; axis++)
+                pose.vAngularVelocity.v[axis] = BitsToFloat(bits[i++]);
+        }
+
+        inline uint8_t GetPoseFlags(const vr::TrackedDevicePose_t &pose)
+        {
+            return (pose.bDeviceIsConnected ? kPoseConnected : 0) |
+                   (pose.bPoseIsValid ? kPoseValid : 0);
+        }
+
+        // Writes the count placeholder now and patches it once the entries
+        // are known, so changed slots are only scanned once
+        inline size_t BeginCount(std::vector<uint8_t> &out)
+        {
+            out.push_back(0);
+            return out.size() - 1;
+        }
+
+        inline void EndCount(std::vector<uint8_t> &out, size_t position, uint64_t count)
+        {
+            if (count < 0x80)
+            {
+                out[position] = static_cast<uint8_t>(count);
+                return;
+            }
+            std::vector<uint8_t> encoded;
+            WriteVarint(encoded, count);
+            out[position] = encoded[0];
+            out.insert(out.begin() + position + 1, encoded.begin() + 1, encoded.end());
+        }
+    }
+
+    void Frame::Reset(size_t digitalCount, size_t analogCount)
+    {
+        timeUs = 0;
+        digitalDown.assign(digitalCount, 0);
+        digitalChangeAgeUs.assign(digitalCount, 0);
+        analogX.assign(analogCount, 0.0f);
+        analogY.assign(analogCount, 0.0f);
+        analogChangeAgeUs.assign(analogCount, 0);
+        deviceMask = 0;
+        poses = {};
+    }
+
+    void EncodeTick(const Frame &frame, const Frame &previous, bool keyframe,
+                    std::vector<uint8_t> &out)
+    {
+        // Keyframes start from no devices, so only deltas need to say which
+        // devices left
+        bool devicesChanged = !keyframe && frame.deviceMask != previous.deviceMask;
+        WriteVarint(out, keyframe ? frame.timeUs : frame.timeUs - previous.timeUs);
+        out.push_back((keyframe ? kTickKeyframe : 0) | (devicesChanged ? kTickDevicesChanged : 0));
+
+        // Digital actions
+        {
+            size_t countPosition = BeginCount(out);
+            uint64_t count = 0;
+            size_t nextSlot = 0;
+            for (size_t slot = 0; slot < frame.digitalDown.size(); slot++)
+            {
+                if (!keyframe && frame.digitalDown[slot] == previous.digitalDown[slot])
+                    continue;
+                WriteVarint(out, slot - nextSlot);
+                out.push_back(frame.digitalDown[slot]);
+                WriteZigzag(out, frame.digitalChangeAgeUs[slot]);
+                nextSlot = slot + 1;
+                count++;
+            }
+            EndCount(out, countPosition, count);
+        }
+
+        // Analog actions
+        {
+            size_t countPosition = BeginCount(out);
+            uint64_t count = 0;
+            size_t nextSlot = 0;
+            for (size_t slot = 0; slot < frame.analogX.size(); slot++)
+            {
+                uint32_t x = FloatBits(frame.analogX[slot]);
+                uint32_t y = FloatBits(frame.analogY[slot]);
+                uint32_t xPrev = keyframe ? 0 : FloatBits(previous.analogX[slot]);
+                uint32_t yPrev = keyframe ? 0 : FloatBits(previous.analogY[slot]);
+                if (!keyframe && x == xPrev && y == yPrev)
+                    continue;
+                WriteVarint(out, slot - nextSlot);
+                WriteVarint(out, x ^ xPrev);
+                WriteVarint(out, y ^ yPrev);
+                WriteZigzag(out, frame.analogChangeAgeUs[slot]);
+                nextSlot = slot + 1;
+                count++;
+            }
+            EndCount(out, countPosition, count);
+        }
+
+        // Device poses. Unchanged poses are left out of delta records.
+        if (devicesChanged)
+            WriteVarint(out, frame.deviceMask);
+        uint64_t mask = 0;
+        uint32_t bits[kMaxDeviceCount][kPoseFloatCount];
+        uint32_t prevBits[kPoseFloatCount] = {};
+        for (size_t index = 0; index < kMaxDeviceCount; index++)
+        {
+            if (!(frame.deviceMask & (uint64_t(1) << index)))
+                continue;
+            GetPoseFloats(frame.poses[index], bits[index]);
+            bool changed = keyframe || !(previous.deviceMask & (uint64_t(1) << index));
+            if (!changed)
+            {
+                const vr::TrackedDevicePose_t &prevPose = previous.poses[index];
+                GetPoseFloats(prevPose, prevBits);
+                changed = GetPoseFlags(frame.poses[index]) != GetPoseFlags(prevPose) ||
+                          std::memcmp(bits[index], prevBits, sizeof(prevBits)) != 0;
+            }
+            if (changed)
+                mask |= uint64_t(1) << index;
+        }
+        WriteVarint(out, mask);
+        for (size_t index = 0; index < kMaxDeviceCount; index++)
+        {
+            if (!(mask & (uint64_t(1) << index)))
+                continue;
+            const vr::TrackedDevicePose_t &pose = frame.poses[index];
+            bool hasPrevious = !keyframe && (previous.deviceMask & (uint64_t(1) << index));
+            if (hasPrevious)
+                GetPoseFloats(previous.poses[index], prevBits);
+            else
+                std::memset(prevBits, 0, sizeof(prevBits));
+            out.push_back(GetPoseFlags(pose));
+            for (size_t i = 0; i < kPoseFloatCount; i++)
+                WriteVarint(out, bits[index][i] ^ prevBits[i]);
+        }
+    }
+
+    bool DecodeTick(const uint8_t *&cursor, const uint8_t *end, Frame &frame)
+    {
+        uint64_t time;
+        if (!ReadVarint(cursor, end, time) || cursor == end)
+            return false;
+        uint8_t flags = *cursor++;
+        bool keyframe = (flags & kTickKeyframe) != 0;
+        if (keyframe)
+        {
+            frame.Reset(frame.digitalDown.size(), frame.analogX.size());
+            frame.timeUs = time;
+        }
+        else
+        {
+            frame.timeUs += time;
+        }
+
+        // Digital actions
+        uint64_t count;
+        if (!ReadVarint(cursor, end, count))
+            return false;
+        uint64_t nextSlot = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t gap;
+            if (!ReadVarint(cursor, end, gap) || cursor == end)
+                return false;
+            uint64_t slot = nextSlot + gap;
+            if (slot >= frame.digitalDown.size())
+                return false;
+            frame.digitalDown[slot] = *cursor++;
+            if (!ReadZigzag(cursor, end, frame.digitalChangeAgeUs[slot]))
+                return false;
+            nextSlot = slot + 1;
+        }
+
+        // Analog actions
+        if (!ReadVarint(cursor, end, count))
+            return false;
+        nextSlot = 0;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t gap, x, y;
+            if (!ReadVarint(cursor, end, gap))
+                return false;
+            uint64_t slot = nextSlot + gap;
+            if (slot >= frame.analogX.size() ||
+                !ReadVarint(cursor, end, x) || !ReadVarint(cursor, end, y))
+                return false;
+            frame.analogX[slot] = BitsToFloat(FloatBits(frame.analogX[slot]) ^ static_cast<uint32_t>(x));
+            frame.analogY[slot] = BitsToFloat(FloatBits(frame.analogY[slot]) ^ static_cast<uint32_t>(y));
+            if (!ReadZigzag(cursor, end, frame.analogChangeAgeUs[slot]))
+                return false;
+            nextSlot = slot + 1;
+        }
+
+        // Device poses. Clear devices which have left; new ones are added by
+        // their pose records.
+        if (flags & kTickDevicesChanged)
+        {
+            uint64_t deviceMask;
+            if (!ReadVarint(cursor, end, deviceMask))
+                return false;
+            for (size_t index = 0; index < kMaxDeviceCount; index++)
+            {
+                uint64_t bit = uint64_t(1) << index;
+                if ((frame.deviceMask & bit) && !(deviceMask & bit))
+                    frame.poses[index] = vr::TrackedDevicePose_t();
+            }
+            frame.deviceMask &= deviceMask;
+        }
+        uint64_t mask;
+        if (!ReadVarint(cursor, end, mask))
+            return false;
+        uint32_t bits[kPoseFloatCount];
+        for (size_t index = 0; index < kMaxDeviceCount; index++)
+        {
+            uint64_t bit = uint64_t(1) << index;
+            if (!(mask & bit))
+                continue;
+            if (cursor == end)
+                return false;
+            vr::TrackedDevicePose_t &pose = frame.poses[index];
+            if (!(frame.deviceMask & bit))
+                pose = vr::TrackedDevicePose_t();
+            uint8_t poseFlags = *cursor++;
+            pose.bDeviceIsConnected = (poseFlags & kPoseConnected) != 0;
+            pose.bPoseIsValid = (poseFlags & kPoseValid) != 0;
+            pose.eTrackingResult = pose.bPoseIsValid ? vr::TrackingResult_Running_OK
+                                                     : vr::TrackingResult_Uninitialized;
+            GetPoseFloats(pose, bits);
+            for (size_t i = 0; i < kPoseFloatCount; i++)
+            {
+                uint64_t delta;
+                if (!ReadVarint(cursor, end, delta))
+                    return false;
+                bits[i] ^= static_cast<uint32_t>(delta);
+            }
+            SetPoseFloats(pose, bits);
+            frame.deviceMask |= bit;
+        }
+        return true;
+    }
+
+}
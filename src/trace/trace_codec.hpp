@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "trace/trace_format.hpp"
+
+namespace trace
+{
+
+    /// @brief Append a tick record for a frame
+    /// @param previous the frame encoded before this one; ignored for keyframes
+    void EncodeTick(const Frame &frame, const Frame &previous, bool keyframe,
+                    std::vector<uint8_t> &out);
+
+    /// @brief Apply the tick record at cursor to the previous tick's frame
+    /// @return false if the record is truncated or malformed
+    bool DecodeTick(const uint8_t *&cursor, const uint8_t *end, Frame &frame);
+
+}
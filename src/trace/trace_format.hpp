@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <openvr.h>
+
+// Binary input trace format. All values are little-endian and the file is
+// laid out so it can be memory-mapped and decoded in place:
+//
+//   FileHeader
+//   DeviceRecord[k_unMaxTrackedDeviceCount]    device class and role
+//   string table                               NUL terminated action names,
+//                                              digital slots then analog slots
+//   SegmentRecord[segmentCount]                index for seeking
+//   tick data                                  segments of tick records
+//
+// Every segment starts with a keyframe holding the full state, followed by
+// delta records that only hold what changed since the previous tick. A tick
+// record is:
+//
+//   varint   time: microseconds since trace start (keyframe) or since the
+//            previous tick (delta)
+//   u8       flags (kTickKeyframe, kTickDevicesChanged)
+//   varint   changed digital count, then per action:
+//              varint slot gap, u8 down, zigzag varint change age (us)
+//   varint   changed analog count, then per action:
+//              varint slot gap, varint x bits ^ previous, varint y bits ^
+//              previous, zigzag varint change age (us)
+//   varint   mask of recorded devices, only in delta records flagged
+//            kTickDevicesChanged. Devices missing from it have left.
+//   varint   mask of devices with a pose record, then per device:
+//              u8 pose flags, kPoseFloatCount varints of float bits ^ previous
+//
+// Slot gaps are the distance from the previous encoded slot plus one, so
+// consecutive slots cost a byte. Tracking noise only disturbs the low
+// mantissa bits of pose floats, so XOR against the previous tick's bits keeps
+// most pose values to two or three bytes.
+
+namespace trace
+{
+
+    static const char kMagic[8] = {'D', 'V', 'R', 'T', 'R', 'A', 'C', 'E'};
+    static const uint32_t kVersion = 2;
+
+    static const uint8_t kTickKeyframe = 1 << 0;
+    static const uint8_t kTickDevicesChanged = 1 << 1;
+    static const uint8_t kPoseConnected = 1 << 0;
+    static const uint8_t kPoseValid = 1 << 1;
+
+    /// @brief Pose floats stored per device: the 3x4 tracking matrix, then
+    /// linear and angular velocity
+    static const size_t kPoseFloatCount = 18;
+
+    static const size_t kMaxDeviceCount = vr::k_unMaxTrackedDeviceCount;
+    static_assert(kMaxDeviceCount <= 64, "device mask must fit in 64 bits");
+
+#pragma pack(push, 1)
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t digitalCount;
+        uint32_t analogCount;
+        uint32_t segmentCount;
+        uint64_t tickCount;
+        uint64_t deviceTableOffset;
+        uint64_t stringTableOffset;
+        uint64_t stringTableSize;
+        uint64_t segmentIndexOffset;
+        uint64_t dataOffset;
+        uint64_t dataSize;
+    };
+
+    struct DeviceRecord
+    {
+        uint8_t active;
+        uint8_t deviceClass;
+        uint8_t role;
+        uint8_t reserved;
+    };
+
+    struct SegmentRecord
+    {
+        uint64_t offset; // Relative to dataOffset
+        uint64_t size;
+        uint64_t firstTick;
+        uint32_t tickCount;
+        uint32_t reserved;
+    };
+#pragma pack(pop)
+
+    using DeviceTable = std::array<DeviceRecord, kMaxDeviceCount>;
+
+    /// @brief Full input state for one tick. The encoder diffs consecutive
+    /// frames and the decoder applies records to the previous frame in place.
+    struct Frame
+    {
+        uint64_t timeUs = 0; // Since trace start
+        std::vector<uint8_t> digitalDown;
+        std::vector<int32_t> digitalChangeAgeUs; // Change time relative to the tick, <= 0
+        std::vector<float> analogX;
+        std::vector<float> analogY;
+        std::vector<int32_t> analogChangeAgeUs;
+        uint64_t deviceMask = 0; // Devices whose poses are recorded
+        std::array<vr::TrackedDevicePose_t, kMaxDeviceCount> poses = {};
+
+        /// @brief Size the action arrays and clear all state
+        void Reset(size_t digitalCount, size_t analogCount);
+    };
+
+}
@@ -0,0 +1,102 @@
+#include "trace/trace_reader.hpp"
+
+#include <cstring>
+
+#include "trace/trace_codec.hpp"
+
+namespace trace
+{
+
+    Error TraceReader::Open(const std::string &path)
+    {
+        CMG_LOG_INFO() << "Loading trace: " << path;
+        if (!m_file.Open(path))
+            return CMG_ERROR(Error::kFileNotFound);
+
+        const uint8_t *base = m_file.GetData();
+        const size_t size = m_file.GetSize();
+        if (size < sizeof(FileHeader))
+            return CMG_ERROR(Error::kFileCorrupt);
+        std::memcpy(&m_header, base, sizeof(FileHeader));
+        if (std::memcmp(m_header.magic, kMagic, sizeof(kMagic)) != 0 || m_header.version != kVersion)
+        {
+            CMG_LOG_ERROR() << "Not a version " << kVersion << " trace file";
+            return CMG_ERROR(Error::kFileCorrupt);
+        }
+        if (m_header.deviceTableOffset + sizeof(DeviceTable) > size ||
+            m_header.stringTableOffset + m_header.stringTableSize > size ||
+            m_header.segmentIndexOffset + m_header.segmentCount * sizeof(SegmentRecord) > size ||
+            m_header.dataOffset + m_header.dataSize > size)
+        {
+            return CMG_ERROR(Error::kFileCorrupt);
+        }
+        std::memcpy(m_devices.data(), base + m_header.deviceTableOffset, sizeof(DeviceTable));
+
+        // Action names
+        m_digitalNames.clear();
+        m_analogNames.clear();
+        const char *strings = reinterpret_cast<const char *>(base + m_header.stringTableOffset);
+        const char *stringsEnd = strings + m_header.stringTableSize;
+        for (uint32_t i = 0; i < m_header.digitalCount + m_header.analogCount; i++)
+        {
+            const char *name = strings;
+            while (strings < stringsEnd && *strings)
+                strings++;
+            if (strings == stringsEnd)
+                return CMG_ERROR(Error::kFileCorrupt);
+            (i < m_header.digitalCount ? m_digitalNames : m_analogNames).emplace_back(name, strings);
+            strings++;
+        }
+
+        m_segments = reinterpret_cast<const SegmentRecord *>(base + m_header.segmentIndexOffset);
+        m_data = base + m_header.dataOffset;
+        for (uint32_t i = 0; i < m_header.segmentCount; i++)
+        {
+            if (m_segments[i].offset + m_segments[i].size > m_header.dataSize)
+                return CMG_ERROR(Error::kFileCorrupt);
+        }
+        Rewind();
+
+        CMG_LOG_INFO() << "Trace has " << m_header.tickCount << " ticks, "
+                       << m_digitalNames.size() << " digital and "
+                       << m_analogNames.size() << " analog actions";
+        return CMG_ERROR_SUCCESS;
+    }
+
+    bool TraceReader::ReadTick(Frame &frame)
+    {
+        if (m_cursor == m_end)
+            return false;
+        if (frame.digitalDown.size() != m_digitalNames.size() ||
+            frame.analogX.size() != m_analogNames.size())
+        {
+            frame.Reset(m_digitalNames.size(), m_analogNames.size());
+        }
+        if (!DecodeTick(m_cursor, m_end, frame))
+        {
+            CMG_LOG_ERROR() << "Corrupt trace record";
+            m_cursor = m_end;
+            return false;
+        }
+        return true;
+    }
+
+    void TraceReader::Seek(uint64_t tick)
+    {
+        // Segments are contiguous in the data block, so reading runs on from
+        // the sought segment to the end of the trace
+        m_cursor = m_data;
+        m_end = m_data + m_header.dataSize;
+        for (uint32_t i = 0; i < m_header.segmentCount; i++)
+        {
+            const SegmentRecord &segment = m_segments[i];
+            if (tick < segment.firstTick + segment.tickCount)
+            {
+                m_cursor = m_data + segment.offset;
+                return;
+            }
+        }
+        m_cursor = m_end;
+    }
+
+}
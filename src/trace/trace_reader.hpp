@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cmgCore/cmg_core.h>
+
+#include "trace/trace_format.hpp"
+#include "util/mapped_file.hpp"
+
+namespace trace
+{
+
+    /// @brief Reads a trace file in place through a memory mapping, decoding
+    /// one tick at a time into a reused frame
+    class TraceReader
+    {
+    public:
+        Error Open(const std::string &path);
+
+        /// @brief Decode the next tick
+        /// @return false at the end of the trace or on a corrupt record
+        bool ReadTick(Frame &frame);
+
+        /// @brief Jump to the segment containing a tick. The next ReadTick()
+        /// returns that segment's keyframe.
+        void Seek(uint64_t tick);
+
+        inline void Rewind() { Seek(0); }
+
+        inline const std::vector<std::string> &GetDigitalNames() const { return m_digitalNames; }
+        inline const std::vector<std::string> &GetAnalogNames() const { return m_analogNames; }
+        inline const DeviceTable &GetDevices() const { return m_devices; }
+        inline uint64_t GetTickCount() const { return m_header.tickCount; }
+
+    private:
+        util::MappedFile m_file;
+        FileHeader m_header = {};
+        DeviceTable m_devices = {};
+        std::vector<std::string> m_digitalNames;
+        std::vector<std::string> m_analogNames;
+        const SegmentRecord *m_segments = nullptr;
+        const uint8_t *m_data = nullptr;
+        const uint8_t *m_cursor = nullptr;
+        const uint8_t *m_end = nullptr;
+    };
+
+}
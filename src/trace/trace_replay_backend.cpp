@@ -0,0 +1,126 @@
+#include "trace/trace_replay_backend.hpp"
+
+#include <chrono>
+
+namespace trace
+{
+
+    namespace
+    {
+        // Handles encode the trace slot, offset by kind so digital and
+        // analog slots can't collide and no handle is invalid (0)
+        const vr::VRActionHandle_t kDigitalBase = 1;
+        const vr::VRActionHandle_t kAnalogBase = vr::VRActionHandle_t(1) << 32;
+        const vr::VRActionHandle_t kUnknownBase = vr::VRActionHandle_t(1) << 48;
+
+        /// @brief Reads action states from the current trace frame
+        struct FrameActionSource
+        {
+            const Frame &frame;
+
+            inline bool ReadDigital(uint32_t slot, vr::VRActionHandle_t handle, vr::InputDigitalActionData_t &data)
+            {
+                if (handle < kDigitalBase || handle >= kAnalogBase)
+                    return false;
+                size_t traceSlot = static_cast<size_t>(handle - kDigitalBase);
+                data.bActive = true;
+                data.bState = frame.digitalDown[traceSlot] != 0;
+                data.bChanged = true;
+                data.fUpdateTime = frame.digitalChangeAgeUs[traceSlot] * 1e-6f;
+                return true;
+            }
+
+            inline bool ReadAnalog(uint32_t slot, vr::VRActionHandle_t handle, vr::InputAnalogActionData_t &data)
+            {
+                if (handle < kAnalogBase || handle >= kUnknownBase)
+                    return false;
+                size_t traceSlot = static_cast<size_t>(handle - kAnalogBase);
+                data.bActive = true;
+                data.x = frame.analogX[traceSlot];
+                data.y = frame.analogY[traceSlot];
+                data.fUpdateTime = frame.analogChangeAgeUs[traceSlot] * 1e-6f;
+                return true;
+            }
+        };
+    }
+
+    Error TraceReplayBackend::Open(const std::string &path)
+    {
+        Error error = m_reader.Open(path);
+        if (error.Failed())
+            return error.Uncheck();
+        m_frame.Reset(m_reader.GetDigitalNames().size(), m_reader.GetAnalogNames().size());
+        m_ticks = 0;
+        return CMG_ERROR_SUCCESS;
+    }
+
+    vr::VRActionHandle_t TraceReplayBackend::GetActionHandle(const std::string &path)
+    {
+        const auto &digitalNames = m_reader.GetDigitalNames();
+        for (size_t slot = 0; slot < digitalNames.size(); slot++)
+        {
+            if (digitalNames[slot] == path)
+                return kDigitalBase + slot;
+        }
+        const auto &analogNames = m_reader.GetAnalogNames();
+        for (size_t slot = 0; slot < analogNames.size(); slot++)
+        {
+            if (analogNames[slot] == path)
+                return kAnalogBase + slot;
+        }
+        CMG_LOG_INFO() << "Action not in trace: " << path;
+        return kUnknownBase + m_unknownActions++;
+    }
+
+    bool TraceReplayBackend::BeginTick()
+    {
+        if (!m_reader.ReadTick(m_frame))
+        {
+            CMG_LOG_INFO() << "Replay finished after " << m_ticks << " ticks";
+            return false;
+        }
+
+        // Recorded tick times are shifted to start now, keeping their spacing
+        if (m_ticks++ == 0)
+            m_start = util::Clock::now() - std::chrono::microseconds(m_frame.timeUs);
+        m_tickTime = m_start + std::chrono::microseconds(m_frame.timeUs);
+        if (!m_fast)
+            util::SleepUntil(m_tickTime);
+        return true;
+    }
+
+    void TraceReplayBackend::UpdateActions(vr::VRActionSetHandle_t actionSet, ActionStateTable &table)
+    {
+        FrameActionSource source = {m_frame};
+        table.Update(source, m_tickTime);
+    }
+
+    util::Timestamp TraceReplayBackend::GetPoses(const PosePredictor::PredictionArray &predictions,
+                                                 PosePredictor::PoseArray &poses)
+    {
+        // Recorded poses already include whatever prediction was in use
+        poses = m_frame.poses;
+        return m_tickTime;
+    }
+
+    vr::ETrackedDeviceClass TraceReplayBackend::GetDeviceClass(vr::TrackedDeviceIndex_t index)
+    {
+        const DeviceRecord &record = m_reader.GetDevices()[index];
+        if (!record.active)
+            return vr::TrackedDeviceClass_Invalid;
+        return static_cast<vr::ETrackedDeviceClass>(record.deviceClass);
+    }
+
+    vr::ETrackedControllerRole TraceReplayBackend::GetControllerRole(vr::TrackedDeviceIndex_t index)
+    {
+        return static_cast<vr::ETrackedControllerRole>(m_reader.GetDevices()[index].role);
+    }
+
+    std::string TraceReplayBackend::GetDeviceString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop)
+    {
+        if (prop == vr::Prop_SerialNumber_String)
+            return "trace-" + std::to_string(index);
+        return "";
+    }
+
+}
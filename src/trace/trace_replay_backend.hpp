@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+
+#include "vr/input_backend.hpp"
+#include "trace/trace_reader.hpp"
+
+namespace trace
+{
+
+    /// @brief Input backend which replays a recorded trace. Action handles
+    /// are assigned by looking up action names in the trace, so a trace still
+    /// replays after actions are added to or removed from the manifest;
+    /// actions missing from the trace stay inactive.
+    class TraceReplayBackend : public InputBackend
+    {
+    public:
+        /// @param fast run ticks back to back instead of at their recorded
+        /// spacing
+        TraceReplayBackend(bool fast) : m_fast(fast) {}
+
+        Error Open(const std::string &path);
+
+        virtual vr::VRActionSetHandle_t GetActionSetHandle(const std::string &path) override { return 1; }
+        virtual vr::VRActionHandle_t GetActionHandle(const std::string &path) override;
+        virtual bool BeginTick() override;
+        virtual bool PacesTicks() const override { return true; }
+        virtual void UpdateActions(vr::VRActionSetHandle_t actionSet, ActionStateTable &table) override;
+        virtual util::Timestamp GetPoses(const PosePredictor::PredictionArray &predictions,
+                                         PosePredictor::PoseArray &poses) override;
+        virtual vr::ETrackedDeviceClass GetDeviceClass(vr::TrackedDeviceIndex_t index) override;
+        virtual vr::ETrackedControllerRole GetControllerRole(vr::TrackedDeviceIndex_t index) override;
+        virtual std::string GetDeviceString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop) override;
+
+    private:
+        TraceReader m_reader;
+        Frame m_frame;
+        util::Timestamp m_start;
+        util::Timestamp m_tickTime;
+        uint64_t m_ticks = 0;
+        uint64_t m_unknownActions = 0;
+        bool m_fast = false;
+    };
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cmath>
+
+namespace util
+{
+
+    /// @brief atan(x) / x from x squared, for x in [-1, 1], by a minimax
+    /// polynomial. Lets callers that have x squared skip a square root.
+    inline float FastAtanRatio(float x2)
+    {
+        // Evaluated in pairs of terms rather than nested, for a shorter
+        // dependency chain
+        float x4 = x2 * x2;
+        float low = 0.99997726f + x2 * -0.33262347f;
+        float middle = 0.19354346f + x2 * -0.11643287f;
+        float high = 0.05265332f + x2 * -0.01172120f;
+        return low + x4 * (middle + x4 * high);
+    }
+
+    /// @brief Arctangent of a value in [-1, 1], with absolute error below
+    /// 2e-6 radians
+    inline float FastAtanUnit(float x)
+    {
+        return x * FastAtanRatio(x * x);
+    }
+
+    /// @brief Arctangent of y / x for non-negative x and y, in [0, pi/2],
+    /// with the error bound of FastAtanUnit()
+    inline float FastAtanPositive(float y, float x)
+    {
+        const float kHalfPi = 1.57079633f;
+        if (y <= x)
+            return x > 0.0f ? FastAtanUnit(y / x) : 0.0f;
+        return kHalfPi - FastAtanUnit(x / y);
+    }
+
+}
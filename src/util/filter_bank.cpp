@@ -0,0 +1,226 @@
+#include "util/filter_bank.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace util
+{
+
+    namespace
+    {
+        const float kTwoPi = 6.28318530718f;
+
+        /// @brief Time constant of a first order low-pass
+        inline float CutoffToTau(float cutoff)
+        {
+            return 1.0f / (kTwoPi * std::max(cutoff, 1e-3f));
+        }
+
+        /// @brief Smoothing factor of a first order low-pass for a time step
+        inline float SmoothingFactor(float tau, float dt)
+        {
+            return dt / (tau + dt);
+        }
+    }
+
+    bool ParseFilterType(const std::string &name, FilterStage::Type &type)
+    {
+        if (name == "one_euro")
+            type = FilterStage::Type::kOneEuro;
+        else if (name == "low_pass")
+            type = FilterStage::Type::kLowPass;
+        else if (name == "slew_limit")
+            type = FilterStage::Type::kSlewLimit;
+        else if (name == "median3")
+            type = FilterStage::Type::kMedian3;
+        else
+            return false;
+        return true;
+    }
+
+    void FilterBank::Clear()
+    {
+        m_inputs.clear();
+        m_values.clear();
+        m_latency.clear();
+        m_maxDepth = 0;
+        m_oneEuro = {};
+        m_lowPass = {};
+        m_slewLimit = {};
+        m_median3 = {};
+        m_lastTime = Timestamp();
+    }
+
+    template <class Row>
+    void FilterBank::GetDepthRange(const Table<Row> &table, size_t depth, uint32_t &begin, uint32_t &end)
+    {
+        // Positions past the table's deepest row are empty runs at its end
+        uint32_t size = static_cast<uint32_t>(table.rows.size());
+        begin = depth == 0 ? 0 : (depth - 1 < table.depthEnd.size() ? table.depthEnd[depth - 1] : size);
+        end = depth < table.depthEnd.size() ? table.depthEnd[depth] : size;
+    }
+
+    template <class Row>
+    void FilterBank::AddRow(Table<Row> &table, size_t depth, const Row &row)
+    {
+        if (table.depthEnd.size() <= depth)
+            table.depthEnd.resize(depth + 1, static_cast<uint32_t>(table.rows.size()));
+        table.rows.insert(table.rows.begin() + table.depthEnd[depth], row);
+        for (size_t index = depth; index < table.depthEnd.size(); index++)
+            table.depthEnd[index]++;
+    }
+
+    FilterBank::Channel FilterBank::AddChannel(const FilterChain &chain)
+    {
+        Channel channel = static_cast<Channel>(m_values.size());
+        m_inputs.push_back(0.0f);
+        m_values.push_back(0.0f);
+        m_latency.push_back(0.0f);
+        m_maxDepth = std::max(m_maxDepth, chain.size());
+
+        for (size_t depth = 0; depth < chain.size(); depth++)
+        {
+            const FilterStage &stage = chain[depth];
+            switch (stage.type)
+            {
+            case FilterStage::Type::kOneEuro:
+                AddRow(m_oneEuro, depth, OneEuroRow{channel, stage.minCutoff, stage.beta, stage.derivativeCutoff, 0.0f, 0.0f});
+                break;
+            case FilterStage::Type::kLowPass:
+                AddRow(m_lowPass, depth, LowPassRow{channel, CutoffToTau(stage.cutoff), 0.0f, 0.0f});
+                break;
+            case FilterStage::Type::kSlewLimit:
+                AddRow(m_slewLimit, depth, SlewLimitRow{channel, std::max(stage.maxRate, 1e-6f), 0.0f});
+                break;
+            case FilterStage::Type::kMedian3:
+                AddRow(m_median3, depth, Median3Row{channel, {0.0f, 0.0f}});
+                break;
+            }
+        }
+
+        // Start every channel afresh, including those already running
+        m_lastTime = Timestamp();
+        return channel;
+    }
+
+    void FilterBank::Update(Timestamp time)
+    {
+        // Inputs sampled at the same time are the same sample
+        bool reset = m_lastTime == Timestamp();
+        if (!reset && time == m_lastTime)
+            return;
+        float dt = 0.0f;
+        if (!reset)
+            dt = std::clamp(std::chrono::duration<float>(time - m_lastTime).count(), 0.0f, kMaxTimeStep);
+        m_lastTime = time;
+
+        // Filters run in place, with each stage adding its delay
+        std::copy(m_inputs.begin(), m_inputs.end(), m_values.begin());
+        std::fill(m_latency.begin(), m_latency.end(), 0.0f);
+        for (size_t depth = 0; depth < m_maxDepth; depth++)
+        {
+            uint32_t begin, end;
+            GetDepthRange(m_oneEuro, depth, begin, end);
+            UpdateOneEuro(begin, end, dt, reset);
+            GetDepthRange(m_lowPass, depth, begin, end);
+            UpdateLowPass(begin, end, dt, reset);
+            GetDepthRange(m_slewLimit, depth, begin, end);
+            UpdateSlewLimit(begin, end, dt, reset);
+            GetDepthRange(m_median3, depth, begin, end);
+            UpdateMedian3(begin, end, dt, reset);
+        }
+    }
+
+    void FilterBank::UpdateOneEuro(uint32_t begin, uint32_t end, float dt, bool reset)
+    {
+        for (uint32_t index = begin; index < end; index++)
+        {
+            OneEuroRow &row = m_oneEuro.rows[index];
+            float x = m_values[row.channel];
+            if (reset)
+            {
+                row.value = x;
+                row.derivative = 0.0f;
+            }
+            else if (dt > 0.0f)
+            {
+                float derivative = (x - row.value) / dt;
+                row.derivative += SmoothingFactor(CutoffToTau(row.derivativeCutoff), dt) * (derivative - row.derivative);
+            }
+
+            // The faster the value moves, the higher the cutoff
+            float tau = CutoffToTau(row.minCutoff + row.beta * std::abs(row.derivative));
+            if (!reset)
+                row.value += SmoothingFactor(tau, dt) * (x - row.value);
+            m_values[row.channel] = row.value;
+            m_latency[row.channel] += tau;
+        }
+    }
+
+    void FilterBank::UpdateLowPass(uint32_t begin, uint32_t end, float dt, bool reset)
+    {
+        for (uint32_t index = begin; index < end; index++)
+        {
+            LowPassRow &row = m_lowPass.rows[index];
+            float x = m_values[row.channel];
+            if (reset)
+            {
+                row.pole1 = x;
+                row.pole2 = x;
+            }
+            else
+            {
+                float alpha = SmoothingFactor(row.tau, dt);
+                row.pole1 += alpha * (x - row.pole1);
+                row.pole2 += alpha * (row.pole1 - row.pole2);
+            }
+            m_values[row.channel] = row.pole2;
+            m_latency[row.channel] += 2.0f * row.tau;
+        }
+    }
+
+    void FilterBank::UpdateSlewLimit(uint32_t begin, uint32_t end, float dt, bool reset)
+    {
+        for (uint32_t index = begin; index < end; index++)
+        {
+            SlewLimitRow &row = m_slewLimit.rows[index];
+            float x = m_values[row.channel];
+            if (reset)
+            {
+                row.value = x;
+            }
+            else
+            {
+                float maxStep = row.maxRate * dt;
+                row.value += std::clamp(x - row.value, -maxStep, maxStep);
+            }
+
+            // Time to catch up with the input at the limit
+            m_values[row.channel] = row.value;
+            m_latency[row.channel] += std::abs(x - row.value) / row.maxRate;
+        }
+    }
+
+    void FilterBank::UpdateMedian3(uint32_t begin, uint32_t end, float dt, bool reset)
+    {
+        for (uint32_t index = begin; index < end; index++)
+        {
+            Median3Row &row = m_median3.rows[index];
+            float x = m_values[row.channel];
+            if (reset)
+            {
+                row.history[0] = x;
+                row.history[1] = x;
+            }
+            float a = row.history[1];
+            float b = row.history[0];
+            row.history[1] = b;
+            row.history[0] = x;
+
+            // A steady ramp comes out one sample late
+            m_values[row.channel] = std::max(std::min(a, b), std::min(std::max(a, b), x));
+            m_latency[row.channel] += dt;
+        }
+    }
+
+}
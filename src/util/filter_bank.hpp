@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "util/timing.hpp"
+
+namespace util
+{
+
+    /// @brief One stage of a filter chain
+    struct FilterStage
+    {
+        enum class Type : uint8_t
+        {
+            /// @brief Low-pass whose cutoff rises with speed, smoothing
+            /// jitter at rest with little lag in fast motion
+            kOneEuro,
+            /// @brief Two identical first order low-passes in series, which
+            /// smooth without overshoot
+            kLowPass,
+            /// @brief Limits how fast the value can change
+            kSlewLimit,
+            /// @brief Median of the last three samples, rejecting single
+            /// sample spikes
+            kMedian3,
+        };
+
+        Type type = Type::kLowPass;
+
+        // kOneEuro: cutoff at rest and its increase per unit/s of speed,
+        // and the cutoff used to smooth the speed itself, in Hz
+        float minCutoff = 1.0f;
+        float beta = 0.0f;
+        float derivativeCutoff = 1.0f;
+
+        // kLowPass: cutoff of each pole, in Hz
+        float cutoff = 10.0f;
+
+        // kSlewLimit: units per second
+        float maxRate = 1.0f;
+    };
+
+    using FilterChain = std::vector<FilterStage>;
+
+    /// @brief Parse a filter stage type name ("one_euro", "low_pass",
+    /// "slew_limit", "median3")
+    bool ParseFilterType(const std::string &name, FilterStage::Type &type);
+
+    /// @brief Runs a chain of filter stages on each of many scalar channels.
+    /// Stages are kept in one table per type, ordered by their position in
+    /// the chain, so an update is one tight loop per type and position over
+    /// all channels rather than a virtual call per stage.
+    ///
+    /// Each stage estimates the delay it adds to a steadily moving signal,
+    /// and a channel's latency is the sum over its chain, so smoothing can
+    /// be traded against lag knowingly.
+    class FilterBank
+    {
+    public:
+        using Channel = uint32_t;
+
+        /// @brief Longest time step filters advance by, so a stall doesn't
+        /// make them jump
+        static constexpr float kMaxTimeStep = 0.1f;
+
+        void Clear();
+
+        /// @brief Add a channel filtered by a chain of stages. A channel
+        /// with an empty chain passes its input through.
+        Channel AddChannel(const FilterChain &chain);
+
+        inline size_t GetChannelCount() const { return m_values.size(); }
+
+        inline void SetInput(Channel channel, float value) { m_inputs[channel] = value; }
+        inline float GetOutput(Channel channel) const { return m_values[channel]; }
+
+        /// @brief Estimated delay the channel's filters add, in seconds
+        inline float GetLatency(Channel channel) const { return m_latency[channel]; }
+
+        /// @brief Filter every channel's input
+        /// @param time when the inputs were sampled. Stages start from their
+        /// first input, and the time step is measured from the last update.
+        void Update(Timestamp time);
+
+    private:
+        struct OneEuroRow
+        {
+            Channel channel;
+            float minCutoff;
+            float beta;
+            float derivativeCutoff;
+            float value;
+            float derivative;
+        };
+
+        struct LowPassRow
+        {
+            Channel channel;
+            float tau;
+            float pole1;
+            float pole2;
+        };
+
+        struct SlewLimitRow
+        {
+            Channel channel;
+            float maxRate;
+            float value;
+        };
+
+        struct Median3Row
+        {
+            Channel channel;
+            float history[2];
+        };
+
+        /// @brief Rows of one stage type, sorted by chain position, with
+        /// the end of each position's run
+        template <class Row>
+        struct Table
+        {
+            std::vector<Row> rows;
+            std::vector<uint32_t> depthEnd;
+        };
+
+        template <class Row>
+        static void GetDepthRange(const Table<Row> &table, size_t depth, uint32_t &begin, uint32_t &end);
+        template <class Row>
+        static void AddRow(Table<Row> &table, size_t depth, const Row &row);
+
+        void UpdateOneEuro(uint32_t begin, uint32_t end, float dt, bool reset);
+        void UpdateLowPass(uint32_t begin, uint32_t end, float dt, bool reset);
+        void UpdateSlewLimit(uint32_t begin, uint32_t end, float dt, bool reset);
+        void UpdateMedian3(uint32_t begin, uint32_t end, float dt, bool reset);
+
+        // Per channel
+        std::vector<float> m_inputs;
+        std::vector<float> m_values;
+        std::vector<float> m_latency;
+
+        size_t m_maxDepth = 0;
+        Table<OneEuroRow> m_oneEuro;
+        Table<LowPassRow> m_lowPass;
+        Table<SlewLimitRow> m_slewLimit;
+        Table<Median3Row> m_median3;
+
+        Timestamp m_lastTime;
+    };
+
+}
@@ -0,0 +1,109 @@
+#include "util/mapped_file.hpp"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace util
+{
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+#if defined(_WIN32)
+
+    bool MappedFile::Open(const std::string &path)
+    {
+        Close();
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == NULL)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file = file;
+        m_mapping = mapping;
+        m_data = static_cast<const uint8_t *>(data);
+        m_size = static_cast<size_t>(size.QuadPart);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file)
+            CloseHandle(m_file);
+        m_data = nullptr;
+        m_mapping = nullptr;
+        m_file = nullptr;
+        m_size = 0;
+    }
+
+#else
+
+    bool MappedFile::Open(const std::string &path)
+    {
+        Close();
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        m_data = static_cast<const uint8_t *>(data);
+        m_size = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data)
+            munmap(const_cast<uint8_t *>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+#endif
+
+}
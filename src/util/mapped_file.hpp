@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace util
+{
+
+    /// @brief Read-only memory mapping of a whole file
+    class MappedFile
+    {
+    public:
+        MappedFile() {}
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /// @brief Map a file, closing any previously mapped file
+        /// @return false if the file could not be opened or mapped
+        bool Open(const std::string &path);
+        void Close();
+
+        inline const uint8_t *GetData() const { return m_data; }
+        inline size_t GetSize() const { return m_size; }
+        inline bool IsOpen() const { return m_data != nullptr; }
+
+    private:
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+#if defined(_WIN32)
+        void *m_file = nullptr;
+        void *m_mapping = nullptr;
+#endif
+    };
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cmath>
+
+#include "util/fast_math.hpp"
+
+namespace util
+{
+
+    /// @brief Unit quaternion for rotations, kept free of the engine math
+    /// types so it can be used on raw pose data
+    struct Quaternion
+    {
+        float w = 1.0f;
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+
+        /// @brief Convert a rotation matrix given as m[row][col]
+        static Quaternion FromMatrix(const float m[3][3])
+        {
+            // Shepperd's method: pivot on the largest diagonal term so the
+            // square root is well away from zero. Each branch gets one
+            // component from the root and the rest from off-diagonal terms.
+            Quaternion q;
+            float trace = m[0][0] + m[1][1] + m[2][2];
+            if (trace > 0.0f)
+            {
+                float root = std::sqrt(1.0f + trace);
+                float inverse = 0.5f / root;
+                q.w = 0.5f * root;
+                q.x = (m[2][1] - m[1][2]) * inverse;
+                q.y = (m[0][2] - m[2][0]) * inverse;
+                q.z = (m[1][0] - m[0][1]) * inverse;
+            }
+            else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+            {
+                float root = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]);
+                float inverse = 0.5f / root;
+                q.w = (m[2][1] - m[1][2]) * inverse;
+                q.x = 0.5f * root;
+                q.y = (m[0][1] + m[1][0]) * inverse;
+                q.z = (m[0][2] + m[2][0]) * inverse;
+            }
+            else if (m[1][1] > m[2][2])
+            {
+                float root = std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]);
+                float inverse = 0.5f / root;
+                q.w = (m[0][2] - m[2][0]) * inverse;
+                q.x = (m[0][1] + m[1][0]) * inverse;
+                q.y = 0.5f * root;
+                q.z = (m[1][2] + m[2][1]) * inverse;
+            }
+            else
+            {
+                float root = std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]);
+                float inverse = 0.5f / root;
+                q.w = (m[1][0] - m[0][1]) * inverse;
+                q.x = (m[0][2] + m[2][0]) * inverse;
+                q.y = (m[1][2] + m[2][1]) * inverse;
+                q.z = 0.5f * root;
+            }
+            return q;
+        }
+
+        inline Quaternion Conjugate() const { return {w, -x, -y, -z}; }
+
+        inline float Dot(const Quaternion &other) const
+        {
+            return w * other.w + x * other.x + y * other.y + z * other.z;
+        }
+
+        inline Quaternion operator-() const { return {-w, -x, -y, -z}; }
+
+        inline Quaternion operator*(const Quaternion &b) const
+        {
+            return {w * b.w - x * b.x - y * b.y - z * b.z,
+                    w * b.x + x * b.w + y * b.z - z * b.y,
+                    w * b.y - x * b.z + y * b.w + z * b.x,
+                    w * b.z + x * b.y - y * b.x + z * b.w};
+        }
+
+        /// @brief Twist of a swing/twist decomposition about a unit axis:
+        /// the part of the rotation about that axis, such that this is the
+        /// swing times the twist and the swing's axis is perpendicular to
+        /// it. Identity for a half turn about a perpendicular axis, where
+        /// the twist is undefined.
+        Quaternion GetTwist(float ax, float ay, float az) const
+        {
+            float projection = x * ax + y * ay + z * az;
+            float lengthSquared = w * w + projection * projection;
+            if (lengthSquared < 1e-12f)
+                return Quaternion();
+            float inverse = 1.0f / std::sqrt(lengthSquared);
+            return {w * inverse, ax * projection * inverse, ay * projection * inverse, az * projection * inverse};
+        }
+
+        /// @brief Axis times angle in radians of the rotation, taking the
+        /// short way round. The angle comes from a polynomial arctangent, so
+        /// its error is bounded by FastAtanUnit()'s rather than growing with
+        /// the angle as a small angle approximation would.
+        void GetRotationVector(float &rx, float &ry, float &rz) const
+        {
+            float sign = w < 0.0f ? -1.0f : 1.0f;
+            float cosHalf = sign * w;
+            float sinHalfSquared = x * x + y * y + z * z;
+            float scale;
+            if (sinHalfSquared <= cosHalf * cosHalf)
+            {
+                // Up to a quarter turn, where the half angle is at most
+                // 45 deg, the angle is 2 atan(t) for the tangent t of the
+                // half angle, which needs no square root
+                float inverse = 1.0f / cosHalf;
+                scale = 2.0f * inverse * FastAtanRatio(sinHalfSquared * inverse * inverse);
+            }
+            else
+            {
+                float sinHalf = std::sqrt(sinHalfSquared);
+                scale = 2.0f * FastAtanPositive(sinHalf, cosHalf) / sinHalf;
+            }
+            scale *= sign;
+            rx = x * scale;
+            ry = y * scale;
+            rz = z * scale;
+        }
+    };
+
+}
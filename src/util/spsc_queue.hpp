@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace util
+{
+
+    /// @brief Bounded lock-free queue for exactly one producer thread and one
+    /// consumer thread. Capacity must be a power of two.
+    template <class T, size_t Capacity>
+    class SpscQueue
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                      "SpscQueue capacity must be a power of two");
+
+    public:
+        /// @brief Push an item. Must only be called from the producer thread.
+        /// @return false if the queue is full and the item was dropped
+        bool Push(const T &item)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_headCache == Capacity)
+            {
+                m_headCache = m_head.load(std::memory_order_acquire);
+                if (tail - m_headCache == Capacity)
+                    return false;
+            }
+            m_items[tail & kMask] = item;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief Pop the oldest item. Must only be called from the consumer
+        /// thread.
+        /// @return false if the queue is empty
+        bool Pop(T &item)
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tailCache)
+            {
+                m_tailCache = m_tail.load(std::memory_order_acquire);
+                if (head == m_tailCache)
+                    return false;
+            }
+            item = m_items[head & kMask];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief Approximate number of queued items, safe to call from any
+        /// thread
+        size_t GetSize() const
+        {
+            size_t head = m_head.load(std::memory_order_acquire);
+            size_t tail = m_tail.load(std::memory_order_acquire);
+            return tail - head;
+        }
+
+        static constexpr size_t GetCapacity() { return Capacity; }
+
+    private:
+        static constexpr size_t kMask = Capacity - 1;
+
+        // Consumer-owned cache line
+        alignas(64) std::atomic<size_t> m_head{0};
+        size_t m_tailCache = 0;
+
+        // Producer-owned cache line
+        alignas(64) std::atomic<size_t> m_tail{0};
+        size_t m_headCache = 0;
+
+        alignas(64) std::array<T, Capacity> m_items;
+    };
+
+}
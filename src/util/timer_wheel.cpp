@@ -0,0 +1,231 @@
+#include "util/timer_wheel.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace util
+{
+    namespace
+    {
+        inline uint32_t CountTrailingZeros(uint64_t value)
+        {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward64(&index, value);
+            return static_cast<uint32_t>(index);
+#else
+            return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+        }
+    }
+
+    TimerWheel::TimerWheel(Clock::duration resolution)
+        : m_resolution(resolution), m_origin(Clock::now())
+    {
+        for (auto &level : m_slots)
+            level.fill(kNone);
+    }
+
+    TimerWheel::TimerId TimerWheel::Schedule(Timestamp deadline, TimerListener *listener, uint32_t cookie)
+    {
+        uint32_t index;
+        if (!m_freeTimers.empty())
+        {
+            index = m_freeTimers.back();
+            m_freeTimers.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(m_timers.size());
+            m_timers.emplace_back();
+        }
+
+        Timer &timer = m_timers[index];
+        timer.deadline = deadline;
+        timer.tick = std::max(GetTick(deadline), m_currentTick);
+        timer.listener = listener;
+        timer.cookie = cookie;
+        timer.pending = true;
+        Insert(index);
+        m_pendingCount++;
+        return (static_cast<uint64_t>(timer.generation) << 32) | (index + 1);
+    }
+
+    bool TimerWheel::Cancel(TimerId id)
+    {
+        uint32_t index = static_cast<uint32_t>(id) - 1;
+        if (id == kInvalidTimer || index >= m_timers.size())
+            return false;
+        Timer &timer = m_timers[index];
+        if (!timer.pending || timer.generation != static_cast<uint32_t>(id >> 32))
+            return false;
+
+        Unlink(index);
+        timer.pending = false;
+        timer.generation++;
+        m_freeTimers.push_back(index);
+        m_pendingCount--;
+        return true;
+    }
+
+    void TimerWheel::Advance(Timestamp now)
+    {
+        uint64_t target = GetTick(now);
+        if (m_pendingCount == 0)
+        {
+            m_currentTick = std::max(m_currentTick, target);
+            return;
+        }
+
+        for (;;)
+        {
+            FireSlot(now);
+            if (m_currentTick >= target)
+                break;
+
+            // Skip to the next occupied slot of the lowest wheel, or to where
+            // it wraps and the wheels above cascade, whichever comes first
+            uint64_t next = (m_currentTick | kSlotMask) + 1;
+            uint32_t slot = static_cast<uint32_t>(m_currentTick & kSlotMask);
+            uint64_t later = m_occupied[0] & ~((2ull << slot) - 1);
+            if (later)
+                next = std::min(next, (m_currentTick & ~uint64_t(kSlotMask)) + CountTrailingZeros(later));
+            m_currentTick = std::min(next, target);
+
+            if ((m_currentTick & kSlotMask) == 0)
+            {
+                for (uint32_t level = 1; level < kLevelCount; level++)
+                {
+                    Cascade(level);
+                    if (((m_currentTick >> (kSlotBits * level)) & kSlotMask) != 0)
+                        break;
+                }
+            }
+        }
+    }
+
+    Timestamp TimerWheel::GetNextDeadline() const
+    {
+        if (m_pendingCount == 0)
+            return Timestamp::max();
+
+        uint32_t level = 0;
+        while (m_occupied[level] == 0)
+            level++;
+
+        // Slots of a wheel come due in order from the current one, which
+        // only level 0 can still hold timers for. Timers on wheels above
+        // are all due after the lowest wheel wraps.
+        uint32_t shift = kSlotBits * level;
+        uint32_t slot = static_cast<uint32_t>((m_currentTick >> shift) & kSlotMask);
+        uint64_t passed = level == 0 ? (1ull << slot) - 1 : (2ull << slot) - 1;
+        uint64_t later = m_occupied[level] & ~passed;
+        if (later)
+        {
+            Timestamp deadline = Timestamp::max();
+            for (uint32_t index = m_slots[level][CountTrailingZeros(later)]; index != kNone;
+                 index = m_timers[index].next)
+                deadline = std::min(deadline, m_timers[index].deadline);
+            return deadline;
+        }
+
+        // Only slots past the wrap are occupied, and they cascade from there
+        uint64_t wrapTick = ((m_currentTick >> (shift + kSlotBits)) + 1) << (shift + kSlotBits);
+        return m_origin + m_resolution * static_cast<int64_t>(wrapTick);
+    }
+
+    uint64_t TimerWheel::GetTick(Timestamp time) const
+    {
+        if (time <= m_origin)
+            return 0;
+        return static_cast<uint64_t>((time - m_origin) / m_resolution);
+    }
+
+    void TimerWheel::Insert(uint32_t index)
+    {
+        Timer &timer = m_timers[index];
+        uint64_t delta = timer.tick - m_currentTick;
+        uint32_t level = 0;
+        while (level + 1 < kLevelCount && delta >= (1ull << (kSlotBits * (level + 1))))
+            level++;
+
+        // Timers beyond the top wheel wait in its furthest slot and are
+        // placed again each time it cascades
+        uint64_t tick = timer.tick;
+        if (delta >= (1ull << (kSlotBits * kLevelCount)))
+            tick = m_currentTick + (1ull << (kSlotBits * kLevelCount)) - 1;
+
+        uint32_t slot = static_cast<uint32_t>((tick >> (kSlotBits * level)) & kSlotMask);
+        timer.level = static_cast<uint8_t>(level);
+        timer.slot = static_cast<uint8_t>(slot);
+        timer.prev = kNone;
+        timer.next = m_slots[level][slot];
+        if (timer.next != kNone)
+            m_timers[timer.next].prev = index;
+        m_slots[level][slot] = index;
+        m_occupied[level] |= 1ull << slot;
+    }
+
+    void TimerWheel::Unlink(uint32_t index)
+    {
+        Timer &timer = m_timers[index];
+        if (timer.prev != kNone)
+            m_timers[timer.prev].next = timer.next;
+        else
+            m_slots[timer.level][timer.slot] = timer.next;
+        if (timer.next != kNone)
+            m_timers[timer.next].prev = timer.prev;
+        if (m_slots[timer.level][timer.slot] == kNone)
+            m_occupied[timer.level] &= ~(1ull << timer.slot);
+    }
+
+    void TimerWheel::Cascade(uint32_t level)
+    {
+        uint32_t slot = static_cast<uint32_t>((m_currentTick >> (kSlotBits * level)) & kSlotMask);
+        uint32_t index = m_slots[level][slot];
+        m_slots[level][slot] = kNone;
+        m_occupied[level] &= ~(1ull << slot);
+        while (index != kNone)
+        {
+            uint32_t next = m_timers[index].next;
+            Insert(index);
+            index = next;
+        }
+    }
+
+    void TimerWheel::FireSlot(Timestamp now)
+    {
+        uint32_t slot = static_cast<uint32_t>(m_currentTick & kSlotMask);
+        m_firing.clear();
+        for (uint32_t index = m_slots[0][slot]; index != kNone; index = m_timers[index].next)
+        {
+            if (m_timers[index].deadline <= now)
+                m_firing.push_back(index);
+        }
+        if (m_firing.empty())
+            return;
+
+        std::sort(m_firing.begin(), m_firing.end(), [this](uint32_t a, uint32_t b)
+                  { return m_timers[a].deadline < m_timers[b].deadline; });
+
+        // Free the timers before calling out, since listeners may schedule
+        // new ones which reuse their entries
+        m_fired.clear();
+        for (uint32_t index : m_firing)
+        {
+            Timer &timer = m_timers[index];
+            m_fired.push_back({timer.listener, timer.cookie, timer.deadline});
+            Unlink(index);
+            timer.pending = false;
+            timer.generation++;
+            m_freeTimers.push_back(index);
+            m_pendingCount--;
+        }
+        for (const FiredTimer &fired : m_fired)
+            fired.listener->OnTimer(fired.cookie, fired.deadline);
+    }
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "util/timing.hpp"
+
+namespace util
+{
+
+    /// @brief Receives timers fired by a TimerWheel
+    class TimerListener
+    {
+    public:
+        virtual ~TimerListener() = default;
+
+        /// @param cookie value passed when the timer was scheduled
+        /// @param deadline the exact time the timer was scheduled for
+        virtual void OnTimer(uint32_t cookie, Timestamp deadline) = 0;
+    };
+
+    /// @brief Hierarchical timer wheel. Timers hash into 64-slot wheels by
+    /// how far away their deadline is, and cascade down a level each time the
+    /// wheel below wraps, so scheduling, cancelling and firing cost O(1) no
+    /// matter how many timers are pending. Slots only bucket timers; each
+    /// keeps its exact deadline and fires on the first Advance() at or past
+    /// it.
+    class TimerWheel
+    {
+    public:
+        using TimerId = uint64_t;
+        static constexpr TimerId kInvalidTimer = 0;
+
+        /// @param resolution width of a level 0 slot
+        explicit TimerWheel(Clock::duration resolution = std::chrono::microseconds(250));
+
+        /// @brief Schedule a timer. Deadlines in the past fire on the next
+        /// Advance().
+        TimerId Schedule(Timestamp deadline, TimerListener *listener, uint32_t cookie = 0);
+
+        /// @brief Cancel a pending timer. Ids of timers which already fired
+        /// or were cancelled are ignored.
+        /// @return true if the timer was pending
+        bool Cancel(TimerId id);
+
+        /// @brief Fire every timer with a deadline at or before now, in
+        /// deadline order within each slot
+        void Advance(Timestamp now);
+
+        /// @brief Earliest time a pending timer could fire: exact when the
+        /// lowest occupied wheel has a timer due before it wraps, otherwise
+        /// the time it wraps. Timestamp::max() if nothing is pending.
+        Timestamp GetNextDeadline() const;
+
+        inline size_t GetPendingCount() const { return m_pendingCount; }
+
+    private:
+        static constexpr uint32_t kSlotBits = 6;
+        static constexpr uint32_t kSlotCount = 1u << kSlotBits;
+        static constexpr uint32_t kSlotMask = kSlotCount - 1;
+        static constexpr uint32_t kLevelCount = 4;
+        static constexpr uint32_t kNone = UINT32_MAX;
+
+        struct Timer
+        {
+            Timestamp deadline;
+            uint64_t tick = 0;
+            TimerListener *listener = nullptr;
+            uint32_t cookie = 0;
+            uint32_t generation = 0;
+            uint32_t next = kNone;
+            uint32_t prev = kNone;
+            uint8_t level = 0;
+            uint8_t slot = 0;
+            bool pending = false;
+        };
+
+        struct FiredTimer
+        {
+            TimerListener *listener;
+            uint32_t cookie;
+            Timestamp deadline;
+        };
+
+        uint64_t GetTick(Timestamp time) const;
+        void Insert(uint32_t index);
+        void Unlink(uint32_t index);
+        void Cascade(uint32_t level);
+        void FireSlot(Timestamp now);
+
+        Clock::duration m_resolution;
+        Timestamp m_origin;
+        uint64_t m_currentTick = 0;
+        size_t m_pendingCount = 0;
+
+        std::vector<Timer> m_timers;
+        std::vector<uint32_t> m_freeTimers;
+        std::array<std::array<uint32_t, kSlotCount>, kLevelCount> m_slots;
+        std::array<uint64_t, kLevelCount> m_occupied = {};
+        std::vector<uint32_t> m_firing;
+        std::vector<FiredTimer> m_fired;
+    };
+
+}
@@ -0,0 +1,49 @@
+#include "util/timing.hpp"
+
+#include <thread>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+
+namespace util
+{
+
+    namespace
+    {
+        // How long before the deadline to stop sleeping and start spinning.
+        // Covers the worst-case oversleep with a 1 ms timer resolution.
+        const auto kSpinThreshold = std::chrono::microseconds(1500);
+    }
+
+    void SleepUntil(Clock::time_point deadline)
+    {
+        auto now = Clock::now();
+        if (deadline - now > kSpinThreshold)
+            std::this_thread::sleep_until(deadline - kSpinThreshold);
+        while (Clock::now() < deadline)
+            std::this_thread::yield();
+    }
+
+    void SetCurrentThreadPriorityHigh()
+    {
+#if defined(_WIN32)
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+#endif
+    }
+
+    ScopedTimerResolution::ScopedTimerResolution()
+    {
+#if defined(_WIN32)
+        timeBeginPeriod(1);
+#endif
+    }
+
+    ScopedTimerResolution::~ScopedTimerResolution()
+    {
+#if defined(_WIN32)
+        timeEndPeriod(1);
+#endif
+    }
+
+}
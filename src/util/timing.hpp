@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace util
+{
+
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Point on the monotonic clock. A default-constructed timestamp
+    /// means the time is unknown.
+    using Timestamp = Clock::time_point;
+
+    /// @brief Convert a (possibly negative) time in seconds to a clock
+    /// duration
+    inline Clock::duration SecondsToDuration(float seconds)
+    {
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float>(seconds));
+    }
+
+    /// @brief Block the calling thread until the given time. OS sleeps are too
+    /// coarse for sub-millisecond tick rates, so the last stretch is spun.
+    void SleepUntil(Clock::time_point deadline);
+
+    /// @brief Raise the scheduling priority of the calling thread
+    void SetCurrentThreadPriorityHigh();
+
+    /// @brief Requests 1 ms OS timer resolution for as long as it is alive
+    class ScopedTimerResolution
+    {
+    public:
+        ScopedTimerResolution();
+        ~ScopedTimerResolution();
+
+        ScopedTimerResolution(const ScopedTimerResolution &) = delete;
+        ScopedTimerResolution &operator=(const ScopedTimerResolution &) = delete;
+    };
+
+}
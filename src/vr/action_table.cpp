@@ -0,0 +1,25 @@
+#include "vr/action_table.hpp"
+
+ActionStateTable::Slot ActionStateTable::AddDigital(vr::VRActionHandle_t handle)
+{
+	Slot slot = static_cast<Slot>(m_digitalHandles.size());
+	m_digitalHandles.push_back(handle);
+	size_t words = (m_digitalHandles.size() + 63) / 64;
+	m_down.resize(words, 0);
+	m_pressed.resize(words, 0);
+	m_released.resize(words, 0);
+	m_digitalChangeTime.push_back(util::Timestamp());
+	return slot;
+}
+
+ActionStateTable::Slot ActionStateTable::AddAnalog(vr::VRActionHandle_t handle)
+{
+	Slot slot = static_cast<Slot>(m_analogHandles.size());
+	m_analogHandles.push_back(handle);
+	m_x.push_back(0.0f);
+	m_y.push_back(0.0f);
+	m_deltaX.push_back(0.0f);
+	m_deltaY.push_back(0.0f);
+	m_analogChangeTime.push_back(util::Timestamp());
+	return slot;
+}
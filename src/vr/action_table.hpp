@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <openvr.h>
+
+#include "util/timing.hpp"
+
+/// @brief Structure-of-arrays state for every action in an action set.
+/// Digital actions are packed 64 to a word so edges are computed with bitwise
+/// ops, and analog actions are stored as parallel coordinate arrays. All
+/// states are refreshed in one pass by Update(). Each action also records when
+/// its state last changed on the hardware, from the runtime's fUpdateTime.
+class ActionStateTable
+{
+public:
+	using Slot = uint32_t;
+
+	/// @brief Add a digital action
+	/// @return the slot index of the action's state
+	Slot AddDigital(vr::VRActionHandle_t handle);
+
+	/// @brief Add an analog action
+	/// @return the slot index of the action's state
+	Slot AddAnalog(vr::VRActionHandle_t handle);
+
+	/// @brief Read the state of every action from a source, which must
+	/// provide ReadDigital(slot, handle, InputDigitalActionData_t &) and
+	/// ReadAnalog(slot, handle, InputAnalogActionData_t &), each returning
+	/// false if the read failed.
+	/// @param now the time the runtime's action state was last updated,
+	/// which fUpdateTime values are relative to
+	template <class Source>
+	void Update(Source &source, util::Timestamp now);
+
+	inline bool IsDown(Slot slot) const { return TestBit(m_down, slot); }
+	inline bool IsPressed(Slot slot) const { return TestBit(m_pressed, slot); }
+	inline bool IsReleased(Slot slot) const { return TestBit(m_released, slot); }
+
+	inline float GetX(Slot slot) const { return m_x[slot]; }
+	inline float GetY(Slot slot) const { return m_y[slot]; }
+	inline float GetDeltaX(Slot slot) const { return m_deltaX[slot]; }
+	inline float GetDeltaY(Slot slot) const { return m_deltaY[slot]; }
+
+	/// @brief Time of the hardware change behind a digital action's state
+	inline util::Timestamp GetDigitalChangeTime(Slot slot) const { return m_digitalChangeTime[slot]; }
+
+	/// @brief Time of the hardware change behind an analog action's state
+	inline util::Timestamp GetAnalogChangeTime(Slot slot) const { return m_analogChangeTime[slot]; }
+
+	inline size_t GetDigitalCount() const { return m_digitalHandles.size(); }
+	inline size_t GetAnalogCount() const { return m_analogHandles.size(); }
+
+	/// @brief Packed down state of all digital actions, bit N of word N/64
+	inline const std::vector<uint64_t> &GetDownWords() const { return m_down; }
+
+private:
+	static inline bool TestBit(const std::vector<uint64_t> &words, Slot slot)
+	{
+		return (words[slot >> 6] >> (slot & 63)) & 1;
+	}
+
+	std::vector<vr::VRActionHandle_t> m_digitalHandles;
+	std::vector<uint64_t> m_down;
+	std::vector<uint64_t> m_pressed;
+	std::vector<uint64_t> m_released;
+	std::vector<util::Timestamp> m_digitalChangeTime;
+
+	std::vector<vr::VRActionHandle_t> m_analogHandles;
+	std::vector<float> m_x;
+	std::vector<float> m_y;
+	std::vector<float> m_deltaX;
+	std::vector<float> m_deltaY;
+	std::vector<util::Timestamp> m_analogChangeTime;
+};
+
+template <class Source>
+void ActionStateTable::Update(Source &source, util::Timestamp now)
+{
+	const size_t digitalCount = m_digitalHandles.size();
+	for (size_t word = 0; word < m_down.size(); word++)
+	{
+		const size_t begin = word * 64;
+		const size_t end = begin + 64 < digitalCount ? begin + 64 : digitalCount;
+		const uint64_t prev = m_down[word];
+		uint64_t bits = 0;
+		for (size_t slot = begin; slot < end; slot++)
+		{
+			const uint64_t mask = uint64_t(1) << (slot - begin);
+			vr::InputDigitalActionData_t data;
+			bool valid = source.ReadDigital(static_cast<Slot>(slot), m_digitalHandles[slot], data);
+			bool down = valid && data.bActive && data.bState;
+			if (down)
+				bits |= mask;
+
+			// Only edges need a time. Changes not reported by the runtime
+			// (e.g. the action going inactive) are stamped now.
+			if (down != ((prev & mask) != 0))
+			{
+				m_digitalChangeTime[slot] = valid && data.bChanged
+												? now + util::SecondsToDuration(data.fUpdateTime)
+												: now;
+			}
+		}
+		m_down[word] = bits;
+		m_pressed[word] = bits & ~prev;
+		m_released[word] = ~bits & prev;
+	}
+
+	const size_t analogCount = m_analogHandles.size();
+	for (size_t slot = 0; slot < analogCount; slot++)
+	{
+		vr::InputAnalogActionData_t data;
+		float x = 0.0f;
+		float y = 0.0f;
+		bool active = source.ReadAnalog(static_cast<Slot>(slot), m_analogHandles[slot], data) && data.bActive;
+		if (active)
+		{
+			x = data.x;
+			y = data.y;
+		}
+		if (x != m_x[slot] || y != m_y[slot])
+			m_analogChangeTime[slot] = active ? now + util::SecondsToDuration(data.fUpdateTime) : now;
+		m_deltaX[slot] = x - m_x[slot];
+		m_deltaY[slot] = y - m_y[slot];
+		m_x[slot] = x;
+		m_y[slot] = y;
+	}
+}
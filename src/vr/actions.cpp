@@ -2,12 +2,15 @@
 
 #include <cstdio>
 #include <iostream>
+#include <stdexcept>
+#include <typeinfo>
 #include "rapidjson/filewritestream.h"
 #include "rapidjson/document.h"
 
-ActionSet::ActionSet(const std::string &identifier)
+ActionSet::ActionSet(std::shared_ptr<InputBackend> backend, const std::string &identifier)
+	: m_backend(backend)
 {
-	vr::VRInput()->GetActionSetHandle(identifier.c_str(), &handle);
+	handle = m_backend->GetActionSetHandle(identifier);
 }
 
 std::shared_ptr<Action> ActionSet::GetAction(const std::string &name)
@@ -20,76 +23,71 @@ std::shared_ptr<Action> ActionSet::GetAction(const std::string &name)
 
 void ActionSet::AddAction(std::shared_ptr<Action> action)
 {
+	// An action already added keeps its table slot, so the table never
+	// holds a second slot for it
+	auto existing = m_actions.find(action->identifier);
+	if (existing != m_actions.end())
+	{
+		const Action &added = *existing->second;
+		const Action &adding = *action;
+		if (typeid(added) != typeid(adding))
+			CMG_LOG_ERROR() << "Action " << action->identifier << " was already added with another type";
+		return;
+	}
+
+	CMG_LOG_DEBUG() << "Loading action: " << action->identifier;
+	action->handle = m_backend->GetActionHandle(action->identifier);
+	if (action->handle == vr::k_ulInvalidActionHandle)
+		throw std::runtime_error("INPUT ERROR");
+	action->Register(m_table);
 	m_actions[action->identifier] = action;
 }
 
-void ActionSet::Update()
+void ActionSet::GetSlotNames(std::vector<std::string> &digitalNames, std::vector<std::string> &analogNames) const
 {
-	vr::VRActiveActionSet_t actionSet = {0};
-	actionSet.ulActionSet = handle;
-	vr::VRInput()->UpdateActionState(&actionSet, sizeof(actionSet), 1);
-
-	for (auto it : m_actions)
+	digitalNames.assign(m_table.GetDigitalCount(), std::string());
+	analogNames.assign(m_table.GetAnalogCount(), std::string());
+	for (auto &it : m_actions)
 	{
-		it.second->Update();
+		if (auto button = std::dynamic_pointer_cast<ButtonAction>(it.second))
+			digitalNames[button->GetSlot()] = it.first;
+		else if (auto joystick = std::dynamic_pointer_cast<JoystickAction>(it.second))
+			analogNames[joystick->GetSlot()] = it.first;
 	}
 }
 
-Action::Action(const std::string &identifier) : identifier(identifier)
+void ActionSet::Update()
 {
-	CMG_LOG_DEBUG() << "Loading action: " << identifier;
-	vr::EVRInputError error = vr::VRInput()->GetActionHandle(identifier.c_str(), &handle);
-	if (error != vr::VRInputError_None)
-	{
-		CMG_LOG_ERROR() << "  ERROR " << error;
-		throw std::exception("INPUT ERROR");
-	}
+	m_backend->UpdateActions(handle, m_table);
 }
 
-void ButtonAction::Update()
+void ButtonAction::Register(ActionStateTable &table)
 {
-	vr::InputDigitalActionData_t actionData;
-	vr::VRInput()->GetDigitalActionData(handle, &actionData, sizeof(actionData), vr::k_ulInvalidInputValueHandle);
-	bool downPrev = down;
-	down = actionData.bActive && actionData.bState;
-	pressed = down && !downPrev;
-	released = !down && downPrev;
+	m_table = &table;
+	m_slot = table.AddDigital(handle);
 }
 
 std::ostream &ButtonAction::DebugString(std::ostream &stream) const
 {
 	stream << identifier << ": ";
-	if (pressed)
+	if (IsPressed())
 		stream << "PRESSED";
-	if (released)
+	if (IsReleased())
 		stream << "RELEASED";
 	else
-		stream << (down ? "DOWN" : "UP");
+		stream << (IsDown() ? "DOWN" : "UP");
 	return stream;
 }
 
-void JoystickAction::Update()
+void JoystickAction::Register(ActionStateTable &table)
 {
-	vr::InputAnalogActionData_t analogData;
-	auto error = vr::VRInput()->GetAnalogActionData(handle,
-													&analogData, sizeof(analogData), vr::k_ulInvalidInputValueHandle);
-
-	Vector2f positionPrev = position;
-	if (error == vr::VRInputError_None && analogData.bActive)
-	{
-		position.x = analogData.x;
-		position.y = analogData.y;
-	}
-	else
-	{
-		position = Vector2f::ZERO;
-	}
-
-	delta = position - positionPrev;
+	m_table = &table;
+	m_slot = table.AddAnalog(handle);
 }
 
 std::ostream &JoystickAction::DebugString(std::ostream &stream) const
 {
+	Vector2f position = GetPosition();
 	stream << identifier << ": x=" << position.x << ", y=" << position.y;
 	return stream;
 }
@@ -6,18 +6,26 @@
 #include <iostream>
 #include <array>
 #include <map>
+#include <vector>
 
 #include <openvr.h>
 #include <cmgCore/cmg_core.h>
 #include <cmgMath/cmg_math.h>
 
-/// @brief Base class for a VR action bind
+#include "vr/action_table.hpp"
+#include "vr/input_backend.hpp"
+
+/// @brief Base class for a VR action bind. State is stored in the owning
+/// action set's ActionStateTable; actions are views onto their slot in it.
+/// The handle is resolved when the action is added to an action set.
 class Action
 {
 public:
-	explicit Action(const std::string &identifier);
+	explicit Action(const std::string &identifier) : identifier(identifier) {}
 
-	virtual void Update() {}
+	/// @brief Allocate this action's state in the table. Called when the
+	/// action is added to an action set.
+	virtual void Register(ActionStateTable &table) {}
 
 	virtual std::ostream &DebugString(std::ostream &stream) const
 	{
@@ -35,11 +43,17 @@ class JoystickAction : public Action
 public:
 	explicit JoystickAction(const std::string &identifier) : Action(identifier) {}
 
-	virtual void Update() override;
+	virtual void Register(ActionStateTable &table) override;
 	virtual std::ostream &DebugString(std::ostream &stream) const override;
 
-	Vector2f position = Vector2f::ZERO;
-	Vector2f delta = Vector2f::ZERO;
+	inline Vector2f GetPosition() const { return Vector2f(m_table->GetX(m_slot), m_table->GetY(m_slot)); }
+	inline Vector2f GetDelta() const { return Vector2f(m_table->GetDeltaX(m_slot), m_table->GetDeltaY(m_slot)); }
+	inline util::Timestamp GetChangeTime() const { return m_table->GetAnalogChangeTime(m_slot); }
+	inline ActionStateTable::Slot GetSlot() const { return m_slot; }
+
+private:
+	const ActionStateTable *m_table = nullptr;
+	ActionStateTable::Slot m_slot = 0;
 };
 
 /// @brief A binary button action, that can be pressed/released
@@ -48,12 +62,20 @@ class ButtonAction : public Action
 public:
 	explicit ButtonAction(const std::string &identifier) : Action(identifier) {}
 
-	virtual void Update() override;
+	virtual void Register(ActionStateTable &table) override;
 	virtual std::ostream &DebugString(std::ostream &stream) const override;
 
-	bool down = false;
-	bool pressed = false;
-	bool released = false;
+	inline bool IsDown() const { return m_table->IsDown(m_slot); }
+	inline bool IsPressed() const { return m_table->IsPressed(m_slot); }
+	inline bool IsReleased() const { return m_table->IsReleased(m_slot); }
+	inline util::Timestamp GetChangeTime() const { return m_table->GetDigitalChangeTime(m_slot); }
+
+	inline const ActionStateTable &GetTable() const { return *m_table; }
+	inline ActionStateTable::Slot GetSlot() const { return m_slot; }
+
+private:
+	const ActionStateTable *m_table = nullptr;
+	ActionStateTable::Slot m_slot = 0;
 };
 
 class HapticAction : public Action
@@ -67,10 +89,12 @@ class ActionSet
 public:
 	vr::VRActionSetHandle_t handle = vr::k_ulInvalidActionSetHandle;
 
-	ActionSet(const std::string &identifier);
+	ActionSet(std::shared_ptr<InputBackend> backend, const std::string &identifier);
 
 	Error Load(const Path &path);
 
+	/// @brief Add an action and give it a slot in the state table. An
+	/// identifier which was already added is skipped.
 	void AddAction(std::shared_ptr<Action> action);
 	std::shared_ptr<Action> GetAction(const std::string &name);
 
@@ -83,9 +107,17 @@ public:
 		return std::dynamic_pointer_cast<T>(action);
 	}
 
+	/// @brief Read the current state of all actions from the backend
 	void Update();
+
+	/// @brief Get the identifier of the action in each table slot
+	void GetSlotNames(std::vector<std::string> &digitalNames, std::vector<std::string> &analogNames) const;
+
 	inline std::map<std::string, std::shared_ptr<Action>> &GetActions() { return m_actions; }
+	inline const ActionStateTable &GetTable() const { return m_table; }
 
 private:
+	std::shared_ptr<InputBackend> m_backend;
 	std::map<std::string, std::shared_ptr<Action>> m_actions;
+	ActionStateTable m_table;
 };
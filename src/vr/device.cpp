@@ -1 +1,17 @@
-#include "vr/device.hpp"
\ No newline at end of file
+#include "vr/device.hpp"
+
+#include <vector>
+
+std::string GetTrackedDeviceString(vr::IVRSystem *system,
+								   vr::TrackedDeviceIndex_t index,
+								   vr::TrackedDeviceProperty prop,
+								   vr::TrackedPropertyError *error)
+{
+	uint32_t requiredBufferLength = system->GetStringTrackedDeviceProperty(index, prop, nullptr, 0, error);
+	if (requiredBufferLength == 0)
+		return "";
+
+	std::vector<char> buffer(requiredBufferLength);
+	system->GetStringTrackedDeviceProperty(index, prop, buffer.data(), requiredBufferLength, error);
+	return buffer.data();
+}
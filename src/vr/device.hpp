@@ -8,16 +8,40 @@
 #include <openvr.h>
 #include <cmgMath/cmg_math.h>
 
-/// @brief State of a VR device/tracker
+#include "util/timing.hpp"
+
+/// @brief Per-tick state of a VR device/tracker. Kept free of strings so a
+/// pass over all devices stays compact; descriptive properties are in
+/// DeviceInfo.
 class VrDevice
 {
 public:
-	std::string name;
-	std::string type;
 	uint32_t index = 0;
 	Vector3f position = Vector3f::ZERO;
 	Vector3f velocity = Vector3f::ZERO;
+	Vector3f angularVelocity = Vector3f::ZERO;
 	Matrix3f orientation = Matrix3f::IDENTITY;
+	util::Timestamp poseTime;
 	bool connected = false;
 	bool poseValid = false;
 };
+
+/// @brief Descriptive properties of a VR device, which only change on device
+/// activation and role change events
+struct DeviceInfo
+{
+	vr::ETrackedDeviceClass deviceClass = vr::TrackedDeviceClass_Invalid;
+	vr::ETrackedControllerRole role = vr::TrackedControllerRole_Invalid;
+	std::string type;
+	std::string serialNumber;
+
+	/// @brief Key used to look up per-device settings in the bind config
+	/// ("hmd", "left", "right" or "default")
+	std::string settingsKey = "default";
+};
+
+/// @brief Get a string tracked device property as a std::string
+std::string GetTrackedDeviceString(vr::IVRSystem *system,
+								   vr::TrackedDeviceIndex_t index,
+								   vr::TrackedDeviceProperty prop,
+								   vr::TrackedPropertyError *error = nullptr);
@@ -0,0 +1,176 @@
+#include "vr/device_registry.hpp"
+
+#include <algorithm>
+#include <cmgCore/cmg_core.h>
+
+void DeviceRegistry::DiscoverAll()
+{
+	for (vr::TrackedDeviceIndex_t index = 0; index < vr::k_unMaxTrackedDeviceCount; ++index)
+	{
+		if (m_backend->GetDeviceClass(index) != vr::TrackedDeviceClass_Invalid)
+			Activate(index);
+	}
+}
+
+bool DeviceRegistry::HandleEvent(const vr::VREvent_t &event)
+{
+	vr::TrackedDeviceIndex_t index = event.trackedDeviceIndex;
+	switch (event.eventType)
+	{
+	case vr::VREvent_TrackedDeviceActivated:
+		if (index >= vr::k_unMaxTrackedDeviceCount)
+			return false;
+		Activate(index);
+		return true;
+	case vr::VREvent_TrackedDeviceDeactivated:
+		if (index >= vr::k_unMaxTrackedDeviceCount)
+			return false;
+		Deactivate(index);
+		return true;
+	case vr::VREvent_TrackedDeviceRoleChanged:
+		// Sent globally rather than for a particular device, and a role
+		// change on one hand usually moves the other too
+		for (auto activeIndex : m_activeIndices)
+			RefreshInfo(activeIndex);
+		return true;
+	default:
+		return false;
+	}
+}
+
+void DeviceRegistry::UpdatePoses(const PoseArray &poses, util::Timestamp sampleTime)
+{
+	for (auto index : m_activeIndices)
+	{
+		const vr::TrackedDevicePose_t &pose = poses[index];
+		VrDevice &device = m_devices[index];
+		device.connected = pose.bDeviceIsConnected;
+		device.poseValid = pose.bPoseIsValid;
+		if (!device.poseValid)
+			continue;
+
+		device.poseTime = sampleTime;
+		const vr::HmdMatrix34_t &m = pose.mDeviceToAbsoluteTracking;
+		device.position.x = m.m[0][3];
+		device.position.y = m.m[1][3];
+		device.position.z = m.m[2][3];
+		device.velocity.x = pose.vVelocity.v[0];
+		device.velocity.y = pose.vVelocity.v[1];
+		device.velocity.z = pose.vVelocity.v[2];
+		device.angularVelocity.x = pose.vAngularVelocity.v[0];
+		device.angularVelocity.y = pose.vAngularVelocity.v[1];
+		device.angularVelocity.z = pose.vAngularVelocity.v[2];
+		for (size_t col = 0; col < 3; col++)
+		{
+			for (size_t row = 0; row < 3; row++)
+				device.orientation.c[col][row] = m.m[row][col];
+		}
+	}
+}
+
+VrDevice *DeviceRegistry::GetController(vr::ETrackedControllerRole role)
+{
+	vr::TrackedDeviceIndex_t index = vr::k_unTrackedDeviceIndexInvalid;
+	if (role == vr::TrackedControllerRole_LeftHand)
+		index = m_leftIndex;
+	else if (role == vr::TrackedControllerRole_RightHand)
+		index = m_rightIndex;
+	if (index == vr::k_unTrackedDeviceIndexInvalid)
+		return nullptr;
+	return &m_devices[index];
+}
+
+VrDevice *DeviceRegistry::FindDevice(const std::string &settingsKey)
+{
+	for (auto index : m_activeIndices)
+	{
+		if (m_info[index].settingsKey == settingsKey)
+			return &m_devices[index];
+	}
+	return nullptr;
+}
+
+void DeviceRegistry::Activate(vr::TrackedDeviceIndex_t index)
+{
+	if (!m_active[index])
+	{
+		m_active[index] = true;
+		m_devices[index] = VrDevice();
+		m_devices[index].index = index;
+		m_activeIndices.insert(
+			std::upper_bound(m_activeIndices.begin(), m_activeIndices.end(), index), index);
+	}
+	RefreshInfo(index);
+	CMG_LOG_INFO() << "New Device: " << "index=" << index << ", type=\"" << m_info[index].type
+				   << "\", serial=\"" << m_info[index].serialNumber << "\"";
+}
+
+void DeviceRegistry::Deactivate(vr::TrackedDeviceIndex_t index)
+{
+	if (!m_active[index])
+		return;
+	CMG_LOG_INFO() << "Device Removed: " << "index=" << index << ", type=\"" << m_info[index].type << "\"";
+	m_active[index] = false;
+	m_devices[index].connected = false;
+	m_devices[index].poseValid = false;
+	m_info[index] = DeviceInfo();
+	m_activeIndices.erase(
+		std::remove(m_activeIndices.begin(), m_activeIndices.end(), index), m_activeIndices.end());
+	if (m_leftIndex == index)
+		m_leftIndex = vr::k_unTrackedDeviceIndexInvalid;
+	if (m_rightIndex == index)
+		m_rightIndex = vr::k_unTrackedDeviceIndexInvalid;
+}
+
+void DeviceRegistry::RefreshInfo(vr::TrackedDeviceIndex_t index)
+{
+	DeviceInfo &info = m_info[index];
+	info.deviceClass = m_backend->GetDeviceClass(index);
+	info.role = vr::TrackedControllerRole_Invalid;
+	info.settingsKey = "default";
+	if (info.serialNumber.empty())
+		info.serialNumber = m_backend->GetDeviceString(index, vr::Prop_SerialNumber_String);
+
+	if (m_leftIndex == index)
+		m_leftIndex = vr::k_unTrackedDeviceIndexInvalid;
+	if (m_rightIndex == index)
+		m_rightIndex = vr::k_unTrackedDeviceIndexInvalid;
+
+	switch (info.deviceClass)
+	{
+	case vr::TrackedDeviceClass_Controller:
+	{
+		info.type = "Controller";
+		info.role = m_backend->GetControllerRole(index);
+		if (info.role == vr::TrackedControllerRole_LeftHand)
+		{
+			info.type = "Controller (Left)";
+			info.settingsKey = "left";
+			m_leftIndex = index;
+		}
+		else if (info.role == vr::TrackedControllerRole_RightHand)
+		{
+			info.type = "Controller (Right)";
+			info.settingsKey = "right";
+			m_rightIndex = index;
+		}
+		break;
+	}
+	case vr::TrackedDeviceClass_HMD:
+		info.type = "HMD";
+		info.settingsKey = "hmd";
+		break;
+	case vr::TrackedDeviceClass_Invalid:
+		info.type = "Invalid";
+		break;
+	case vr::TrackedDeviceClass_GenericTracker:
+		info.type = "Generic Tracker";
+		break;
+	case vr::TrackedDeviceClass_TrackingReference:
+		info.type = "Tracking Reference";
+		break;
+	default:
+		info.type = "Unknown";
+		break;
+	}
+}
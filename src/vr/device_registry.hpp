@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <openvr.h>
+
+#include "vr/device.hpp"
+#include "vr/input_backend.hpp"
+
+/// @brief Fixed-size table of all tracked devices, indexed by
+/// TrackedDeviceIndex_t. Device properties are only queried when the runtime
+/// reports a device being activated, deactivated or changing role, so the
+/// per-tick work is copying poses into the active devices.
+class DeviceRegistry
+{
+public:
+	using PoseArray = std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount>;
+
+	explicit DeviceRegistry(InputBackend *backend) : m_backend(backend) {}
+
+	/// @brief Scan every device slot. Called once at startup, since devices
+	/// that are already connected won't send activation events.
+	void DiscoverAll();
+
+	/// @brief Handle a VR event
+	/// @return true if any device's properties changed
+	bool HandleEvent(const vr::VREvent_t &event);
+
+	/// @brief Copy poses into every active device
+	/// @param sampleTime when the poses were fetched from the runtime
+	void UpdatePoses(const PoseArray &poses, util::Timestamp sampleTime);
+
+	inline VrDevice &GetDevice(vr::TrackedDeviceIndex_t index) { return m_devices[index]; }
+	inline const DeviceInfo &GetInfo(vr::TrackedDeviceIndex_t index) const { return m_info[index]; }
+
+	/// @brief Indices of all active devices, in ascending order
+	inline const std::vector<vr::TrackedDeviceIndex_t> &GetActiveIndices() const { return m_activeIndices; }
+
+	/// @brief Get the controller for a hand, or null if there isn't one
+	VrDevice *GetController(vr::ETrackedControllerRole role);
+
+	/// @brief Get the first active device with a settings key ("hmd",
+	/// "left" or "right"), or null if there isn't one
+	VrDevice *FindDevice(const std::string &settingsKey);
+
+private:
+	void Activate(vr::TrackedDeviceIndex_t index);
+	void Deactivate(vr::TrackedDeviceIndex_t index);
+	void RefreshInfo(vr::TrackedDeviceIndex_t index);
+
+	InputBackend *m_backend = nullptr;
+	std::array<VrDevice, vr::k_unMaxTrackedDeviceCount> m_devices;
+	std::array<DeviceInfo, vr::k_unMaxTrackedDeviceCount> m_info;
+	std::array<bool, vr::k_unMaxTrackedDeviceCount> m_active = {};
+	std::vector<vr::TrackedDeviceIndex_t> m_activeIndices;
+	vr::TrackedDeviceIndex_t m_leftIndex = vr::k_unTrackedDeviceIndexInvalid;
+	vr::TrackedDeviceIndex_t m_rightIndex = vr::k_unTrackedDeviceIndexInvalid;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+
+#include <openvr.h>
+
+#include "vr/action_table.hpp"
+#include "vr/pose_prediction.hpp"
+#include "util/timing.hpp"
+
+/// @brief Source of action state, device poses and device events. The
+/// mapping core only talks to the VR runtime through this, so it can also run
+/// from a recorded trace or generated input with no headset attached.
+class InputBackend
+{
+public:
+	virtual ~InputBackend() {}
+
+	/// @return the action set's handle, or k_ulInvalidActionSetHandle
+	virtual vr::VRActionSetHandle_t GetActionSetHandle(const std::string &path) = 0;
+
+	/// @return the action's handle, or k_ulInvalidActionHandle
+	virtual vr::VRActionHandle_t GetActionHandle(const std::string &path) = 0;
+
+	/// @brief Advance to the next tick of input. Backends that pace their
+	/// own ticks block here until it is due.
+	/// @return false once input has ended
+	virtual bool BeginTick() { return true; }
+
+	/// @brief Whether BeginTick() paces ticks, so the caller shouldn't
+	virtual bool PacesTicks() const { return false; }
+
+	/// @brief Refresh the state of every action in an action set's table
+	virtual void UpdateActions(vr::VRActionSetHandle_t actionSet, ActionStateTable &table) = 0;
+
+	/// @brief Get poses for every device slot
+	/// @return the time the poses were sampled
+	virtual util::Timestamp GetPoses(const PosePredictor::PredictionArray &predictions,
+									 PosePredictor::PoseArray &poses) = 0;
+
+	/// @brief Whether SampleLatestPose() works
+	virtual bool CanSampleLatestPose() const { return false; }
+
+	/// @brief Get the newest pose of one device straight from the runtime.
+	/// May be called from any thread, for late latching. Backends which
+	/// advance input a tick at a time can't support it.
+	/// @return false if the pose couldn't be sampled
+	virtual bool SampleLatestPose(vr::TrackedDeviceIndex_t index, const PosePrediction &prediction,
+								  vr::TrackedDevicePose_t &pose) { return false; }
+
+	/// @brief Pop the next pending event
+	/// @return false if there are no more events
+	virtual bool PollNextEvent(vr::VREvent_t &event) { return false; }
+
+	virtual vr::ETrackedDeviceClass GetDeviceClass(vr::TrackedDeviceIndex_t index) = 0;
+	virtual vr::ETrackedControllerRole GetControllerRole(vr::TrackedDeviceIndex_t index) = 0;
+	virtual std::string GetDeviceString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop) = 0;
+};
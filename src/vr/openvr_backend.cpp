@@ -0,0 +1,101 @@
+#include "vr/openvr_backend.hpp"
+
+#include <array>
+
+#include <cmgCore/cmg_core.h>
+
+#include "vr/device.hpp"
+
+namespace
+{
+	/// @brief Reads action states from the OpenVR input interface
+	struct OpenVrActionSource
+	{
+		vr::IVRInput *input;
+
+		inline bool ReadDigital(uint32_t slot, vr::VRActionHandle_t handle, vr::InputDigitalActionData_t &data)
+		{
+			return input->GetDigitalActionData(handle, &data, sizeof(data),
+											   vr::k_ulInvalidInputValueHandle) == vr::VRInputError_None;
+		}
+
+		inline bool ReadAnalog(uint32_t slot, vr::VRActionHandle_t handle, vr::InputAnalogActionData_t &data)
+		{
+			return input->GetAnalogActionData(handle, &data, sizeof(data),
+											  vr::k_ulInvalidInputValueHandle) == vr::VRInputError_None;
+		}
+	};
+}
+
+vr::VRActionSetHandle_t OpenVrBackend::GetActionSetHandle(const std::string &path)
+{
+	vr::VRActionSetHandle_t handle = vr::k_ulInvalidActionSetHandle;
+	vr::VRInput()->GetActionSetHandle(path.c_str(), &handle);
+	return handle;
+}
+
+vr::VRActionHandle_t OpenVrBackend::GetActionHandle(const std::string &path)
+{
+	vr::VRActionHandle_t handle = vr::k_ulInvalidActionHandle;
+	vr::EVRInputError error = vr::VRInput()->GetActionHandle(path.c_str(), &handle);
+	if (error != vr::VRInputError_None)
+	{
+		CMG_LOG_ERROR() << "  ERROR " << error;
+		return vr::k_ulInvalidActionHandle;
+	}
+	return handle;
+}
+
+void OpenVrBackend::UpdateActions(vr::VRActionSetHandle_t actionSet, ActionStateTable &table)
+{
+	vr::VRActiveActionSet_t activeSet = {0};
+	activeSet.ulActionSet = actionSet;
+	vr::VRInput()->UpdateActionState(&activeSet, sizeof(activeSet), 1);
+	util::Timestamp updateTime = util::Clock::now();
+
+	OpenVrActionSource source = {vr::VRInput()};
+	table.Update(source, updateTime);
+}
+
+util::Timestamp OpenVrBackend::GetPoses(const PosePredictor::PredictionArray &predictions,
+										PosePredictor::PoseArray &poses)
+{
+	util::Timestamp sampleTime = util::Clock::now();
+	PosePredictor::GetPoses(m_system, vr::TrackingUniverseStanding, predictions, poses);
+	return sampleTime;
+}
+
+bool OpenVrBackend::SampleLatestPose(vr::TrackedDeviceIndex_t index, const PosePrediction &prediction,
+									 vr::TrackedDevicePose_t &pose)
+{
+	// Only fetch poses up to the device asked for
+	if (index >= vr::k_unMaxTrackedDeviceCount)
+		return false;
+	std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> poses;
+	float seconds = prediction.mode == PredictionMode::kRuntime ? prediction.seconds : 0.0f;
+	m_system->GetDeviceToAbsoluteTrackingPose(vr::TrackingUniverseStanding, seconds, poses.data(), index + 1);
+	pose = poses[index];
+	if (prediction.mode == PredictionMode::kExtrapolate)
+		PosePredictor::Extrapolate(pose, prediction.seconds);
+	return pose.bPoseIsValid;
+}
+
+bool OpenVrBackend::PollNextEvent(vr::VREvent_t &event)
+{
+	return m_system->PollNextEvent(&event, sizeof(event));
+}
+
+vr::ETrackedDeviceClass OpenVrBackend::GetDeviceClass(vr::TrackedDeviceIndex_t index)
+{
+	return m_system->GetTrackedDeviceClass(index);
+}
+
+vr::ETrackedControllerRole OpenVrBackend::GetControllerRole(vr::TrackedDeviceIndex_t index)
+{
+	return m_system->GetControllerRoleForTrackedDeviceIndex(index);
+}
+
+std::string OpenVrBackend::GetDeviceString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop)
+{
+	return GetTrackedDeviceString(m_system, index, prop);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <openvr.h>
+
+#include "vr/input_backend.hpp"
+
+/// @brief Input backend for the SteamVR runtime
+class OpenVrBackend : public InputBackend
+{
+public:
+	/// @param system an initialized runtime, which the caller shuts down
+	explicit OpenVrBackend(vr::IVRSystem *system) : m_system(system) {}
+
+	virtual vr::VRActionSetHandle_t GetActionSetHandle(const std::string &path) override;
+	virtual vr::VRActionHandle_t GetActionHandle(const std::string &path) override;
+	virtual void UpdateActions(vr::VRActionSetHandle_t actionSet, ActionStateTable &table) override;
+	virtual util::Timestamp GetPoses(const PosePredictor::PredictionArray &predictions,
+									 PosePredictor::PoseArray &poses) override;
+	virtual bool CanSampleLatestPose() const override { return true; }
+	virtual bool SampleLatestPose(vr::TrackedDeviceIndex_t index, const PosePrediction &prediction,
+								  vr::TrackedDevicePose_t &pose) override;
+	virtual bool PollNextEvent(vr::VREvent_t &event) override;
+	virtual vr::ETrackedDeviceClass GetDeviceClass(vr::TrackedDeviceIndex_t index) override;
+	virtual vr::ETrackedControllerRole GetControllerRole(vr::TrackedDeviceIndex_t index) override;
+	virtual std::string GetDeviceString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop) override;
+
+private:
+	vr::IVRSystem *m_system = nullptr;
+};
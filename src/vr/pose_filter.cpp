@@ -0,0 +1,106 @@
+#include "vr/pose_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	void Normalize(float v[3])
+	{
+		float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		if (length > 0.0f)
+		{
+			v[0] /= length;
+			v[1] /= length;
+			v[2] /= length;
+		}
+	}
+
+	void Cross(const float a[3], const float b[3], float result[3])
+	{
+		result[0] = a[1] * b[2] - a[2] * b[1];
+		result[1] = a[2] * b[0] - a[0] * b[2];
+		result[2] = a[0] * b[1] - a[1] * b[0];
+	}
+}
+
+void PoseFilter::Clear()
+{
+	m_bank.Clear();
+	m_devices.clear();
+	m_firstChannel.fill(kUnfiltered);
+}
+
+void PoseFilter::SetFilter(vr::TrackedDeviceIndex_t index, const util::FilterChain &chain)
+{
+	if (chain.empty() || m_firstChannel[index] != kUnfiltered)
+		return;
+	m_firstChannel[index] = static_cast<uint32_t>(m_bank.GetChannelCount());
+	for (uint32_t channel = 0; channel < kChannelsPerDevice; channel++)
+		m_bank.AddChannel(chain);
+	m_devices.push_back(index);
+}
+
+void PoseFilter::Apply(DeviceRegistry &devices, util::Timestamp sampleTime)
+{
+	if (m_devices.empty())
+		return;
+
+	for (auto index : m_devices)
+	{
+		const VrDevice &device = devices.GetDevice(index);
+		if (!device.poseValid)
+			continue;
+		uint32_t first = m_firstChannel[index];
+		m_bank.SetInput(first + 0, device.position.x);
+		m_bank.SetInput(first + 1, device.position.y);
+		m_bank.SetInput(first + 2, device.position.z);
+		for (uint32_t row = 0; row < 3; row++)
+		{
+			m_bank.SetInput(first + 3 + row, device.orientation.c[1][row]);
+			m_bank.SetInput(first + 6 + row, device.orientation.c[2][row]);
+		}
+	}
+
+	m_bank.Update(sampleTime);
+
+	for (auto index : m_devices)
+	{
+		VrDevice &device = devices.GetDevice(index);
+		if (!device.poseValid)
+			continue;
+		uint32_t first = m_firstChannel[index];
+		device.position.x = m_bank.GetOutput(first + 0);
+		device.position.y = m_bank.GetOutput(first + 1);
+		device.position.z = m_bank.GetOutput(first + 2);
+
+		// Filtered axes drift apart slightly, so keep Z and rebuild the
+		// others perpendicular to it
+		float axisX[3], axisY[3], axisZ[3];
+		for (uint32_t row = 0; row < 3; row++)
+		{
+			axisY[row] = m_bank.GetOutput(first + 3 + row);
+			axisZ[row] = m_bank.GetOutput(first + 6 + row);
+		}
+		Normalize(axisZ);
+		Cross(axisY, axisZ, axisX);
+		Normalize(axisX);
+		Cross(axisZ, axisX, axisY);
+		for (uint32_t row = 0; row < 3; row++)
+		{
+			device.orientation.c[0][row] = axisX[row];
+			device.orientation.c[1][row] = axisY[row];
+			device.orientation.c[2][row] = axisZ[row];
+		}
+	}
+}
+
+float PoseFilter::GetLatency(vr::TrackedDeviceIndex_t index) const
+{
+	if (index >= m_firstChannel.size() || m_firstChannel[index] == kUnfiltered)
+		return 0.0f;
+	float latency = 0.0f;
+	for (uint32_t channel = 0; channel < kChannelsPerDevice; channel++)
+		latency = std::max(latency, m_bank.GetLatency(m_firstChannel[index] + channel));
+	return latency;
+}
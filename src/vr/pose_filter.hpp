@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <openvr.h>
+
+#include "vr/device_registry.hpp"
+#include "util/filter_bank.hpp"
+
+/// @brief Smooths device poses through a filter bank, with a filter chain
+/// per device. Position is filtered per axis. Orientation is filtered
+/// through its Y and Z axes and rebuilt orthonormal, which stays continuous
+/// where quaternion components would flip sign.
+class PoseFilter
+{
+public:
+	PoseFilter() { Clear(); }
+
+	void Clear();
+
+	/// @brief Filter a device's pose. An empty chain leaves it unfiltered.
+	void SetFilter(vr::TrackedDeviceIndex_t index, const util::FilterChain &chain);
+
+	/// @brief Filter the poses of all filtered devices in one pass. Devices
+	/// without a valid pose hold their filter state.
+	void Apply(DeviceRegistry &devices, util::Timestamp sampleTime);
+
+	/// @brief Estimated delay the device's filter adds, in seconds, taking
+	/// the most lagging component of its pose
+	float GetLatency(vr::TrackedDeviceIndex_t index) const;
+
+private:
+	// Position, then the orientation's Y and Z axes
+	static constexpr uint32_t kChannelsPerDevice = 9;
+	static constexpr uint32_t kUnfiltered = UINT32_MAX;
+
+	util::FilterBank m_bank;
+	std::vector<vr::TrackedDeviceIndex_t> m_devices;
+	std::array<uint32_t, vr::k_unMaxTrackedDeviceCount> m_firstChannel;
+};
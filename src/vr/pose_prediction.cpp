@@ -0,0 +1,93 @@
+#include "vr/pose_prediction.hpp"
+
+#include <cmath>
+
+bool ParsePredictionMode(const std::string &name, PredictionMode &mode)
+{
+	if (name == "none")
+		mode = PredictionMode::kNone;
+	else if (name == "runtime")
+		mode = PredictionMode::kRuntime;
+	else if (name == "extrapolate")
+		mode = PredictionMode::kExtrapolate;
+	else
+		return false;
+	return true;
+}
+
+void PosePredictor::GetPoses(vr::IVRSystem *hmd,
+							 vr::ETrackingUniverseOrigin origin,
+							 const PredictionArray &predictions,
+							 PoseArray &poses)
+{
+	// Unpredicted poses cover every device not predicted by the runtime
+	hmd->GetDeviceToAbsoluteTrackingPose(origin, 0.0f, poses.data(), (uint32_t)poses.size());
+
+	// Query the runtime once per distinct prediction time. In practice there
+	// are only one or two of these.
+	std::array<bool, vr::k_unMaxTrackedDeviceCount> done = {};
+	PoseArray predictedPoses;
+	for (uint32_t index = 0; index < predictions.size(); index++)
+	{
+		const PosePrediction &prediction = predictions[index];
+		if (done[index] || prediction.mode != PredictionMode::kRuntime || prediction.seconds == 0.0f)
+			continue;
+
+		hmd->GetDeviceToAbsoluteTrackingPose(
+			origin, prediction.seconds, predictedPoses.data(), (uint32_t)predictedPoses.size());
+		for (uint32_t other = index; other < predictions.size(); other++)
+		{
+			if (predictions[other].mode == PredictionMode::kRuntime &&
+				predictions[other].seconds == prediction.seconds)
+			{
+				poses[other] = predictedPoses[other];
+				done[other] = true;
+			}
+		}
+	}
+
+	for (uint32_t index = 0; index < predictions.size(); index++)
+	{
+		if (predictions[index].mode == PredictionMode::kExtrapolate)
+			Extrapolate(poses[index], predictions[index].seconds);
+	}
+}
+
+void PosePredictor::Extrapolate(vr::TrackedDevicePose_t &pose, float seconds)
+{
+	if (!pose.bPoseIsValid || seconds == 0.0f)
+		return;
+
+	vr::HmdMatrix34_t &m = pose.mDeviceToAbsoluteTracking;
+	const float *v = pose.vVelocity.v;
+	const float *w = pose.vAngularVelocity.v;
+
+	// Linear: p' = p + v*t
+	for (int row = 0; row < 3; row++)
+		m.m[row][3] += v[row] * seconds;
+
+	// Angular: rotate the orientation about the world-space angular velocity
+	// axis by |w|*t (Rodrigues' rotation formula), R' = dR * R
+	float speed = std::sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+	float angle = speed * seconds;
+	if (speed < 1e-6f || std::fabs(angle) < 1e-7f)
+		return;
+	float x = w[0] / speed, y = w[1] / speed, z = w[2] / speed;
+	float c = std::cos(angle), s = std::sin(angle), t = 1.0f - c;
+	float dr[3][3] = {
+		{t * x * x + c, t * x * y - s * z, t * x * z + s * y},
+		{t * x * y + s * z, t * y * y + c, t * y * z - s * x},
+		{t * x * z - s * y, t * y * z + s * x, t * z * z + c},
+	};
+	float r[3][3];
+	for (int row = 0; row < 3; row++)
+	{
+		for (int col = 0; col < 3; col++)
+			r[row][col] = m.m[row][col];
+	}
+	for (int row = 0; row < 3; row++)
+	{
+		for (int col = 0; col < 3; col++)
+			m.m[row][col] = dr[row][0] * r[0][col] + dr[row][1] * r[1][col] + dr[row][2] * r[2][col];
+	}
+}
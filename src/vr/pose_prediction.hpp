@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include <openvr.h>
+
+/// @brief How a device's pose is predicted forward in time
+enum class PredictionMode
+{
+	/// @brief Use the pose as of the moment it is polled
+	kNone,
+	/// @brief Ask the runtime for a pose predicted ahead
+	kRuntime,
+	/// @brief Poll the current pose and extrapolate it ourselves from its
+	/// linear and angular velocity, for drivers that don't predict
+	kExtrapolate,
+};
+
+/// @brief Pose prediction settings for one device
+struct PosePrediction
+{
+	PredictionMode mode = PredictionMode::kNone;
+	float seconds = 0.0f;
+
+	inline float GetPredictedSeconds() const
+	{
+		return mode == PredictionMode::kNone ? 0.0f : seconds;
+	}
+};
+
+/// @brief Parse a prediction mode name ("none", "runtime", "extrapolate")
+bool ParsePredictionMode(const std::string &name, PredictionMode &mode);
+
+/// @brief Fetches device poses with per-device prediction
+class PosePredictor
+{
+public:
+	using PoseArray = std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount>;
+	using PredictionArray = std::array<PosePrediction, vr::k_unMaxTrackedDeviceCount>;
+
+	/// @brief Get poses for all devices. The runtime is queried once for
+	/// each distinct runtime prediction time in use, and once unpredicted.
+	static void GetPoses(vr::IVRSystem *hmd,
+						 vr::ETrackingUniverseOrigin origin,
+						 const PredictionArray &predictions,
+						 PoseArray &poses);
+
+	/// @brief Extrapolate a pose forward in time from its velocities
+	static void Extrapolate(vr::TrackedDevicePose_t &pose, float seconds);
+};
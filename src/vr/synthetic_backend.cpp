@@ -0,0 +1,171 @@
+#include "vr/synthetic_backend.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const float kTwoPi = 6.28318530718f;
+
+	/// @brief Reads action states from the generated patterns
+	struct PatternActionSource
+	{
+		const std::vector<SyntheticBackend::Pattern> &patterns;
+		uint64_t tick;
+		float seconds;
+
+		inline bool ReadDigital(uint32_t slot, vr::VRActionHandle_t handle, vr::InputDigitalActionData_t &data)
+		{
+			const SyntheticBackend::Pattern &pattern = patterns[handle - 1];
+			uint32_t position = static_cast<uint32_t>((tick + pattern.phase) % pattern.pressPeriod);
+			data.bActive = true;
+			data.bState = position < pattern.pressLength;
+			data.bChanged = position == 0 || position == pattern.pressLength;
+			data.fUpdateTime = 0.0f;
+			return true;
+		}
+
+		inline bool ReadAnalog(uint32_t slot, vr::VRActionHandle_t handle, vr::InputAnalogActionData_t &data)
+		{
+			const SyntheticBackend::Pattern &pattern = patterns[handle - 1];
+			float angle = seconds * pattern.stickFrequency * kTwoPi + pattern.stickPhase;
+			data.bActive = true;
+			data.x = std::cos(angle) * pattern.stickRadius;
+			data.y = std::sin(angle) * pattern.stickRadius;
+			data.deltaX = 0.0f;
+			data.deltaY = 0.0f;
+			data.deltaZ = 0.0f;
+			data.fUpdateTime = 0.0f;
+			return true;
+		}
+	};
+}
+
+SyntheticBackend::SyntheticBackend(const SyntheticSettings &settings)
+	: m_settings(settings), m_random(settings.seed ? settings.seed : 1)
+{
+	m_settings.minPressPeriod = std::max<uint32_t>(m_settings.minPressPeriod, 2);
+	m_settings.maxPressPeriod = std::max(m_settings.maxPressPeriod, m_settings.minPressPeriod);
+	m_deviceCount = std::min<uint32_t>(1 + settings.controllerCount + settings.trackerCount,
+									   vr::k_unMaxTrackedDeviceCount);
+
+	for (uint32_t i = 0; i < settings.digitalActionCount; i++)
+		m_digitalNames.push_back("/actions/synthetic/in/button_" + std::to_string(i));
+	for (uint32_t i = 0; i < settings.analogActionCount; i++)
+		m_analogNames.push_back("/actions/synthetic/in/stick_" + std::to_string(i));
+}
+
+uint32_t SyntheticBackend::NextRandom()
+{
+	// xorshift32
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+	return m_random;
+}
+
+vr::VRActionHandle_t SyntheticBackend::GetActionHandle(const std::string &path)
+{
+	auto it = m_handles.find(path);
+	if (it != m_handles.end())
+		return it->second;
+
+	Pattern pattern;
+	uint32_t periodRange = m_settings.maxPressPeriod - m_settings.minPressPeriod + 1;
+	pattern.pressPeriod = m_settings.minPressPeriod + NextRandom() % periodRange;
+	pattern.pressLength = 1 + NextRandom() % (pattern.pressPeriod - 1);
+	pattern.phase = NextRandom() % pattern.pressPeriod;
+	pattern.stickFrequency = 0.1f + (NextRandom() % 1000) * 0.002f;
+	pattern.stickPhase = (NextRandom() % 1000) * (kTwoPi / 1000.0f);
+	pattern.stickRadius = 0.2f + (NextRandom() % 1000) * 0.0008f;
+	m_patterns.push_back(pattern);
+
+	vr::VRActionHandle_t handle = m_patterns.size();
+	m_handles[path] = handle;
+	return handle;
+}
+
+bool SyntheticBackend::BeginTick()
+{
+	m_tick++;
+	return true;
+}
+
+void SyntheticBackend::UpdateActions(vr::VRActionSetHandle_t actionSet, ActionStateTable &table)
+{
+	PatternActionSource source = {m_patterns, m_tick, m_tick / m_settings.tickRate};
+	table.Update(source, util::Clock::now());
+}
+
+util::Timestamp SyntheticBackend::GetPoses(const PosePredictor::PredictionArray &predictions,
+										   PosePredictor::PoseArray &poses)
+{
+	util::Timestamp sampleTime = util::Clock::now();
+	const float seconds = m_tick / m_settings.tickRate;
+	for (uint32_t index = 0; index < vr::k_unMaxTrackedDeviceCount; index++)
+	{
+		vr::TrackedDevicePose_t &pose = poses[index];
+		pose = vr::TrackedDevicePose_t();
+		if (index >= m_deviceCount)
+			continue;
+
+		// Each device orbits its own point and turns to face along the orbit
+		const float radius = 0.3f + 0.05f * index;
+		const float speed = 0.5f + 0.1f * index; // Radians per second
+		const float angle = seconds * speed + index;
+		const float c = std::cos(angle);
+		const float s = std::sin(angle);
+		vr::HmdMatrix34_t &m = pose.mDeviceToAbsoluteTracking;
+		m.m[0][0] = c;
+		m.m[0][1] = 0.0f;
+		m.m[0][2] = s;
+		m.m[1][0] = 0.0f;
+		m.m[1][1] = 1.0f;
+		m.m[1][2] = 0.0f;
+		m.m[2][0] = -s;
+		m.m[2][1] = 0.0f;
+		m.m[2][2] = c;
+		m.m[0][3] = radius * c;
+		m.m[1][3] = index == 0 ? 1.7f : 1.0f;
+		m.m[2][3] = radius * s;
+		pose.vVelocity.v[0] = -radius * speed * s;
+		pose.vVelocity.v[1] = 0.0f;
+		pose.vVelocity.v[2] = radius * speed * c;
+		pose.vAngularVelocity.v[0] = 0.0f;
+		pose.vAngularVelocity.v[1] = speed;
+		pose.vAngularVelocity.v[2] = 0.0f;
+		pose.eTrackingResult = vr::TrackingResult_Running_OK;
+		pose.bPoseIsValid = true;
+		pose.bDeviceIsConnected = true;
+	}
+	return sampleTime;
+}
+
+vr::ETrackedDeviceClass SyntheticBackend::GetDeviceClass(vr::TrackedDeviceIndex_t index)
+{
+	if (index == vr::k_unTrackedDeviceIndex_Hmd)
+		return vr::TrackedDeviceClass_HMD;
+	if (index <= m_settings.controllerCount && index < m_deviceCount)
+		return vr::TrackedDeviceClass_Controller;
+	if (index < m_deviceCount)
+		return vr::TrackedDeviceClass_GenericTracker;
+	return vr::TrackedDeviceClass_Invalid;
+}
+
+vr::ETrackedControllerRole SyntheticBackend::GetControllerRole(vr::TrackedDeviceIndex_t index)
+{
+	if (index == 1)
+		return vr::TrackedControllerRole_LeftHand;
+	if (index == 2)
+		return vr::TrackedControllerRole_RightHand;
+	return vr::TrackedControllerRole_Invalid;
+}
+
+std::string SyntheticBackend::GetDeviceString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop)
+{
+	if (prop == vr::Prop_SerialNumber_String)
+		return "synthetic-" + std::to_string(index);
+	if (prop == vr::Prop_TrackingSystemName_String)
+		return "synthetic";
+	return "";
+}
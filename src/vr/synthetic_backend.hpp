@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "vr/input_backend.hpp"
+
+/// @brief Shape of the input generated by a SyntheticBackend
+struct SyntheticSettings
+{
+	uint32_t controllerCount = 2;
+	uint32_t trackerCount = 0;
+	uint32_t digitalActionCount = 16;
+	uint32_t analogActionCount = 4;
+
+	/// @brief Range of button press periods, in ticks
+	uint32_t minPressPeriod = 20;
+	uint32_t maxPressPeriod = 500;
+
+	/// @brief Virtual tick rate that motion and stick patterns advance at
+	float tickRate = 1000.0f;
+
+	uint32_t seed = 1;
+};
+
+/// @brief Input backend which procedurally generates devices, actions and
+/// input, for running the mapping core headless at arbitrary scale. Every
+/// action gets its own deterministic pattern: buttons toggle with a random
+/// period and duty cycle, sticks sweep in circles, and devices orbit the play
+/// area while turning. Any action path is accepted.
+class SyntheticBackend : public InputBackend
+{
+public:
+	explicit SyntheticBackend(const SyntheticSettings &settings);
+
+	/// @brief Paths of the actions described by the settings
+	inline const std::vector<std::string> &GetDigitalActionNames() const { return m_digitalNames; }
+	inline const std::vector<std::string> &GetAnalogActionNames() const { return m_analogNames; }
+
+	inline uint64_t GetTick() const { return m_tick; }
+
+	virtual vr::VRActionSetHandle_t GetActionSetHandle(const std::string &path) override { return 1; }
+	virtual vr::VRActionHandle_t GetActionHandle(const std::string &path) override;
+	virtual bool BeginTick() override;
+	virtual void UpdateActions(vr::VRActionSetHandle_t actionSet, ActionStateTable &table) override;
+	virtual util::Timestamp GetPoses(const PosePredictor::PredictionArray &predictions,
+									 PosePredictor::PoseArray &poses) override;
+	virtual vr::ETrackedDeviceClass GetDeviceClass(vr::TrackedDeviceIndex_t index) override;
+	virtual vr::ETrackedControllerRole GetControllerRole(vr::TrackedDeviceIndex_t index) override;
+	virtual std::string GetDeviceString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop) override;
+
+	/// @brief Per-action generator state, indexed by handle - 1
+	struct Pattern
+	{
+		uint32_t pressPeriod = 1;
+		uint32_t pressLength = 0;
+		uint32_t phase = 0;
+		float stickFrequency = 0.0f;
+		float stickPhase = 0.0f;
+		float stickRadius = 0.0f;
+	};
+
+private:
+	uint32_t NextRandom();
+
+	SyntheticSettings m_settings;
+	uint32_t m_random = 1;
+	uint32_t m_deviceCount = 0;
+	uint64_t m_tick = 0;
+	std::vector<std::string> m_digitalNames;
+	std::vector<std::string> m_analogNames;
+	std::map<std::string, vr::VRActionHandle_t> m_handles;
+	std::vector<Pattern> m_patterns;
+};